@@ -0,0 +1,117 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include "kvs_arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace score::mw::per::kvs {
+
+/* Minimum chunk size, also used if the file length is unknown */
+constexpr size_t KVS_ARENA_MIN_CHUNK = 4096U;
+
+void KvsResource::ref() noexcept
+{
+    references.fetch_add(1U, std::memory_order_relaxed);
+}
+
+void KvsResource::unref() noexcept
+{
+    if (1U == references.fetch_sub(1U, std::memory_order_acq_rel)) {
+        delete this;
+    }
+}
+
+KvsArena* KvsArena::create(size_t initial_size)
+{
+    return new KvsArena(initial_size);
+}
+
+KvsArena::KvsArena(size_t initial_size)
+    : cursor(nullptr)
+    , limit(nullptr)
+    , used_bytes(0U)
+    , next_size(std::max(initial_size, KVS_ARENA_MIN_CHUNK))
+    , released(false)
+{
+}
+
+KvsArena::~KvsArena()
+{
+    for (const auto& [data, size] : chunks) {
+        ::operator delete(data, size);
+    }
+}
+
+void KvsArena::release()
+{
+    std::sort(chunks.begin(), chunks.end());
+    released = true;
+    unref();
+}
+
+size_t KvsArena::chunk_count() const
+{
+    return chunks.size();
+}
+
+size_t KvsArena::used() const
+{
+    return used_bytes;
+}
+
+void* KvsArena::do_allocate(size_t bytes, size_t alignment)
+{
+    void* result = nullptr;
+    if (released) {
+        result = ::operator new(bytes);
+    }else{
+        const size_t padding = (alignment - (reinterpret_cast<uintptr_t>(cursor) % alignment)) % alignment;
+        if ((nullptr == cursor) || (static_cast<size_t>(limit - cursor) < (padding + bytes))) {
+            /* The next chunk: the size of the first one (the estimate was too small), or larger for a large allocation */
+            const size_t size = std::max(next_size, bytes + alignment);
+            char* data = static_cast<char*>(::operator new(size));
+            chunks.emplace_back(data, size);
+            used_bytes += (nullptr != cursor) ? static_cast<size_t>(limit - cursor) : 0U;
+            cursor = data;
+            limit = data + size;
+        }
+        const size_t offset = (alignment - (reinterpret_cast<uintptr_t>(cursor) % alignment)) % alignment;
+        result = cursor + offset;
+        cursor += offset + bytes;
+        used_bytes += offset + bytes;
+    }
+
+    return result;
+}
+
+void KvsArena::do_deallocate(void* ptr, size_t, size_t)
+{
+    /* Memory of the chunks is freed with the arena, only allocations after release() are freed here */
+    if (released) {
+        char* const address = static_cast<char*>(ptr);
+        auto chunk = std::upper_bound(chunks.begin(), chunks.end(), address,
+                                      [](char* lhs, const std::pair<char*, size_t>& rhs) { return lhs < rhs.first; });
+        const bool in_chunk = (chunk != chunks.begin()) && (address < ((chunk - 1)->first + (chunk - 1)->second));
+        if (!in_chunk) {
+            ::operator delete(ptr);
+        }
+    }
+}
+
+bool KvsArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,159 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_ARENA_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * This header defines the allocation of the KVS data (map nodes, array and object elements).
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * KvsAllocator carries the memory resource it allocates from: a default constructed allocator is plain
+ * operator new/delete, an allocator constructed with a KvsResource allocates from it. Containers keep
+ * their allocator when moved, move assigned and swapped, a copy of a container uses operator new again,
+ * so only the containers created by the loader are in the load arena. Every allocator holds a reference
+ * of its resource, containers and shared storage (allocate_shared) keep the resource alive while their
+ * memory is allocated from it.
+ *
+ * KvsArena is the monotonic resource used to load a KVS file (KvsBuilder::load_arena_flag): allocations
+ * are bump allocated from a few large chunks, the first one sized from the file length, deallocation
+ * doesn't free anything. Only the loading thread allocates from the chunks. After the owner released the
+ * arena, allocations (e.g. new keys in the loaded map) use operator new and may be done by any thread.
+ * The chunks are freed at once when the last allocator using the arena is destroyed, e.g. when reset or
+ * snapshot_restore replaced the loaded data. Values still shared with a caller keep the arena alive.
+ */
+namespace score::mw::per::kvs {
+
+/* Maximum alignment of KvsAllocator (guaranteed by operator new) */
+constexpr size_t KVS_ALLOCATION_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+/* Memory resource of KvsAllocator, reference counted (created with one reference for its owner) */
+class KvsResource : public std::pmr::memory_resource {
+public:
+    void ref() noexcept;
+    /* Deletes the resource with the last reference */
+    void unref() noexcept;
+
+protected:
+    KvsResource() = default;
+    ~KvsResource() override = default;
+
+private:
+    std::atomic<size_t> references{1U};
+};
+
+class KvsArena final : public KvsResource {
+public:
+    /* New arena, the first chunk has initial_size bytes */
+    static KvsArena* create(size_t initial_size);
+    /* The owner doesn't use the arena anymore, further allocations use operator new */
+    void release();
+
+    size_t chunk_count() const;
+    /* Allocated bytes (including the unused rest of the previous chunks) */
+    size_t used() const;
+
+private:
+    explicit KvsArena(size_t initial_size);
+    ~KvsArena() override;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::vector<std::pair<char*, size_t>> chunks; /* Sorted by address after release() */
+    char* cursor;
+    char* limit;
+    size_t used_bytes;
+    size_t next_size;
+    bool released; /* Set by the loading thread before the data is shared */
+};
+
+template <typename T>
+class KvsAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    KvsAllocator() noexcept = default;
+    /* Allocates from resource (nullptr: operator new) */
+    explicit KvsAllocator(KvsResource* resource) noexcept : memory(resource) {
+        if (nullptr != memory) {
+            memory->ref();
+        }
+    }
+    KvsAllocator(const KvsAllocator& other) noexcept : KvsAllocator(other.memory) {}
+    template <typename U>
+    KvsAllocator(const KvsAllocator<U>& other) noexcept : KvsAllocator(other.resource()) {}
+    KvsAllocator& operator=(const KvsAllocator& other) noexcept {
+        if (memory != other.memory) {
+            if (nullptr != other.memory) {
+                other.memory->ref();
+            }
+            if (nullptr != memory) {
+                memory->unref();
+            }
+            memory = other.memory;
+        }
+        return *this;
+    }
+    ~KvsAllocator() {
+        if (nullptr != memory) {
+            memory->unref();
+        }
+    }
+
+    KvsResource* resource() const noexcept { return memory; }
+
+    /* Copies of a container don't allocate from the resource */
+    KvsAllocator select_on_container_copy_construction() const noexcept { return KvsAllocator(); }
+
+    T* allocate(size_t count) {
+        static_assert(alignof(T) <= KVS_ALLOCATION_ALIGNMENT, "KvsAllocator: alignment not supported");
+        void* result = (nullptr == memory) ? ::operator new(count * sizeof(T))
+                                           : memory->allocate(count * sizeof(T), alignof(T));
+        return static_cast<T*>(result);
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        if (nullptr == memory) {
+            ::operator delete(ptr);
+        }else{
+            memory->deallocate(ptr, count * sizeof(T), alignof(T));
+        }
+    }
+
+private:
+    KvsResource* memory = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const KvsAllocator<T>& lhs, const KvsAllocator<U>& rhs) noexcept {
+    return lhs.resource() == rhs.resource();
+}
+template <typename T, typename U>
+bool operator!=(const KvsAllocator<T>& lhs, const KvsAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_ARENA_HPP
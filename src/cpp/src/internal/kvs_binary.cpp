@@ -0,0 +1,475 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include "kvs_binary.hpp"
+#include "kvs_helper.hpp"
+#include "kvs_json_parser.hpp"
+
+namespace score::mw::per::kvs {
+
+/* File magic, version and entry count*/
+constexpr std::array<char, 4> KVS_BINARY_MAGIC = {'K', 'V', 'S', 'B'};
+constexpr size_t KVS_BINARY_HEADER_SIZE = 9U;
+constexpr size_t KVS_BINARY_CHECKSUM_SIZE = 4U;
+
+/* Type tags of the binary format (stable on disk, independent of KvsValue::Type)*/
+enum class BinaryTag : uint8_t {
+    I32 = 0,
+    U32 = 1,
+    I64 = 2,
+    U64 = 3,
+    F64 = 4,
+    Bool = 5,
+    Str = 6,
+    Null = 7,
+    Arr = 8,
+    Obj = 9,
+    Bytes = 10,
+    ArrI32 = 11,
+    ArrU32 = 12,
+    ArrI64 = 13,
+    ArrU64 = 14,
+    ArrF64 = 15,
+};
+
+/* Unsigned integer with the bit pattern of a packed array element */
+template <typename T>
+using PackedBits = std::conditional_t<sizeof(T) == 4U, uint32_t, uint64_t>;
+
+/*********************** Binary Writer *********************/
+static void put_u32(std::string& out, uint32_t value)
+{
+    std::array<uint8_t, 4> bytes = get_hash_bytes_adler32(value); /* Big endian, same as the hash files*/
+    out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+static void put_u64(std::string& out, uint64_t value)
+{
+    put_u32(out, static_cast<uint32_t>(value >> 32));
+    put_u32(out, static_cast<uint32_t>(value & 0xFFFFFFFFU));
+}
+
+static void put_string(std::string& out, const std::string& str)
+{
+    put_u32(out, static_cast<uint32_t>(str.size()));
+    out.append(str);
+}
+
+/* Write a packed array as element count and one block of big endian numbers */
+template <typename T>
+static void put_packed(std::string& out, BinaryTag tag, const KvsPackedArray<T>& array)
+{
+    out.push_back(static_cast<char>(tag));
+    put_u32(out, static_cast<uint32_t>(array.size()));
+    const size_t offset = out.size();
+    out.resize(offset + (array.size() * sizeof(T)));
+    char* block = &out[offset];
+    for (size_t idx = 0; idx < array.size(); ++idx) {
+        PackedBits<T> bits = 0;
+        std::memcpy(&bits, &array[idx], sizeof(T));
+        for (size_t byte = 0; byte < sizeof(T); ++byte) {
+            block[(idx * sizeof(T)) + byte] = static_cast<char>(bits >> (8U * (sizeof(T) - 1U - byte)));
+        }
+    }
+}
+
+static bool put_value(std::string& out, const KvsValue& value)
+{
+    bool valid = true;
+    switch (value.getType()) {
+        case KvsValue::Type::i32: {
+            out.push_back(static_cast<char>(BinaryTag::I32));
+            put_u32(out, static_cast<uint32_t>(std::get<int32_t>(value.getValue())));
+            break;
+        }
+        case KvsValue::Type::u32: {
+            out.push_back(static_cast<char>(BinaryTag::U32));
+            put_u32(out, std::get<uint32_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::i64: {
+            out.push_back(static_cast<char>(BinaryTag::I64));
+            put_u64(out, static_cast<uint64_t>(std::get<int64_t>(value.getValue())));
+            break;
+        }
+        case KvsValue::Type::u64: {
+            out.push_back(static_cast<char>(BinaryTag::U64));
+            put_u64(out, std::get<uint64_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::f64: {
+            out.push_back(static_cast<char>(BinaryTag::F64));
+            const double number = std::get<double>(value.getValue());
+            uint64_t bits = 0;
+            std::memcpy(&bits, &number, sizeof(bits));
+            put_u64(out, bits);
+            break;
+        }
+        case KvsValue::Type::Boolean: {
+            out.push_back(static_cast<char>(BinaryTag::Bool));
+            out.push_back(std::get<bool>(value.getValue()) ? 1 : 0);
+            break;
+        }
+        case KvsValue::Type::String: {
+            out.push_back(static_cast<char>(BinaryTag::Str));
+            put_string(out, std::get<std::string>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::Null: {
+            out.push_back(static_cast<char>(BinaryTag::Null));
+            break;
+        }
+        case KvsValue::Type::Array: {
+            const auto& array = std::get<KvsValue::Array>(value.getValue());
+            out.push_back(static_cast<char>(BinaryTag::Arr));
+            put_u32(out, static_cast<uint32_t>(array.size()));
+            for (const auto& elem : array) {
+                if (!put_value(out, elem)) {
+                    valid = false;
+                    break;
+                }
+            }
+            break;
+        }
+        case KvsValue::Type::Object: {
+            const auto& object = std::get<KvsValue::Object>(value.getValue());
+            out.push_back(static_cast<char>(BinaryTag::Obj));
+            put_u32(out, static_cast<uint32_t>(object.size()));
+            for (const auto& [key, elem] : object) {
+                put_string(out, key);
+                if (!put_value(out, elem)) {
+                    valid = false;
+                    break;
+                }
+            }
+            break;
+        }
+        case KvsValue::Type::Bytes: {
+            const auto& bytes = std::get<KvsValue::Bytes>(value.getValue());
+            out.push_back(static_cast<char>(BinaryTag::Bytes));
+            put_u32(out, static_cast<uint32_t>(bytes.size()));
+            out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            break;
+        }
+        case KvsValue::Type::ArrayI32: {
+            put_packed(out, BinaryTag::ArrI32, std::get<KvsValue::ArrayI32>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayU32: {
+            put_packed(out, BinaryTag::ArrU32, std::get<KvsValue::ArrayU32>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayI64: {
+            put_packed(out, BinaryTag::ArrI64, std::get<KvsValue::ArrayI64>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayU64: {
+            put_packed(out, BinaryTag::ArrU64, std::get<KvsValue::ArrayU64>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayF64: {
+            put_packed(out, BinaryTag::ArrF64, std::get<KvsValue::ArrayF64>(value.getValue()));
+            break;
+        }
+        default: {
+            valid = false;
+            break;
+        }
+    }
+
+    return valid;
+}
+
+score::Result<std::string> serialize_kvs_binary(const KvsMap& data)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::string out;
+    bool valid = true;
+
+    out.append(KVS_BINARY_MAGIC.data(), KVS_BINARY_MAGIC.size());
+    out.push_back(static_cast<char>(KVS_BINARY_VERSION));
+    put_u32(out, static_cast<uint32_t>(data.size()));
+    for (const auto& [key, value] : data) {
+        put_string(out, key);
+        if (!put_value(out, value)) {
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid) {
+        result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+    }else{
+        put_u32(out, calculate_hash_adler32(out));
+        result = std::move(out);
+    }
+
+    return result;
+}
+
+/*********************** Binary Reader *********************/
+/* Bounds checked cursor over the file content (without checksum) */
+struct BinaryReader {
+    std::string_view data;
+    size_t pos;
+    size_t end;
+    KvsResource* resource = nullptr; /* Resource of the arrays and objects (nullptr: operator new) */
+
+    bool get_u8(uint8_t& value) {
+        bool valid = (end - pos) >= 1U;
+        if (valid) {
+            value = static_cast<uint8_t>(data[pos]);
+            pos += 1U;
+        }
+        return valid;
+    }
+
+    bool get_u32(uint32_t& value) {
+        bool valid = (end - pos) >= 4U;
+        if (valid) {
+            value = (uint32_t(uint8_t(data[pos])) << 24)
+                  | (uint32_t(uint8_t(data[pos + 1])) << 16)
+                  | (uint32_t(uint8_t(data[pos + 2])) <<  8)
+                  |  uint32_t(uint8_t(data[pos + 3]));
+            pos += 4U;
+        }
+        return valid;
+    }
+
+    bool get_u64(uint64_t& value) {
+        uint32_t high = 0;
+        uint32_t low = 0;
+        bool valid = get_u32(high) && get_u32(low);
+        if (valid) {
+            value = (uint64_t(high) << 32) | uint64_t(low);
+        }
+        return valid;
+    }
+
+    bool get_string(std::string& value) {
+        uint32_t size = 0;
+        bool valid = get_u32(size) && ((end - pos) >= size);
+        if (valid) {
+            value.assign(data.substr(pos, size));
+            pos += size;
+        }
+        return valid;
+    }
+
+    bool get_bytes(KvsBytes& value) {
+        uint32_t size = 0;
+        bool valid = get_u32(size) && ((end - pos) >= size);
+        if (valid) {
+            value.assign(reinterpret_cast<const uint8_t*>(data.data() + pos), size);
+            pos += size;
+        }
+        return valid;
+    }
+
+    template <typename T>
+    bool get_packed(KvsValue& value) {
+        uint32_t count = 0;
+        bool valid = get_u32(count) && (((end - pos) / sizeof(T)) >= count);
+        if (valid) {
+            typename KvsPackedArray<T>::Storage elements(count);
+            const uint8_t* block = reinterpret_cast<const uint8_t*>(data.data() + pos);
+            for (size_t idx = 0; idx < count; ++idx) {
+                PackedBits<T> bits = 0;
+                for (size_t byte = 0; byte < sizeof(T); ++byte) {
+                    bits = static_cast<PackedBits<T>>((bits << 8U) | block[(idx * sizeof(T)) + byte]);
+                }
+                std::memcpy(&elements[idx], &bits, sizeof(T));
+            }
+            pos += count * sizeof(T);
+            value = KvsValue(KvsPackedArray<T>(std::move(elements)));
+        }
+        return valid;
+    }
+};
+
+/* Decode a value, arrays and objects nested deeper than KVS_JSON_MAX_DEPTH are rejected like in JSON */
+static bool get_value(BinaryReader& reader, KvsValue& value, size_t depth)
+{
+    uint8_t tag = 0;
+    bool valid = (depth < KVS_JSON_MAX_DEPTH) && reader.get_u8(tag);
+    if (valid) {
+        switch (static_cast<BinaryTag>(tag)) {
+            case BinaryTag::I32: {
+                uint32_t number = 0;
+                valid = reader.get_u32(number);
+                value = KvsValue(static_cast<int32_t>(number));
+                break;
+            }
+            case BinaryTag::U32: {
+                uint32_t number = 0;
+                valid = reader.get_u32(number);
+                value = KvsValue(number);
+                break;
+            }
+            case BinaryTag::I64: {
+                uint64_t number = 0;
+                valid = reader.get_u64(number);
+                value = KvsValue(static_cast<int64_t>(number));
+                break;
+            }
+            case BinaryTag::U64: {
+                uint64_t number = 0;
+                valid = reader.get_u64(number);
+                value = KvsValue(number);
+                break;
+            }
+            case BinaryTag::F64: {
+                uint64_t bits = 0;
+                double number = 0.0;
+                valid = reader.get_u64(bits);
+                std::memcpy(&number, &bits, sizeof(number));
+                value = KvsValue(number);
+                break;
+            }
+            case BinaryTag::Bool: {
+                uint8_t boolean = 0;
+                valid = reader.get_u8(boolean) && (boolean <= 1U);
+                value = KvsValue(1U == boolean);
+                break;
+            }
+            case BinaryTag::Str: {
+                std::string str;
+                valid = reader.get_string(str);
+                value = KvsValue(std::move(str));
+                break;
+            }
+            case BinaryTag::Null: {
+                value = KvsValue(nullptr);
+                break;
+            }
+            case BinaryTag::Bytes: {
+                KvsValue::Bytes bytes;
+                valid = reader.get_bytes(bytes);
+                value = KvsValue(std::move(bytes));
+                break;
+            }
+            case BinaryTag::ArrI32: {
+                valid = reader.get_packed<int32_t>(value);
+                break;
+            }
+            case BinaryTag::ArrU32: {
+                valid = reader.get_packed<uint32_t>(value);
+                break;
+            }
+            case BinaryTag::ArrI64: {
+                valid = reader.get_packed<int64_t>(value);
+                break;
+            }
+            case BinaryTag::ArrU64: {
+                valid = reader.get_packed<uint64_t>(value);
+                break;
+            }
+            case BinaryTag::ArrF64: {
+                valid = reader.get_packed<double>(value);
+                break;
+            }
+            case BinaryTag::Arr: {
+                uint32_t count = 0;
+                valid = reader.get_u32(count);
+                KvsValue::Array::Elements elements{KvsAllocator<KvsValue>(reader.resource)};
+                for (uint32_t idx = 0; valid && (idx < count); ++idx) {
+                    KvsValue elem(nullptr);
+                    valid = get_value(reader, elem, depth + 1U);
+                    elements.push_back(std::move(elem));
+                }
+                if (valid) {
+                    value = KvsValue(KvsValue::Array(std::move(elements)));
+                }
+                break;
+            }
+            case BinaryTag::Obj: {
+                uint32_t count = 0;
+                valid = reader.get_u32(count);
+                KvsValue::Object::Members members{KvsAllocator<KvsValue::Object::value_type>(reader.resource)};
+                for (uint32_t idx = 0; valid && (idx < count); ++idx) {
+                    std::string key;
+                    KvsValue elem(nullptr);
+                    valid = reader.get_string(key) && get_value(reader, elem, depth + 1U);
+                    members.emplace_back(std::move(key), std::move(elem));
+                }
+                if (valid) {
+                    value = KvsValue(KvsValue::Object(std::move(members))); /* Written in key order: not sorted again */
+                }
+                break;
+            }
+            default: {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    return valid;
+}
+
+/*********************** Single Values *********************/
+bool encode_kvs_binary_value(std::string& out, const KvsValue& value)
+{
+    return put_value(out, value);
+}
+
+bool decode_kvs_binary_value(std::string_view data, size_t& pos, KvsValue& value)
+{
+    BinaryReader reader{data, pos, data.size()};
+    bool valid = (pos <= data.size()) && get_value(reader, value, 0U);
+    pos = reader.pos;
+    return valid;
+}
+
+score::Result<KvsMap> deserialize_kvs_binary(const std::string& data, KvsResource* resource)
+{
+    score::Result<KvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if ((data.size() < (KVS_BINARY_HEADER_SIZE + KVS_BINARY_CHECKSUM_SIZE))
+        || (0 != data.compare(0, KVS_BINARY_MAGIC.size(), KVS_BINARY_MAGIC.data(), KVS_BINARY_MAGIC.size()))
+        || (KVS_BINARY_VERSION != static_cast<uint8_t>(data[KVS_BINARY_MAGIC.size()]))) {
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }else{
+        const size_t content_size = data.size() - KVS_BINARY_CHECKSUM_SIZE;
+        BinaryReader checksum_reader{data, content_size, data.size()};
+        uint32_t checksum = 0;
+        (void)checksum_reader.get_u32(checksum);
+        if (calculate_hash_adler32(data.substr(0, content_size)) != checksum) {
+            result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+        }else{
+            BinaryReader reader{data, KVS_BINARY_MAGIC.size() + 1U, content_size, resource};
+            uint32_t count = 0;
+            bool valid = reader.get_u32(count);
+            KvsMap result_value{KvsMap::allocator_type(resource)};
+            result_value.reserve(std::min<size_t>(count, content_size / 5U)); /* An entry has at least 5 bytes */
+            for (uint32_t idx = 0; valid && (idx < count); ++idx) {
+                std::string key;
+                KvsValue value(nullptr);
+                valid = reader.get_string(key) && get_value(reader, value, 0U);
+                result_value.insert_or_assign(std::move(key), std::move(value));
+            }
+            if (!valid || (reader.pos != content_size)) {
+                result = score::MakeUnexpected(ErrorCode::SerializationFailed);
+            }else{
+                result = std::move(result_value);
+            }
+        }
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,53 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_BINARY_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_BINARY_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "error.hpp"
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the binary storage format of the KVS (kvs_<id>_g<n>.bin).
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * File layout (all integers big endian, like the hash files):
+ *   [magic "KVSB": 4 bytes][version: 1 byte][entry count: 4 bytes][entries][Adler-32 of all preceding bytes: 4 bytes]
+ * Entry layout:
+ *   [key length: 4 bytes][key][value]
+ * Value layout:
+ *   [type tag: 1 byte][payload]
+ *   Type tags: i32 0, u32 1, i64 2, u64 3, f64 4, bool 5, str 6, null 7, arr 8, obj 9, bytes 10,
+ *   arr_i32 11, arr_u32 12, arr_i64 13, arr_u64 14, arr_f64 15
+ *   i32/u32: 4 bytes, i64/u64: 8 bytes, f64: 8 bytes (IEEE 754), bool: 1 byte, null: no payload,
+ *   str: [length: 4 bytes][bytes], arr: [count: 4 bytes][values], obj: [count: 4 bytes][entries],
+ *   bytes: [length: 4 bytes][bytes],
+ *   arr_i32 ... arr_f64: [count: 4 bytes][count elements of 4 or 8 bytes, big endian like the scalars]
+ */
+namespace score::mw::per::kvs {
+
+constexpr uint8_t KVS_BINARY_VERSION = 1U;
+
+score::Result<std::string> serialize_kvs_binary(const KvsMap& data);
+/* The map, arrays and objects are allocated from resource (nullptr: operator new) */
+score::Result<KvsMap> deserialize_kvs_binary(const std::string& data, KvsResource* resource = nullptr);
+
+/* Encoding of a single value (value layout above), e.g. for the defaults image */
+bool encode_kvs_binary_value(std::string& out, const KvsValue& value);
+bool decode_kvs_binary_value(std::string_view data, size_t& pos, KvsValue& value);
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_BINARY_HPP
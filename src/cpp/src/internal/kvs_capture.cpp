@@ -0,0 +1,159 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include "kvs_capture.hpp"
+
+namespace score::mw::per::kvs {
+
+KvsCapture::KvsCapture()
+    : cleared(false)
+    , running(false)
+{
+}
+
+void KvsCapture::begin(Data& data)
+{
+    base = std::move(data);
+    data = Data(base.get_allocator()); /* Same allocator: the nodes are moved back in end() */
+    removed.clear();
+    cleared = false;
+    running = true;
+}
+
+const KvsCapture::Data& KvsCapture::captured() const
+{
+    return base;
+}
+
+void KvsCapture::end(Data& data)
+{
+    if (running) {
+        /* Replaced during the capture (assign): data already holds all entries */
+        if (!cleared) {
+            for (const auto& key : removed) {
+                (void)base.erase(key);
+            }
+            /* Move the changed entries (map nodes, no copies) into the captured data */
+            while (!data.empty()) {
+                auto node = data.extract(data.begin());
+                auto search = base.find(node.key());
+                if (search != base.end()) {
+                    search->second = std::move(node.mapped());
+                }else{
+                    (void)base.insert(std::move(node));
+                }
+            }
+            data = std::move(base);
+        }
+        base = Data();
+        removed.clear();
+        cleared = false;
+        running = false;
+    }
+}
+
+bool KvsCapture::active() const
+{
+    return running;
+}
+
+/* Key of the captured data which was not removed during the capture */
+bool KvsCapture::capture_visible(const std::string& key) const
+{
+    return running && !cleared && (0U == removed.count(key));
+}
+
+const KvsValue* KvsCapture::find(const Data& data, const std::string& key) const
+{
+    const KvsValue* result = nullptr;
+    auto search = data.find(key);
+    if (search != data.end()) {
+        result = &search->second;
+    }else if (capture_visible(key)) {
+        auto search_base = base.find(key);
+        if (search_base != base.end()) {
+            result = &search_base->second;
+        }
+    }
+
+    return result;
+}
+
+void KvsCapture::set(Data& data, const std::string& key, const KvsValue& value)
+{
+    (void)data.insert_or_assign(key, value); /* The key is only copied, if it is inserted */
+}
+
+void KvsCapture::set(Data& data, const std::string& key, KvsValue&& value)
+{
+    (void)data.insert_or_assign(key, std::move(value));
+}
+
+void KvsCapture::set(Data& data, std::string&& key, KvsValue&& value)
+{
+    (void)data.insert_or_assign(std::move(key), std::move(value));
+}
+
+bool KvsCapture::erase(Data& data, const std::string& key)
+{
+    const bool existed = (nullptr != find(data, key));
+    (void)data.erase(key);
+    if (running && (0U != base.count(key))) {
+        (void)removed.insert(key);
+    }
+
+    return existed;
+}
+
+void KvsCapture::assign(Data& data, Data&& next)
+{
+    data = std::move(next);
+    if (running) {
+        cleared = true;
+        removed.clear();
+    }
+}
+
+bool KvsCapture::empty(const Data& data) const
+{
+    return data.empty() && (!running || cleared || (base.size() == removed.size()));
+}
+
+std::vector<std::string> KvsCapture::keys(const Data& data) const
+{
+    std::vector<std::string> keys;
+    keys.reserve(data.size() + base.size());
+    for (const auto& [key, _] : data) {
+        keys.push_back(key);
+    }
+    for (const auto& [key, _] : base) {
+        if (capture_visible(key) && (0U == data.count(key))) {
+            keys.push_back(key);
+        }
+    }
+
+    return keys;
+}
+
+KvsCapture::Data KvsCapture::copy(const Data& data) const
+{
+    Data result = data;
+    for (const auto& [key, value] : base) {
+        if (capture_visible(key)) {
+            (void)result.emplace(key, value); /* Doesn't replace changed entries */
+        }
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,76 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_CAPTURE_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_CAPTURE_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the point-in-time capture of the KVS data used by flush.
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * begin() moves the data into the capture (constant time, the map is not copied) and the data map
+ * continues as overlay of the changes made during the capture. Removed keys of the captured data are
+ * remembered, a reset (clear/assign) hides all captured keys. The captured data is not changed until
+ * end(), so it can be serialized without holding a lock. end() folds the overlay into the captured data
+ * and moves it back, which only takes time proportional to the number of changes during the capture.
+ *
+ * Without an active capture, all functions work on the data map only.
+ * The caller locks the data map (the captured data itself is only read between begin() and end()).
+ */
+namespace score::mw::per::kvs {
+
+class KvsCapture final {
+public:
+    using Data = KvsMap;
+
+    KvsCapture();
+
+    /* Capture data, data is empty afterwards and receives the changes */
+    void begin(Data& data);
+    /* Captured data, valid and unchanged until end() */
+    const Data& captured() const;
+    /* Apply the changes of data to the captured data and move it back to data */
+    void end(Data& data);
+    bool active() const;
+
+    /* Access the current data (overlay and captured data), keys are passed as std::string to look them up without a copy */
+    const KvsValue* find(const Data& data, const std::string& key) const;
+    void set(Data& data, const std::string& key, const KvsValue& value);
+    void set(Data& data, const std::string& key, KvsValue&& value);
+    /* Owned key: only moved, if it is inserted */
+    void set(Data& data, std::string&& key, KvsValue&& value);
+    /* Returns false, if the key doesn't exist */
+    bool erase(Data& data, const std::string& key);
+    void assign(Data& data, Data&& next);
+    bool empty(const Data& data) const;
+    std::vector<std::string> keys(const Data& data) const;
+    Data copy(const Data& data) const;
+
+private:
+    bool capture_visible(const std::string& key) const;
+
+    Data base;                            /* Captured data */
+    std::unordered_set<std::string> removed; /* Keys of base removed during the capture */
+    bool cleared;                         /* All keys of base removed during the capture */
+    bool running;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_CAPTURE_HPP
@@ -0,0 +1,266 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "kvs_binary.hpp"
+#include "kvs_defaults_image.hpp"
+#include "kvs_helper.hpp"
+
+namespace score::mw::per::kvs {
+
+/* File magic, version, source hash and entry count*/
+constexpr std::array<char, 4> KVS_DEFAULTS_IMAGE_MAGIC = {'K', 'V', 'S', 'D'};
+constexpr size_t KVS_DEFAULTS_IMAGE_HEADER_SIZE = 13U;
+constexpr size_t KVS_DEFAULTS_IMAGE_ENTRY_SIZE = 12U;
+constexpr size_t KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE = 4U;
+
+/* Append uint32 in big endian byte order */
+static void put_u32(std::string& out, uint32_t value)
+{
+    std::array<uint8_t, 4> bytes = get_hash_bytes_adler32(value); /* Same byte order as the hash files*/
+    out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+/* Read uint32 in big endian byte order */
+static uint32_t read_u32(std::string_view data, size_t pos)
+{
+    return (uint32_t(uint8_t(data[pos])) << 24)
+         | (uint32_t(uint8_t(data[pos + 1])) << 16)
+         | (uint32_t(uint8_t(data[pos + 2])) <<  8)
+         |  uint32_t(uint8_t(data[pos + 3]));
+}
+
+/*********************** Image Writer *********************/
+score::Result<std::string> serialize_defaults_image(const KvsMap& data, uint32_t source_hash)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    /* Sorted key table for the binary search */
+    std::vector<const std::pair<const std::string, KvsValue>*> entries;
+    entries.reserve(data.size());
+    for (const auto& entry : data) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+
+    /* Keys and values are written behind the key table */
+    std::string payload;
+    std::string table;
+    const size_t payload_offset = KVS_DEFAULTS_IMAGE_HEADER_SIZE + (entries.size() * KVS_DEFAULTS_IMAGE_ENTRY_SIZE);
+    bool valid = true;
+    for (const auto* entry : entries) {
+        put_u32(table, static_cast<uint32_t>(payload_offset + payload.size()));
+        put_u32(table, static_cast<uint32_t>(entry->first.size()));
+        payload.append(entry->first);
+        put_u32(table, static_cast<uint32_t>(payload_offset + payload.size()));
+        if (!encode_kvs_binary_value(payload, entry->second)) {
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid) {
+        result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+    }else if ((payload_offset + payload.size()) > UINT32_MAX) {
+        result = score::MakeUnexpected(ErrorCode::SerializationFailed); /* Offsets are 32 bit */
+    }else{
+        std::string out;
+        out.reserve(payload_offset + payload.size() + KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE);
+        out.append(KVS_DEFAULTS_IMAGE_MAGIC.data(), KVS_DEFAULTS_IMAGE_MAGIC.size());
+        out.push_back(static_cast<char>(KVS_DEFAULTS_IMAGE_VERSION));
+        put_u32(out, source_hash);
+        put_u32(out, static_cast<uint32_t>(entries.size()));
+        out.append(table);
+        out.append(payload);
+        put_u32(out, calculate_hash_adler32(out));
+        result = std::move(out);
+    }
+
+    return result;
+}
+
+/*********************** Image Reader *********************/
+KvsDefaultsImage::KvsDefaultsImage() : count(0)
+{
+}
+
+KvsDefaultsImage::~KvsDefaultsImage()
+{
+    unmap();
+}
+
+KvsDefaultsImage::KvsDefaultsImage(KvsDefaultsImage&& other) noexcept : data(other.data), count(other.count)
+{
+    other.data = std::string_view();
+    other.count = 0;
+}
+
+KvsDefaultsImage& KvsDefaultsImage::operator=(KvsDefaultsImage&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        data = other.data;
+        count = other.count;
+        other.data = std::string_view();
+        other.count = 0;
+    }
+    return *this;
+}
+
+void KvsDefaultsImage::unmap()
+{
+    if (!data.empty()) {
+        (void)munmap(const_cast<char*>(data.data()), data.size());
+        data = std::string_view();
+        count = 0;
+    }
+}
+
+/* Checks header, checksum and key table (bounds and order), values are checked when they are decoded */
+bool KvsDefaultsImage::validate(std::string_view image)
+{
+    bool valid = (image.size() >= (KVS_DEFAULTS_IMAGE_HEADER_SIZE + KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE))
+              && (0 == image.compare(0, KVS_DEFAULTS_IMAGE_MAGIC.size(), std::string_view(KVS_DEFAULTS_IMAGE_MAGIC.data(), KVS_DEFAULTS_IMAGE_MAGIC.size())))
+              && (KVS_DEFAULTS_IMAGE_VERSION == static_cast<uint8_t>(image[KVS_DEFAULTS_IMAGE_MAGIC.size()]));
+    if (valid) {
+        const size_t content_size = image.size() - KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE;
+        const uint32_t checksum = read_u32(image, content_size);
+        valid = (update_hash_adler32(1U, image.data(), content_size) == checksum);
+
+        const size_t entries = read_u32(image, KVS_DEFAULTS_IMAGE_HEADER_SIZE - 4U);
+        valid = valid && (entries <= ((content_size - KVS_DEFAULTS_IMAGE_HEADER_SIZE) / KVS_DEFAULTS_IMAGE_ENTRY_SIZE));
+        std::string_view previous_key;
+        for (size_t idx = 0; valid && (idx < entries); ++idx) {
+            const size_t entry_pos = KVS_DEFAULTS_IMAGE_HEADER_SIZE + (idx * KVS_DEFAULTS_IMAGE_ENTRY_SIZE);
+            const size_t key_offset = read_u32(image, entry_pos);
+            const size_t key_size = read_u32(image, entry_pos + 4U);
+            const size_t value_offset = read_u32(image, entry_pos + 8U);
+            valid = (key_offset <= content_size) && (key_size <= (content_size - key_offset)) && (value_offset < content_size);
+            if (valid) {
+                const std::string_view key = image.substr(key_offset, key_size);
+                valid = (idx == 0U) || (previous_key < key); /* Sorted and unique */
+                previous_key = key;
+            }
+        }
+    }
+
+    return valid;
+}
+
+score::Result<KvsDefaultsImage> KvsDefaultsImage::map_file(const std::string& path)
+{
+    score::Result<KvsDefaultsImage> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat file_stat{};
+    if ((fd < 0) || (0 != fstat(fd, &file_stat))) {
+        result = score::MakeUnexpected(ErrorCode::KvsFileReadError);
+    }else if (static_cast<size_t>(file_stat.st_size) < (KVS_DEFAULTS_IMAGE_HEADER_SIZE + KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE)) {
+        result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+    }else{
+        const size_t size = static_cast<size_t>(file_stat.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == mapping) {
+            result = score::MakeUnexpected(ErrorCode::KvsFileReadError);
+        }else{
+            KvsDefaultsImage image;
+            image.data = std::string_view(static_cast<const char*>(mapping), size); /* Unmapped by the destructor */
+            if (!validate(image.data)) {
+                result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+            }else{
+                image.count = read_u32(image.data, KVS_DEFAULTS_IMAGE_HEADER_SIZE - 4U);
+                result = std::move(image);
+            }
+        }
+    }
+    if (fd >= 0) {
+        (void)close(fd); /* The mapping stays valid */
+    }
+
+    return result;
+}
+
+bool KvsDefaultsImage::is_mapped() const
+{
+    return !data.empty();
+}
+
+uint32_t KvsDefaultsImage::source_hash() const
+{
+    uint32_t result = 0;
+    if (is_mapped()) {
+        result = read_u32(data, KVS_DEFAULTS_IMAGE_MAGIC.size() + 1U);
+    }
+    return result;
+}
+
+size_t KvsDefaultsImage::size() const
+{
+    return count;
+}
+
+/* Binary search in the sorted key table */
+bool KvsDefaultsImage::find(std::string_view key, size_t& value_offset) const
+{
+    bool found = false;
+    size_t low = 0;
+    size_t high = count;
+    while (!found && (low < high)) {
+        const size_t mid = low + ((high - low) / 2U);
+        const size_t entry_pos = KVS_DEFAULTS_IMAGE_HEADER_SIZE + (mid * KVS_DEFAULTS_IMAGE_ENTRY_SIZE);
+        const std::string_view entry_key = data.substr(read_u32(data, entry_pos), read_u32(data, entry_pos + 4U));
+        const int cmp = entry_key.compare(key);
+        if (cmp == 0) {
+            value_offset = read_u32(data, entry_pos + 8U);
+            found = true;
+        }else if (cmp < 0) {
+            low = mid + 1U;
+        }else{
+            high = mid;
+        }
+    }
+    return found;
+}
+
+bool KvsDefaultsImage::contains(std::string_view key) const
+{
+    size_t value_offset = 0;
+    return find(key, value_offset);
+}
+
+score::Result<KvsValue> KvsDefaultsImage::get(std::string_view key) const
+{
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    size_t value_offset = 0;
+
+    if (!find(key, value_offset)) {
+        result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+    }else{
+        KvsValue value(nullptr);
+        const std::string_view content = data.substr(0, data.size() - KVS_DEFAULTS_IMAGE_CHECKSUM_SIZE);
+        if (!decode_kvs_binary_value(content, value_offset, value)) {
+            result = score::MakeUnexpected(ErrorCode::SerializationFailed);
+        }else{
+            result = std::move(value);
+        }
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
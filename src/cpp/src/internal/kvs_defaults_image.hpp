@@ -0,0 +1,76 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_DEFAULTS_IMAGE_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_DEFAULTS_IMAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "error.hpp"
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the compiled, read-only image of the KVS default values (kvs_<id>_default.img).
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * The image is mapped read-only into the process (shared page-cache copy between all processes)
+ * and the default values are looked up directly in the mapping, without parsing the defaults JSON.
+ *
+ * File layout (all integers big endian, like the hash files):
+ *   [magic "KVSD": 4 bytes][version: 1 byte][source hash: 4 bytes][entry count: 4 bytes]
+ *   [key table: entry count * 12 bytes][keys and values][Adler-32 of all preceding bytes: 4 bytes]
+ * Key table entry (sorted by key, bytewise):
+ *   [key offset: 4 bytes][key length: 4 bytes][value offset: 4 bytes]
+ * Values use the value layout of the binary storage format (kvs_binary.hpp).
+ * The source hash is the Adler-32 of the defaults JSON file (content of kvs_<id>_default.hash),
+ * an image with another source hash is outdated.
+ */
+namespace score::mw::per::kvs {
+
+constexpr uint8_t KVS_DEFAULTS_IMAGE_VERSION = 1U;
+
+score::Result<std::string> serialize_defaults_image(const KvsMap& data, uint32_t source_hash);
+
+/* Read-only view of a validated defaults image, backed by a memory mapping */
+class KvsDefaultsImage final {
+public:
+    KvsDefaultsImage();
+    ~KvsDefaultsImage();
+    KvsDefaultsImage(KvsDefaultsImage&& other) noexcept;
+    KvsDefaultsImage& operator=(KvsDefaultsImage&& other) noexcept;
+    KvsDefaultsImage(const KvsDefaultsImage&) = delete;
+    KvsDefaultsImage& operator=(const KvsDefaultsImage&) = delete;
+
+    /* Map the image file read-only and validate it (ValidationFailed if invalid, KvsFileReadError if not readable) */
+    static score::Result<KvsDefaultsImage> map_file(const std::string& path);
+
+    bool is_mapped() const;
+    uint32_t source_hash() const;
+    size_t size() const;
+    bool contains(std::string_view key) const;
+    /* Decode the value of a key (KeyNotFound, SerializationFailed if the value is invalid) */
+    score::Result<KvsValue> get(std::string_view key) const;
+
+private:
+    std::string_view data; /* Mapped file */
+    uint32_t count;
+
+    void unmap();
+    static bool validate(std::string_view image);
+    bool find(std::string_view key, size_t& value_offset) const;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_DEFAULTS_IMAGE_HPP
@@ -17,11 +17,12 @@ namespace score::mw::per::kvs {
 /*********************** Hash Functions *********************/
 /*Adler 32 checksum algorithm*/
 // Optimized version: processes data in blocks to reduce modulo operations
-uint32_t calculate_hash_adler32(const std::string& data) {
+// Incremental version: continues the checksum hash over the next data chunk (start with hash 1)
+uint32_t update_hash_adler32(uint32_t hash, const char* data, size_t size) {
     constexpr size_t ADLER32_NMAX = 5552;
     constexpr uint32_t ADLER32_BASE = 65521;
-    uint32_t a = 1, b = 0;
-    size_t len = data.size();
+    uint32_t a = hash & 0xFFFF, b = (hash >> 16) & 0xFFFF;
+    size_t len = size;
     size_t i = 0;
 
     // Process in blocks of 5552 bytes (as recommended for Adler-32)
@@ -38,6 +39,10 @@ uint32_t calculate_hash_adler32(const std::string& data) {
     return (b << 16) | a;
 }
 
+uint32_t calculate_hash_adler32(const std::string& data) {
+    return update_hash_adler32(1U, data.data(), data.size());
+}
+
 /*Parse Adler32 checksum Byte-Array to uint32 */
 uint32_t parse_hash_adler32(std::istream& in)
 {
@@ -88,7 +93,117 @@ bool check_hash(const std::string& data_calculate, std::istream& data_parse){
     return result;
 }
 
+/*********************** Base64 (binary values in JSON) *********************/
+static constexpr char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static constexpr uint8_t BASE64_INVALID = 0xFFU;
+
+/* Decoding table: 6-bit value of a base64 character, BASE64_INVALID for other characters */
+static constexpr std::array<uint8_t, 256> make_base64_table() {
+    std::array<uint8_t, 256> table{};
+    for (auto& entry : table) {
+        entry = BASE64_INVALID;
+    }
+    for (uint8_t idx = 0; idx < 64U; ++idx) {
+        table[static_cast<uint8_t>(BASE64_ALPHABET[idx])] = idx;
+    }
+    return table;
+}
+static constexpr std::array<uint8_t, 256> BASE64_TABLE = make_base64_table();
+
+void encode_base64(std::string& out, const uint8_t* data, size_t size) {
+    const size_t start = out.size();
+    out.resize(start + (((size + 2U) / 3U) * 4U));
+    char* dst = &out[start];
+    size_t idx = 0;
+    for (; (idx + 3U) <= size; idx += 3U) {
+        const uint32_t group = (uint32_t(data[idx]) << 16) | (uint32_t(data[idx + 1U]) << 8) | uint32_t(data[idx + 2U]);
+        *dst++ = BASE64_ALPHABET[(group >> 18) & 0x3FU];
+        *dst++ = BASE64_ALPHABET[(group >> 12) & 0x3FU];
+        *dst++ = BASE64_ALPHABET[(group >> 6) & 0x3FU];
+        *dst++ = BASE64_ALPHABET[group & 0x3FU];
+    }
+    if (idx < size) {
+        /* Last 1 or 2 bytes, padded with '=' */
+        const bool two = (idx + 1U) < size;
+        const uint32_t group = (uint32_t(data[idx]) << 16) | (two ? (uint32_t(data[idx + 1U]) << 8) : 0U);
+        *dst++ = BASE64_ALPHABET[(group >> 18) & 0x3FU];
+        *dst++ = BASE64_ALPHABET[(group >> 12) & 0x3FU];
+        *dst++ = two ? BASE64_ALPHABET[(group >> 6) & 0x3FU] : '=';
+        *dst++ = '=';
+    }
+}
+
+/* Strict decoding: padded to a multiple of 4 characters, no whitespace */
+bool decode_base64(std::string_view in, KvsBytes& out) {
+    bool valid = (0U == (in.size() % 4U));
+    size_t padding = 0U;
+    if (valid && !in.empty()) {
+        padding = (in[in.size() - 1U] == '=') ? ((in[in.size() - 2U] == '=') ? 2U : 1U) : 0U;
+    }
+    const size_t size = ((in.size() / 4U) * 3U) - padding;
+    KvsBytes::Storage decoded_bytes(valid ? size : 0U);
+    if (valid) {
+        uint8_t* dst = decoded_bytes.data();
+        size_t written = 0;
+        for (size_t idx = 0; valid && (idx < in.size()); idx += 4U) {
+            const bool last = (idx + 4U) == in.size();
+            const uint8_t c0 = BASE64_TABLE[static_cast<uint8_t>(in[idx])];
+            const uint8_t c1 = BASE64_TABLE[static_cast<uint8_t>(in[idx + 1U])];
+            const uint8_t c2 = (last && (padding >= 2U)) ? 0U : BASE64_TABLE[static_cast<uint8_t>(in[idx + 2U])];
+            const uint8_t c3 = (last && (padding >= 1U)) ? 0U : BASE64_TABLE[static_cast<uint8_t>(in[idx + 3U])];
+            valid = (BASE64_INVALID != c0) && (BASE64_INVALID != c1) && (BASE64_INVALID != c2) && (BASE64_INVALID != c3);
+            if (valid) {
+                const uint32_t group = (uint32_t(c0) << 18) | (uint32_t(c1) << 12) | (uint32_t(c2) << 6) | uint32_t(c3);
+                const size_t count = last ? (3U - padding) : 3U;
+                const uint8_t decoded[3] = {uint8_t(group >> 16), uint8_t(group >> 8), uint8_t(group)};
+                for (size_t byte = 0; byte < count; ++byte) {
+                    dst[written++] = decoded[byte];
+                }
+            }
+        }
+    }
+
+    if (valid) {
+        out = KvsBytes(std::move(decoded_bytes));
+    }
+
+    return valid;
+}
+
 /*********************** Standalone Helper Functions *********************/
+/* Packed array from a JSON list of numbers of the element type */
+template <typename T>
+static bool any_to_packed(const score::json::Any& any, KvsValue& value) {
+    bool valid = false;
+    if (auto l = any.As<score::json::List>(); l.has_value()) {
+        typename KvsPackedArray<T>::Storage elements;
+        elements.reserve(l.value().get().size());
+        valid = true;
+        for (auto const& elem : l.value().get()) {
+            auto n = elem.As<T>();
+            if (!n.has_value()) {
+                valid = false;
+                break;
+            }
+            elements.push_back(n.value());
+        }
+        if (valid) {
+            value = KvsValue(KvsPackedArray<T>(std::move(elements)));
+        }
+    }
+    return valid;
+}
+
+/* Packed array to a JSON list of numbers */
+template <typename T>
+static score::json::Any packed_to_any(const KvsPackedArray<T>& array) {
+    score::json::List list;
+    for (const T number : array) {
+        list.push_back(score::json::Any(number));
+    }
+    return score::json::Any(std::move(list));
+}
+
 
 /* Helper Function for Any -> KVSValue conversion */
 score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any){
@@ -166,6 +281,37 @@ score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any){
                         result = score::MakeUnexpected(ErrorCode::InvalidValueType);
                     }
                 }
+                else if (typeStrV == "bin") {
+                    KvsValue::Bytes bytes;
+                    if (auto b = valueAny.As<std::string>(); b.has_value() && decode_base64(b.value().get(), bytes)) {
+                        result = KvsValue(std::move(bytes));
+                    }
+                    else {
+                        result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+                    }
+                }
+                else if ((typeStrV.size() == 7U) && (0 == typeStrV.compare(0U, 4U, "arr_"))) {
+                    const std::string_view element = typeStrV.substr(4U);
+                    KvsValue packed(nullptr);
+                    bool valid = false;
+                    if (element == "i32") {
+                        valid = any_to_packed<int32_t>(valueAny, packed);
+                    }else if (element == "u32") {
+                        valid = any_to_packed<uint32_t>(valueAny, packed);
+                    }else if (element == "i64") {
+                        valid = any_to_packed<int64_t>(valueAny, packed);
+                    }else if (element == "u64") {
+                        valid = any_to_packed<uint64_t>(valueAny, packed);
+                    }else if (element == "f64") {
+                        valid = any_to_packed<double>(valueAny, packed);
+                    }
+                    if (valid) {
+                        result = std::move(packed);
+                    }
+                    else {
+                        result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+                    }
+                }
                 else if (typeStrV == "arr") {
                     if (auto l = valueAny.As<score::json::List>(); l.has_value()) {
                         KvsValue::Array arr;
@@ -177,7 +323,7 @@ score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any){
                                 result = score::MakeUnexpected(ErrorCode::InvalidValueType);
                                 break;
                             }
-                            arr.emplace_back(std::make_shared<KvsValue>(std::move(conv.value())));
+                            arr.push_back(std::move(conv.value()));
                         }
                         if (!error){
                             result = KvsValue(std::move(arr));
@@ -188,7 +334,7 @@ score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any){
                 }
                 else if (typeStrV == "obj") {
                     if (auto obj = valueAny.As<score::json::Object>(); obj.has_value()) {
-                        KvsValue::Object map;
+                        KvsValue::Object::Members map;
                         bool error = false;
                         for (auto const& [key, valAny] : obj.value().get()) {
                             auto conv = any_to_kvsvalue(valAny);
@@ -197,10 +343,10 @@ score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any){
                                 result = score::MakeUnexpected(ErrorCode::InvalidValueType);
                                 break;
                             }
-                            map.emplace(key.GetAsStringView().to_string(), std::make_shared<KvsValue>(std::move(conv.value())));
+                            map.emplace_back(key.GetAsStringView().to_string(), std::move(conv.value()));
                         }
                         if (!error) {
-                            result = KvsValue(std::move(map));
+                            result = KvsValue(KvsValue::Object(std::move(map)));
                         }
                     } else {
                         result = score::MakeUnexpected(ErrorCode::InvalidValueType);
@@ -271,7 +417,7 @@ score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv) {
             obj.emplace("t", score::json::Any(std::string("arr")));
             score::json::List list;
             for (auto& elem : std::get<KvsValue::Array>(kv.getValue())) {
-                auto conv = kvsvalue_to_any(*elem);
+                auto conv = kvsvalue_to_any(elem);
                 if (!conv) {
                     result = score::MakeUnexpected(ErrorCode::InvalidValueType);
                     error = true;
@@ -288,7 +434,7 @@ score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv) {
             obj.emplace("t", score::json::Any(std::string("obj")));
             score::json::Object inner_obj;
             for (auto& [key, value] : std::get<KvsValue::Object>(kv.getValue())) {
-                auto conv = kvsvalue_to_any(*value);
+                auto conv = kvsvalue_to_any(value);
                 if (!conv) {
                     result = score::MakeUnexpected(ErrorCode::InvalidValueType);
                     error = true;
@@ -301,6 +447,39 @@ score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv) {
             }
             break;
         }
+        case KvsValue::Type::Bytes: {
+            const auto& bytes = std::get<KvsValue::Bytes>(kv.getValue());
+            std::string encoded;
+            encode_base64(encoded, bytes.data(), bytes.size());
+            obj.emplace("t", score::json::Any(std::string("bin")));
+            obj.emplace("v", score::json::Any(std::move(encoded)));
+            break;
+        }
+        case KvsValue::Type::ArrayI32: {
+            obj.emplace("t", score::json::Any(std::string("arr_i32")));
+            obj.emplace("v", packed_to_any(std::get<KvsValue::ArrayI32>(kv.getValue())));
+            break;
+        }
+        case KvsValue::Type::ArrayU32: {
+            obj.emplace("t", score::json::Any(std::string("arr_u32")));
+            obj.emplace("v", packed_to_any(std::get<KvsValue::ArrayU32>(kv.getValue())));
+            break;
+        }
+        case KvsValue::Type::ArrayI64: {
+            obj.emplace("t", score::json::Any(std::string("arr_i64")));
+            obj.emplace("v", packed_to_any(std::get<KvsValue::ArrayI64>(kv.getValue())));
+            break;
+        }
+        case KvsValue::Type::ArrayU64: {
+            obj.emplace("t", score::json::Any(std::string("arr_u64")));
+            obj.emplace("v", packed_to_any(std::get<KvsValue::ArrayU64>(kv.getValue())));
+            break;
+        }
+        case KvsValue::Type::ArrayF64: {
+            obj.emplace("t", score::json::Any(std::string("arr_f64")));
+            obj.emplace("v", packed_to_any(std::get<KvsValue::ArrayF64>(kv.getValue())));
+            break;
+        }
         default: {
             result = score::MakeUnexpected(ErrorCode::InvalidValueType);
             error = true;
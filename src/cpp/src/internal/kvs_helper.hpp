@@ -15,6 +15,7 @@
 
 #include <sstream>
 #include <string>
+#include <string_view>
 #include "error.hpp"
 #include "kvsvalue.hpp"
 #include "score/json/json_parser.h" /* For JSON Any Type */
@@ -26,10 +27,14 @@
 namespace score::mw::per::kvs {
 
 uint32_t parse_hash_adler32(std::istream& in);
+uint32_t update_hash_adler32(uint32_t hash, const char* data, size_t size);
 uint32_t calculate_hash_adler32(const std::string& data);
 std::array<uint8_t,4> get_hash_bytes_adler32(uint32_t hash);
 std::array<uint8_t,4> get_hash_bytes(const std::string& data);
 bool check_hash(const std::string& data_calculate, std::istream& data_parse);
+/* Base64 encoding of binary values in JSON (appended to out), decode_base64 returns false for invalid input */
+void encode_base64(std::string& out, const uint8_t* data, size_t size);
+bool decode_base64(std::string_view in, KvsBytes& out);
 score::Result<KvsValue> any_to_kvsvalue(const score::json::Any& any);
 score::Result<score::json::Any> kvsvalue_to_any(const KvsValue& kv);
 
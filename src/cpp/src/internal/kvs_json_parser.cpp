@@ -0,0 +1,576 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "kvs_helper.hpp"
+#include "kvs_json_parser.hpp"
+
+namespace score::mw::per::kvs {
+
+/* Single pass reader over the raw JSON buffer */
+class KvsJsonReader final {
+public:
+    KvsJsonReader(std::string_view data, KvsResource* resource)
+        : data(data), pos(0), error(ErrorCode::JsonParserError), resource(resource) {}
+
+    /* Parse the root object with all key-value pairs */
+    bool parse_root(KvsMap& result) {
+        bool valid = consume('{');
+        if (valid && !consume('}')) {
+            do {
+                std::string key;
+                KvsValue value(nullptr);
+                valid = parse_string(key) && consume(':') && parse_typed_value(value, 0U);
+                if (valid) {
+                    result.insert_or_assign(std::move(key), std::move(value));
+                }
+            } while (valid && consume(','));
+            valid = valid && consume('}');
+        }
+        skip_whitespace();
+        valid = valid && (pos == data.size());
+        return valid;
+    }
+
+    ErrorCode last_error() const { return error; }
+
+private:
+    std::string_view data;
+    size_t pos;
+    ErrorCode error;
+    KvsResource* resource; /* Resource of the arrays and objects (nullptr: operator new) */
+
+    bool fail_schema() {
+        error = ErrorCode::InvalidValueType;
+        return false;
+    }
+
+    void skip_whitespace() {
+        while ((pos < data.size()) && ((data[pos] == ' ') || (data[pos] == '\n') || (data[pos] == '\r') || (data[pos] == '\t'))) {
+            ++pos;
+        }
+    }
+
+    /* Consume the next non-whitespace character, if it matches */
+    bool consume(char c) {
+        skip_whitespace();
+        bool found = (pos < data.size()) && (data[pos] == c);
+        if (found) {
+            ++pos;
+        }
+        return found;
+    }
+
+    bool consume_literal(std::string_view literal) {
+        skip_whitespace();
+        bool found = (0 == data.compare(pos, literal.size(), literal));
+        if (found) {
+            pos += literal.size();
+        }
+        return found;
+    }
+
+    static bool parse_hex4(std::string_view hex, uint32_t& value) {
+        bool valid = (hex.size() == 4U);
+        value = 0;
+        for (size_t idx = 0; valid && (idx < 4U); ++idx) {
+            const char c = hex[idx];
+            value <<= 4;
+            if ((c >= '0') && (c <= '9')) {
+                value |= static_cast<uint32_t>(c - '0');
+            }else if ((c >= 'a') && (c <= 'f')) {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            }else if ((c >= 'A') && (c <= 'F')) {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
+            }else{
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    static void append_utf8(std::string& out, uint32_t code_point) {
+        if (code_point < 0x80U) {
+            out.push_back(static_cast<char>(code_point));
+        }else if (code_point < 0x800U) {
+            out.push_back(static_cast<char>(0xC0U | (code_point >> 6)));
+            out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+        }else if (code_point < 0x10000U) {
+            out.push_back(static_cast<char>(0xE0U | (code_point >> 12)));
+            out.push_back(static_cast<char>(0x80U | ((code_point >> 6) & 0x3FU)));
+            out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+        }else{
+            out.push_back(static_cast<char>(0xF0U | (code_point >> 18)));
+            out.push_back(static_cast<char>(0x80U | ((code_point >> 12) & 0x3FU)));
+            out.push_back(static_cast<char>(0x80U | ((code_point >> 6) & 0x3FU)));
+            out.push_back(static_cast<char>(0x80U | (code_point & 0x3FU)));
+        }
+    }
+
+    /* Parse a JSON string, unescaped runs are appended in one step */
+    bool parse_string(std::string& out) {
+        bool valid = consume('"');
+        bool done = false;
+        while (valid && !done) {
+            size_t run = pos;
+            while ((run < data.size()) && (data[run] != '"') && (data[run] != '\\') && (static_cast<unsigned char>(data[run]) >= 0x20U)) {
+                ++run;
+            }
+            out.append(data.substr(pos, run - pos));
+            pos = run;
+            if (pos >= data.size()) {
+                valid = false;
+            }else if (data[pos] == '"') {
+                ++pos;
+                done = true;
+            }else if (data[pos] == '\\') {
+                valid = parse_escape(out);
+            }else{
+                valid = false; /* Unescaped control character */
+            }
+        }
+        return valid;
+    }
+
+    bool parse_escape(std::string& out) {
+        bool valid = (pos + 1U) < data.size();
+        if (valid) {
+            const char c = data[pos + 1U];
+            pos += 2U;
+            switch (c) {
+                case '"':  out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/':  out.push_back('/'); break;
+                case 'b':  out.push_back('\b'); break;
+                case 'f':  out.push_back('\f'); break;
+                case 'n':  out.push_back('\n'); break;
+                case 'r':  out.push_back('\r'); break;
+                case 't':  out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t code_point = 0;
+                    valid = parse_hex4(data.substr(pos, 4U), code_point);
+                    pos += 4U;
+                    if (valid && (code_point >= 0xD800U) && (code_point <= 0xDBFFU)) {
+                        /* Surrogate pair */
+                        uint32_t low = 0;
+                        valid = (0 == data.compare(pos, 2U, "\\u")) && parse_hex4(data.substr(pos + 2U, 4U), low)
+                             && (low >= 0xDC00U) && (low <= 0xDFFFU);
+                        pos += 6U;
+                        code_point = 0x10000U + ((code_point - 0xD800U) << 10) + (low - 0xDC00U);
+                    }else if (valid && (code_point >= 0xDC00U) && (code_point <= 0xDFFFU)) {
+                        valid = false;
+                    }
+                    if (valid) {
+                        append_utf8(out, code_point);
+                    }
+                    break;
+                }
+                default:
+                    valid = false;
+                    break;
+            }
+        }
+        return valid;
+    }
+
+    /* Scan a JSON number token, integral is false if it has a fraction or exponent */
+    bool scan_number(std::string_view& token, bool& integral) {
+        skip_whitespace();
+        const size_t start = pos;
+        integral = true;
+        if ((pos < data.size()) && (data[pos] == '-')) {
+            ++pos;
+        }
+        const size_t int_start = pos;
+        while ((pos < data.size()) && (data[pos] >= '0') && (data[pos] <= '9')) {
+            ++pos;
+        }
+        bool valid = (pos > int_start) && ((data[int_start] != '0') || (pos == int_start + 1U)); /* No leading zeros */
+        if (valid && (pos < data.size()) && (data[pos] == '.')) {
+            integral = false;
+            const size_t frac_start = ++pos;
+            while ((pos < data.size()) && (data[pos] >= '0') && (data[pos] <= '9')) {
+                ++pos;
+            }
+            valid = (pos > frac_start);
+        }
+        if (valid && (pos < data.size()) && ((data[pos] == 'e') || (data[pos] == 'E'))) {
+            integral = false;
+            ++pos;
+            if ((pos < data.size()) && ((data[pos] == '+') || (data[pos] == '-'))) {
+                ++pos;
+            }
+            const size_t exp_start = pos;
+            while ((pos < data.size()) && (data[pos] >= '0') && (data[pos] <= '9')) {
+                ++pos;
+            }
+            valid = (pos > exp_start);
+        }
+        token = data.substr(start, pos - start);
+        return valid;
+    }
+
+    /* Check for a number token, other JSON values are a type mismatch */
+    bool expect_number() {
+        skip_whitespace();
+        bool valid = (pos < data.size()) && ((data[pos] == '-') || ((data[pos] >= '0') && (data[pos] <= '9')));
+        if (!valid) {
+            valid = skip_value(0U) && fail_schema();
+        }
+        return valid;
+    }
+
+    bool parse_double(double& number) {
+        std::string_view token;
+        bool integral = false;
+        bool valid = expect_number() && scan_number(token, integral);
+        if (valid) {
+            auto res = std::from_chars(token.data(), token.data() + token.size(), number);
+            valid = (res.ec == std::errc()) && (res.ptr == token.data() + token.size());
+            if (!valid) {
+                (void)fail_schema(); /* Out of range */
+            }
+        }
+        return valid;
+    }
+
+    template <typename T>
+    bool parse_integer(T& number) {
+        std::string_view token;
+        bool integral = false;
+        bool valid = expect_number() && scan_number(token, integral);
+        if (valid && integral) {
+            auto res = std::from_chars(token.data(), token.data() + token.size(), number);
+            valid = ((res.ec == std::errc()) && (res.ptr == token.data() + token.size())) || fail_schema();
+        }else if (valid) {
+            /* Number with fraction or exponent, accepted if the value is integral and in range */
+            double value = 0.0;
+            auto res = std::from_chars(token.data(), token.data() + token.size(), value);
+            valid = (res.ec == std::errc()) && (std::trunc(value) == value)
+                 && (value >= static_cast<double>(std::numeric_limits<T>::min()))
+                 && (value < std::ldexp(1.0, std::numeric_limits<T>::digits)); /* max() + 1 is exact in double */
+            if (valid) {
+                number = static_cast<T>(value);
+            }else{
+                (void)fail_schema();
+            }
+        }
+        return valid;
+    }
+
+    /* Dispatch the type tag by length and first character, so each tag needs only one comparison */
+    static bool parse_type_tag(std::string_view tag, KvsValue::Type& type) {
+        bool valid = false;
+        if (tag.size() == 3U) {
+            switch (tag[0]) {
+                case 'i': valid = (tag == "i32") || (tag == "i64"); type = (tag[1] == '3') ? KvsValue::Type::i32 : KvsValue::Type::i64; break;
+                case 'u': valid = (tag == "u32") || (tag == "u64"); type = (tag[1] == '3') ? KvsValue::Type::u32 : KvsValue::Type::u64; break;
+                case 'f': valid = (tag == "f64"); type = KvsValue::Type::f64; break;
+                case 's': valid = (tag == "str"); type = KvsValue::Type::String; break;
+                case 'a': valid = (tag == "arr"); type = KvsValue::Type::Array; break;
+                case 'o': valid = (tag == "obj"); type = KvsValue::Type::Object; break;
+                case 'b': valid = (tag == "bin"); type = KvsValue::Type::Bytes; break;
+                default: break;
+            }
+        }else if (tag.size() == 4U) {
+            if (tag == "bool") {
+                valid = true;
+                type = KvsValue::Type::Boolean;
+            }else if (tag == "null") {
+                valid = true;
+                type = KvsValue::Type::Null;
+            }
+        }else if ((tag.size() == 7U) && (0 == tag.compare(0U, 4U, "arr_"))) {
+            /* Packed arrays: "arr_" and the element type */
+            const std::string_view element = tag.substr(4U);
+            valid = true;
+            if (element == "i32") {
+                type = KvsValue::Type::ArrayI32;
+            }else if (element == "u32") {
+                type = KvsValue::Type::ArrayU32;
+            }else if (element == "i64") {
+                type = KvsValue::Type::ArrayI64;
+            }else if (element == "u64") {
+                type = KvsValue::Type::ArrayU64;
+            }else if (element == "f64") {
+                type = KvsValue::Type::ArrayF64;
+            }else{
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    /* Parse a JSON array of numbers into a packed array */
+    template <typename T>
+    bool parse_packed(KvsValue& value, size_t depth) {
+        bool valid = consume('[') || (skip_value(depth + 1U) && fail_schema());
+        typename KvsPackedArray<T>::Storage elements;
+        if (valid && !consume(']')) {
+            do {
+                T number{};
+                if constexpr (std::is_same_v<T, double>) {
+                    valid = parse_double(number);
+                }else{
+                    valid = parse_integer(number);
+                }
+                elements.push_back(number);
+            } while (valid && consume(','));
+            valid = valid && consume(']');
+        }
+        value = KvsValue(KvsPackedArray<T>(std::move(elements)));
+        return valid;
+    }
+
+    /* Skip any JSON value (used for "v" members before "t" and unknown members) */
+    bool skip_value(size_t depth) {
+        bool valid = depth < KVS_JSON_MAX_DEPTH;
+        skip_whitespace();
+        if (!valid || (pos >= data.size())) {
+            valid = false;
+        }else if (data[pos] == '"') {
+            std::string ignored;
+            valid = parse_string(ignored);
+        }else if (data[pos] == '{') {
+            ++pos;
+            if (!consume('}')) {
+                do {
+                    std::string ignored;
+                    valid = parse_string(ignored) && consume(':') && skip_value(depth + 1U);
+                } while (valid && consume(','));
+                valid = valid && consume('}');
+            }
+        }else if (data[pos] == '[') {
+            ++pos;
+            if (!consume(']')) {
+                do {
+                    valid = skip_value(depth + 1U);
+                } while (valid && consume(','));
+                valid = valid && consume(']');
+            }
+        }else if (consume_literal("true") || consume_literal("false") || consume_literal("null")) {
+            valid = true;
+        }else{
+            std::string_view token;
+            bool integral = false;
+            valid = scan_number(token, integral);
+        }
+        return valid;
+    }
+
+    /* Parse a {"t":..,"v":..} object */
+    bool parse_typed_value(KvsValue& value, size_t depth) {
+        bool valid = (depth < KVS_JSON_MAX_DEPTH) && (consume('{') || (skip_value(depth) && fail_schema()));
+        bool has_type = false;
+        bool has_value = false;
+        KvsValue::Type type = KvsValue::Type::Null;
+        size_t deferred_pos = 0; /* Position of "v", if it was found before "t" */
+        bool deferred = false;
+
+        if (valid && !consume('}')) {
+            do {
+                std::string member;
+                valid = parse_string(member) && consume(':');
+                if (valid && (member == "t")) {
+                    std::string tag;
+                    skip_whitespace();
+                    if ((pos < data.size()) && (data[pos] == '"')) {
+                        valid = parse_string(tag) && (parse_type_tag(tag, type) || fail_schema());
+                    }else{
+                        valid = skip_value(depth + 1U) && fail_schema();
+                    }
+                    has_type = valid;
+                }else if (valid && (member == "v") && has_type) {
+                    valid = parse_value(type, value, depth);
+                    has_value = valid;
+                }else if (valid && (member == "v")) {
+                    skip_whitespace();
+                    deferred_pos = pos;
+                    deferred = true;
+                    valid = skip_value(depth + 1U);
+                }else if (valid) {
+                    valid = skip_value(depth + 1U); /* Unknown members are ignored */
+                }
+            } while (valid && consume(','));
+            valid = valid && consume('}');
+        }
+
+        if (valid && has_type && !has_value && deferred) {
+            const size_t end_pos = pos;
+            pos = deferred_pos;
+            valid = parse_value(type, value, depth);
+            has_value = valid;
+            pos = end_pos;
+        }
+        if (valid && !(has_type && has_value)) {
+            valid = fail_schema(); /* Missing "t" or "v" */
+        }
+        return valid;
+    }
+
+    /* Parse the "v" member for a known type */
+    bool parse_value(KvsValue::Type type, KvsValue& value, size_t depth) {
+        bool valid = false;
+        switch (type) {
+            case KvsValue::Type::i32: {
+                int32_t number = 0;
+                valid = parse_integer(number);
+                value = KvsValue(number);
+                break;
+            }
+            case KvsValue::Type::u32: {
+                uint32_t number = 0;
+                valid = parse_integer(number);
+                value = KvsValue(number);
+                break;
+            }
+            case KvsValue::Type::i64: {
+                int64_t number = 0;
+                valid = parse_integer(number);
+                value = KvsValue(number);
+                break;
+            }
+            case KvsValue::Type::u64: {
+                uint64_t number = 0;
+                valid = parse_integer(number);
+                value = KvsValue(number);
+                break;
+            }
+            case KvsValue::Type::f64: {
+                double number = 0.0;
+                valid = parse_double(number);
+                value = KvsValue(number);
+                break;
+            }
+            case KvsValue::Type::Boolean: {
+                if (consume_literal("true")) {
+                    valid = true;
+                    value = KvsValue(true);
+                }else if (consume_literal("false")) {
+                    valid = true;
+                    value = KvsValue(false);
+                }else{
+                    valid = skip_value(depth + 1U) && fail_schema();
+                }
+                break;
+            }
+            case KvsValue::Type::String: {
+                skip_whitespace();
+                if ((pos < data.size()) && (data[pos] == '"')) {
+                    std::string str;
+                    valid = parse_string(str);
+                    value = KvsValue(std::move(str));
+                }else{
+                    valid = skip_value(depth + 1U) && fail_schema();
+                }
+                break;
+            }
+            case KvsValue::Type::Null: {
+                valid = consume_literal("null") || (skip_value(depth + 1U) && fail_schema());
+                value = KvsValue(nullptr);
+                break;
+            }
+            case KvsValue::Type::Array: {
+                valid = consume('[') || (skip_value(depth + 1U) && fail_schema());
+                KvsValue::Array::Elements elements{KvsAllocator<KvsValue>(resource)};
+                if (valid && !consume(']')) {
+                    do {
+                        KvsValue elem(nullptr);
+                        valid = parse_typed_value(elem, depth + 1U);
+                        elements.push_back(std::move(elem));
+                    } while (valid && consume(','));
+                    valid = valid && consume(']');
+                }
+                value = KvsValue(KvsValue::Array(std::move(elements)));
+                break;
+            }
+            case KvsValue::Type::Object: {
+                valid = consume('{') || (skip_value(depth + 1U) && fail_schema());
+                KvsValue::Object::Members members{KvsAllocator<KvsValue::Object::value_type>(resource)};
+                if (valid && !consume('}')) {
+                    do {
+                        std::string key;
+                        KvsValue elem(nullptr);
+                        valid = parse_string(key) && consume(':') && parse_typed_value(elem, depth + 1U);
+                        members.emplace_back(std::move(key), std::move(elem));
+                    } while (valid && consume(','));
+                    valid = valid && consume('}');
+                }
+                value = KvsValue(KvsValue::Object(std::move(members))); /* Written in key order: not sorted again */
+                break;
+            }
+            case KvsValue::Type::Bytes: {
+                skip_whitespace();
+                if ((pos < data.size()) && (data[pos] == '"')) {
+                    /* Base64 doesn't need escapes: decode directly from the buffer, if the string has none */
+                    const size_t end = data.find_first_of("\"\\", pos + 1U);
+                    KvsValue::Bytes bytes;
+                    if ((std::string_view::npos != end) && (data[end] == '"')) {
+                        valid = decode_base64(data.substr(pos + 1U, end - pos - 1U), bytes) || fail_schema();
+                        pos = end + 1U;
+                    }else{
+                        std::string str;
+                        valid = parse_string(str) && (decode_base64(str, bytes) || fail_schema());
+                    }
+                    value = KvsValue(std::move(bytes));
+                }else{
+                    valid = skip_value(depth + 1U) && fail_schema();
+                }
+                break;
+            }
+            case KvsValue::Type::ArrayI32: {
+                valid = parse_packed<int32_t>(value, depth);
+                break;
+            }
+            case KvsValue::Type::ArrayU32: {
+                valid = parse_packed<uint32_t>(value, depth);
+                break;
+            }
+            case KvsValue::Type::ArrayI64: {
+                valid = parse_packed<int64_t>(value, depth);
+                break;
+            }
+            case KvsValue::Type::ArrayU64: {
+                valid = parse_packed<uint64_t>(value, depth);
+                break;
+            }
+            case KvsValue::Type::ArrayF64: {
+                valid = parse_packed<double>(value, depth);
+                break;
+            }
+            default:
+                break;
+        }
+        return valid;
+    }
+};
+
+/*********************** KVS JSON Loader *********************/
+score::Result<KvsMap> parse_kvs_json(std::string_view data, KvsResource* resource)
+{
+    score::Result<KvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    KvsJsonReader reader(data, resource);
+    KvsMap result_value{KvsMap::allocator_type(resource)};
+
+    if (reader.parse_root(result_value)) {
+        result = std::move(result_value);
+    }else{
+        result = score::MakeUnexpected(reader.last_error());
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
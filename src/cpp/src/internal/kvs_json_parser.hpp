@@ -0,0 +1,43 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_JSON_PARSER_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_JSON_PARSER_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "error.hpp"
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the event-driven JSON loader of the KVS files.
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * The loader reads the KVS file schema ({"key":{"t":"i32","v":5},...}) in one pass from the raw buffer
+ * and constructs the KvsValue objects directly, without an intermediate score::json::Any tree.
+ * A "v" member before its "t" member is skipped first and parsed when the type is known.
+ *
+ * Errors: JsonParserError for malformed JSON, InvalidValueType for a valid JSON document which
+ * doesn't match the KVS schema (unknown type tag, value doesn't match the type).
+ */
+namespace score::mw::per::kvs {
+
+/* Maximum nesting depth of arrays and objects */
+constexpr size_t KVS_JSON_MAX_DEPTH = 128U;
+
+/* The map, arrays and objects are allocated from resource (nullptr: operator new) */
+score::Result<KvsMap> parse_kvs_json(std::string_view data, KvsResource* resource = nullptr);
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_JSON_PARSER_HPP
@@ -0,0 +1,319 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "kvs_helper.hpp"
+#include "kvs_json_stream.hpp"
+
+namespace score::mw::per::kvs {
+
+/* Fixed-size output buffer, flushed to the stream in chunks while updating the checksum */
+class JsonStreamBuffer final {
+public:
+    JsonStreamBuffer(std::ostream& out, size_t buffer_size)
+        : out(out)
+        , buffer(buffer_size > 0U ? buffer_size : 1U)
+        , used(0)
+        , hash(1U)
+        , failed(false)
+    {}
+
+    void append(const char* data, size_t size) {
+        while (size > 0U) {
+            if (used == buffer.size()) {
+                flush();
+            }
+            const size_t chunk = std::min(size, buffer.size() - used);
+            std::copy(data, data + chunk, buffer.data() + used);
+            used += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    void append(std::string_view str) { append(str.data(), str.size()); }
+
+    void append(char c) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        buffer[used] = c;
+        ++used;
+    }
+
+    void flush() {
+        if (!failed && (used > 0U)) {
+            hash = update_hash_adler32(hash, buffer.data(), used);
+            if (!out.write(buffer.data(), used)) {
+                failed = true;
+            }
+        }
+        used = 0;
+    }
+
+    bool good() const { return !failed; }
+    uint32_t checksum() const { return hash; }
+
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used;
+    uint32_t hash;
+    bool failed;
+};
+
+/* Write a JSON string with escaping */
+static void put_string(JsonStreamBuffer& buf, std::string_view str)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+    buf.append('"');
+    size_t start = 0;
+    for (size_t idx = 0; idx < str.size(); ++idx) {
+        const unsigned char c = static_cast<unsigned char>(str[idx]);
+        if ((c >= 0x20U) && (c != '"') && (c != '\\')) {
+            continue;
+        }
+        buf.append(str.substr(start, idx - start));
+        start = idx + 1U;
+        switch (c) {
+            case '"':  buf.append("\\\""); break;
+            case '\\': buf.append("\\\\"); break;
+            case '\b': buf.append("\\b"); break;
+            case '\f': buf.append("\\f"); break;
+            case '\n': buf.append("\\n"); break;
+            case '\r': buf.append("\\r"); break;
+            case '\t': buf.append("\\t"); break;
+            default: {
+                const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0FU]};
+                buf.append(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+    buf.append(str.substr(start));
+    buf.append('"');
+}
+
+/* Write an integer number */
+template <typename T>
+static void put_integer(JsonStreamBuffer& buf, T number)
+{
+    std::array<char, 24> chars{};
+    auto res = std::to_chars(chars.data(), chars.data() + chars.size(), number);
+    buf.append(chars.data(), static_cast<size_t>(res.ptr - chars.data()));
+}
+
+/* Write a floating point number (shortest round-trip representation, always with fraction or exponent) */
+static bool put_double(JsonStreamBuffer& buf, double number)
+{
+    bool valid = std::isfinite(number); /* JSON can't represent NaN and infinity */
+    if (valid) {
+        std::array<char, 32> chars{};
+        auto res = std::to_chars(chars.data(), chars.data() + chars.size(), number);
+        std::string_view str(chars.data(), static_cast<size_t>(res.ptr - chars.data()));
+        buf.append(str);
+        if (std::string_view::npos == str.find_first_of(".e")) {
+            buf.append(".0"); /* Keep the number a floating point number for the parser */
+        }
+    }
+    return valid;
+}
+
+/* Write binary data as base64 (encoded in blocks, the padding is only added to the last block) */
+static void put_base64(JsonStreamBuffer& buf, const KvsBytes& bytes)
+{
+    constexpr size_t BLOCK_SIZE = 3U * 1024U;
+    std::string encoded;
+    for (size_t offset = 0; offset < bytes.size(); offset += BLOCK_SIZE) {
+        encoded.clear();
+        encode_base64(encoded, bytes.data() + offset, std::min(BLOCK_SIZE, bytes.size() - offset));
+        buf.append(encoded);
+    }
+}
+
+/* Write a packed array as one JSON array of numbers, the type tag is written once */
+template <typename T>
+static bool put_packed(JsonStreamBuffer& buf, std::string_view prefix, const KvsPackedArray<T>& array)
+{
+    bool valid = true;
+    buf.append(prefix);
+    for (size_t idx = 0; valid && (idx < array.size()); ++idx) {
+        if (0U != idx) {
+            buf.append(',');
+        }
+        if constexpr (std::is_same_v<T, double>) {
+            valid = put_double(buf, array[idx]);
+        }else{
+            put_integer(buf, array[idx]);
+        }
+    }
+    buf.append(']');
+    return valid;
+}
+
+static bool put_value(JsonStreamBuffer& buf, const KvsValue& value)
+{
+    bool valid = true;
+    switch (value.getType()) {
+        case KvsValue::Type::i32: {
+            buf.append(R"({"t":"i32","v":)");
+            put_integer(buf, std::get<int32_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::u32: {
+            buf.append(R"({"t":"u32","v":)");
+            put_integer(buf, std::get<uint32_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::i64: {
+            buf.append(R"({"t":"i64","v":)");
+            put_integer(buf, std::get<int64_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::u64: {
+            buf.append(R"({"t":"u64","v":)");
+            put_integer(buf, std::get<uint64_t>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::f64: {
+            buf.append(R"({"t":"f64","v":)");
+            valid = put_double(buf, std::get<double>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::Boolean: {
+            buf.append(R"({"t":"bool","v":)");
+            buf.append(std::get<bool>(value.getValue()) ? "true" : "false");
+            break;
+        }
+        case KvsValue::Type::String: {
+            buf.append(R"({"t":"str","v":)");
+            put_string(buf, std::get<std::string>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::Null: {
+            buf.append(R"({"t":"null","v":null)");
+            break;
+        }
+        case KvsValue::Type::Array: {
+            buf.append(R"({"t":"arr","v":[)");
+            bool first = true;
+            for (const auto& elem : std::get<KvsValue::Array>(value.getValue())) {
+                if (!first) {
+                    buf.append(',');
+                }
+                first = false;
+                if (!put_value(buf, elem)) {
+                    valid = false;
+                    break;
+                }
+            }
+            buf.append(']');
+            break;
+        }
+        case KvsValue::Type::Object: {
+            buf.append(R"({"t":"obj","v":{)");
+            bool first = true;
+            for (const auto& [key, elem] : std::get<KvsValue::Object>(value.getValue())) {
+                if (!first) {
+                    buf.append(',');
+                }
+                first = false;
+                put_string(buf, key);
+                buf.append(':');
+                if (!put_value(buf, elem)) {
+                    valid = false;
+                    break;
+                }
+            }
+            buf.append('}');
+            break;
+        }
+        case KvsValue::Type::Bytes: {
+            buf.append(R"({"t":"bin","v":")");
+            put_base64(buf, std::get<KvsValue::Bytes>(value.getValue()));
+            buf.append('"');
+            break;
+        }
+        case KvsValue::Type::ArrayI32: {
+            valid = put_packed(buf, R"({"t":"arr_i32","v":[)", std::get<KvsValue::ArrayI32>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayU32: {
+            valid = put_packed(buf, R"({"t":"arr_u32","v":[)", std::get<KvsValue::ArrayU32>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayI64: {
+            valid = put_packed(buf, R"({"t":"arr_i64","v":[)", std::get<KvsValue::ArrayI64>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayU64: {
+            valid = put_packed(buf, R"({"t":"arr_u64","v":[)", std::get<KvsValue::ArrayU64>(value.getValue()));
+            break;
+        }
+        case KvsValue::Type::ArrayF64: {
+            valid = put_packed(buf, R"({"t":"arr_f64","v":[)", std::get<KvsValue::ArrayF64>(value.getValue()));
+            break;
+        }
+        default: {
+            valid = false;
+            break;
+        }
+    }
+    buf.append('}');
+
+    return valid;
+}
+
+/*********************** Streaming JSON Serializer *********************/
+score::Result<uint32_t> stream_json_data(const KvsMap& data, std::ostream& out, size_t buffer_size)
+{
+    score::Result<uint32_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    JsonStreamBuffer buf(out, buffer_size);
+    bool valid = true;
+
+    buf.append('{');
+    bool first = true;
+    for (const auto& [key, value] : data) {
+        if (!first) {
+            buf.append(',');
+        }
+        first = false;
+        put_string(buf, key);
+        buf.append(':');
+        if (!put_value(buf, value)) {
+            valid = false;
+            break;
+        }
+        if (!buf.good()) {
+            break; /* Stop early, output stream failed */
+        }
+    }
+    buf.append('}');
+    buf.flush();
+
+    if (!valid) {
+        result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+    }else if (!buf.good()) {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }else{
+        result = buf.checksum();
+    }
+
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,41 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_JSON_STREAM_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_JSON_STREAM_HPP
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "error.hpp"
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the streaming JSON serializer of the KVS.
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * The serializer walks the KVS data and emits the KVS JSON layout ({"key":{"t":"i32","v":5},...})
+ * into a fixed-size buffer, which is written to the output stream whenever it is full.
+ * The Adler-32 checksum is updated per written chunk, so the memory needed for serialization
+ * is independent of the KVS size.
+ */
+namespace score::mw::per::kvs {
+
+constexpr size_t KVS_JSON_STREAM_BUFFER_SIZE = 4096U;
+
+/* Serializes data to out, returns the Adler-32 checksum of the written bytes */
+score::Result<uint32_t> stream_json_data(const KvsMap& data, std::ostream& out,
+                                         size_t buffer_size = KVS_JSON_STREAM_BUFFER_SIZE);
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_JSON_STREAM_HPP
@@ -0,0 +1,311 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <bitset>
+#include <functional>
+#include <thread>
+#include "kvs_rcu.hpp"
+
+namespace score::mw::per::kvs {
+
+/* Hash bits consumed per trie level (32 children) */
+constexpr size_t TRIE_BITS = 5U;
+constexpr size_t TRIE_MASK = (size_t(1) << TRIE_BITS) - 1U;
+constexpr size_t HASH_BITS = sizeof(size_t) * 8U;
+
+/* Inner node: bitmap of the occupied child slots and the children in slot order.
+   Leaf: entries with the same full hash (more than one only on hash collision) */
+struct KvsPersistentMap::Node {
+    size_t hash = 0;
+    uint32_t bitmap = 0;
+    std::vector<std::shared_ptr<const Node>> children;
+    std::vector<std::pair<std::string, KvsValue>> entries;
+
+    bool is_leaf() const { return children.empty(); }
+};
+
+using NodePtr = std::shared_ptr<const KvsPersistentMap::Node>;
+
+static size_t hash_key(std::string_view key)
+{
+    return std::hash<std::string_view>{}(key);
+}
+
+static size_t child_slot(size_t hash, size_t shift)
+{
+    return (hash >> shift) & TRIE_MASK;
+}
+
+/* Index of a slot in the children vector (number of occupied slots below it) */
+static size_t child_index(uint32_t bitmap, size_t slot)
+{
+    return std::bitset<32>(bitmap & ((uint32_t(1) << slot) - 1U)).count();
+}
+
+static NodePtr make_leaf(size_t hash, std::string_view key, const KvsValue& value)
+{
+    auto leaf = std::make_shared<KvsPersistentMap::Node>();
+    leaf->hash = hash;
+    leaf->entries.emplace_back(std::string(key), value);
+    return leaf;
+}
+
+static NodePtr node_set(const NodePtr& node, size_t hash, size_t shift, std::string_view key, const KvsValue& value, bool& added)
+{
+    NodePtr result;
+    if (!node) {
+        added = true;
+        result = make_leaf(hash, key, value);
+    }else if (node->is_leaf() && (node->hash == hash)) {
+        auto leaf = std::make_shared<KvsPersistentMap::Node>(*node);
+        bool replaced = false;
+        for (auto& entry : leaf->entries) {
+            if (entry.first == key) {
+                entry.second = value;
+                replaced = true;
+            }
+        }
+        if (!replaced) {
+            leaf->entries.emplace_back(std::string(key), value);
+            added = true;
+        }
+        result = leaf;
+    }else if (node->is_leaf()) {
+        /* Different hash: split into an inner node holding the existing leaf (distinct hashes differ
+           within HASH_BITS, so the split terminates before the shift exceeds the hash) */
+        auto inner = std::make_shared<KvsPersistentMap::Node>();
+        inner->bitmap = uint32_t(1) << child_slot(node->hash, shift);
+        inner->children.push_back(node);
+        result = node_set(inner, hash, shift, key, value, added);
+    }else{
+        auto inner = std::make_shared<KvsPersistentMap::Node>(*node); /* Copies the child pointers only */
+        const size_t slot = child_slot(hash, shift);
+        const size_t index = child_index(inner->bitmap, slot);
+        if (0U != (inner->bitmap & (uint32_t(1) << slot))) {
+            inner->children[index] = node_set(inner->children[index], hash, shift + TRIE_BITS, key, value, added);
+        }else{
+            inner->bitmap |= uint32_t(1) << slot;
+            inner->children.insert(inner->children.begin() + static_cast<std::ptrdiff_t>(index), make_leaf(hash, key, value));
+            added = true;
+        }
+        result = inner;
+    }
+
+    return result;
+}
+
+static NodePtr node_erase(const NodePtr& node, size_t hash, size_t shift, std::string_view key, bool& removed)
+{
+    NodePtr result = node; /* Unchanged */
+    if (!node) {
+        /* Key doesn't exist */
+    }else if (node->is_leaf()) {
+        if (node->hash == hash) {
+            for (size_t idx = 0; idx < node->entries.size(); ++idx) {
+                if (node->entries[idx].first == key) {
+                    removed = true;
+                    if (1U == node->entries.size()) {
+                        result = nullptr;
+                    }else{
+                        auto leaf = std::make_shared<KvsPersistentMap::Node>(*node);
+                        leaf->entries.erase(leaf->entries.begin() + static_cast<std::ptrdiff_t>(idx));
+                        result = leaf;
+                    }
+                    break;
+                }
+            }
+        }
+    }else{
+        const size_t slot = child_slot(hash, shift);
+        const size_t index = child_index(node->bitmap, slot);
+        if (0U != (node->bitmap & (uint32_t(1) << slot))) {
+            NodePtr child = node_erase(node->children[index], hash, shift + TRIE_BITS, key, removed);
+            if (removed) {
+                auto inner = std::make_shared<KvsPersistentMap::Node>(*node);
+                if (child) {
+                    inner->children[index] = child;
+                }else{
+                    inner->bitmap &= ~(uint32_t(1) << slot);
+                    inner->children.erase(inner->children.begin() + static_cast<std::ptrdiff_t>(index));
+                }
+                if (inner->children.empty()) {
+                    result = nullptr;
+                }else if ((1U == inner->children.size()) && inner->children.front()->is_leaf()) {
+                    result = inner->children.front(); /* Single leaf moves up, leaves compare the full hash */
+                }else{
+                    result = inner;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static void node_keys(const KvsPersistentMap::Node* node, std::vector<std::string>& keys)
+{
+    if (nullptr != node) {
+        for (const auto& entry : node->entries) {
+            keys.push_back(entry.first);
+        }
+        for (const auto& child : node->children) {
+            node_keys(child.get(), keys);
+        }
+    }
+}
+
+/*********************** Persistent Map *********************/
+KvsPersistentMap::KvsPersistentMap()
+    : count(0)
+{
+}
+
+KvsPersistentMap KvsPersistentMap::from(const KvsMap& data)
+{
+    KvsPersistentMap map;
+    for (const auto& [key, value] : data) {
+        bool added = false;
+        map.root = node_set(map.root, hash_key(key), 0U, key, value, added);
+        map.count += added ? 1U : 0U;
+    }
+    return map;
+}
+
+const KvsValue* KvsPersistentMap::find(std::string_view key) const
+{
+    return find(key, hash_key(key));
+}
+
+const KvsValue* KvsPersistentMap::find(std::string_view key, size_t hash) const
+{
+    const KvsValue* result = nullptr;
+    const Node* node = root.get();
+    size_t shift = 0;
+    while ((nullptr != node) && (nullptr == result)) {
+        if (node->is_leaf()) {
+            if (node->hash == hash) {
+                for (const auto& entry : node->entries) {
+                    if (entry.first == key) {
+                        result = &entry.second;
+                    }
+                }
+            }
+            node = nullptr;
+        }else{
+            const size_t slot = child_slot(hash, shift);
+            if (0U != (node->bitmap & (uint32_t(1) << slot))) {
+                node = node->children[child_index(node->bitmap, slot)].get();
+                shift += TRIE_BITS;
+            }else{
+                node = nullptr;
+            }
+        }
+    }
+
+    return result;
+}
+
+KvsPersistentMap KvsPersistentMap::set(std::string_view key, const KvsValue& value) const
+{
+    KvsPersistentMap map;
+    bool added = false;
+    map.root = node_set(root, hash_key(key), 0U, key, value, added);
+    map.count = count + (added ? 1U : 0U);
+    return map;
+}
+
+KvsPersistentMap KvsPersistentMap::erase(std::string_view key) const
+{
+    KvsPersistentMap map;
+    bool removed = false;
+    map.root = node_erase(root, hash_key(key), 0U, key, removed);
+    map.count = count - (removed ? 1U : 0U);
+    return map;
+}
+
+size_t KvsPersistentMap::size() const
+{
+    return count;
+}
+
+std::vector<std::string> KvsPersistentMap::keys() const
+{
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    node_keys(root.get(), keys);
+    return keys;
+}
+
+/*********************** RCU Map *********************/
+/* Reader shard of the calling thread */
+static size_t reader_shard()
+{
+    static thread_local const size_t shard = std::hash<std::thread::id>{}(std::this_thread::get_id()) % KVS_RCU_READER_SHARDS;
+    return shard;
+}
+
+KvsRcuMap::KvsRcuMap(KvsPersistentMap initial)
+    : version(new KvsPersistentMap(std::move(initial)))
+    , epoch(0)
+{
+}
+
+KvsRcuMap::~KvsRcuMap()
+{
+    delete version.load();
+}
+
+KvsRcuMap::ReadGuard::ReadGuard(const KvsRcuMap& map)
+    : readers(nullptr)
+    , version(nullptr)
+{
+    ReaderShard& shard = map.shards[reader_shard()];
+    /* Register in the current epoch. If a writer changed the epoch meanwhile, it may not wait
+       for this reader, so register again in the new epoch */
+    bool registered = false;
+    while (!registered) {
+        const uint64_t current_epoch = map.epoch.load();
+        readers = &shard.readers[current_epoch & 1U];
+        readers->fetch_add(1U);
+        registered = (map.epoch.load() == current_epoch);
+        if (!registered) {
+            readers->fetch_sub(1U);
+        }
+    }
+    version = map.version.load();
+}
+
+KvsRcuMap::ReadGuard::~ReadGuard()
+{
+    readers->fetch_sub(1U);
+}
+
+const KvsPersistentMap& KvsRcuMap::current() const
+{
+    return *version.load();
+}
+
+void KvsRcuMap::publish(KvsPersistentMap next)
+{
+    const KvsPersistentMap* previous = version.exchange(new KvsPersistentMap(std::move(next)));
+    /* Grace period: readers registered in the previous epoch may still use the previous version,
+       readers of the new epoch load the new version */
+    const uint64_t previous_epoch = epoch.fetch_add(1U);
+    for (auto& shard : shards) {
+        while (0U != shard.readers[previous_epoch & 1U].load()) {
+            std::this_thread::yield();
+        }
+    }
+    delete previous;
+}
+
+} /* namespace score::mw::per::kvs */
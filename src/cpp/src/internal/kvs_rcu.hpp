@@ -0,0 +1,109 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_RCU_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_RCU_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "kvsvalue.hpp"
+
+/*
+ * This header defines the data structures of the read-mostly mode (KvsBuilder::read_mostly_flag).
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * KvsPersistentMap is an immutable hash array mapped trie (32 children per node). A modification
+ * returns a new version, which shares all nodes with the previous version except the path to the
+ * changed key (path copying).
+ *
+ * KvsRcuMap publishes the current version through an atomic pointer (read-copy-update):
+ * readers take the current version without a lock, writers publish a new version and reclaim the
+ * previous one after all readers which may still use it are done (grace period). Readers are
+ * counted in per-thread shards on separate cache lines, so readers don't contend with each other.
+ */
+namespace score::mw::per::kvs {
+
+constexpr size_t KVS_RCU_READER_SHARDS = 16U;
+
+class KvsPersistentMap final {
+public:
+    struct Node;
+
+    KvsPersistentMap();
+
+    /* Build a version holding all entries of data */
+    static KvsPersistentMap from(const KvsMap& data);
+
+    /* Value of a key or nullptr, valid as long as this version exists */
+    const KvsValue* find(std::string_view key) const;
+    /* Same with the precomputed std::hash<std::string_view> of the key */
+    const KvsValue* find(std::string_view key, size_t hash) const;
+    /* New version with the key set to value */
+    KvsPersistentMap set(std::string_view key, const KvsValue& value) const;
+    /* New version without the key (shares all nodes, if the key doesn't exist) */
+    KvsPersistentMap erase(std::string_view key) const;
+
+    size_t size() const;
+    std::vector<std::string> keys() const;
+
+private:
+    std::shared_ptr<const Node> root;
+    size_t count;
+};
+
+class KvsRcuMap final {
+public:
+    explicit KvsRcuMap(KvsPersistentMap initial);
+    ~KvsRcuMap();
+    KvsRcuMap(const KvsRcuMap&) = delete;
+    KvsRcuMap& operator=(const KvsRcuMap&) = delete;
+
+    /* Lock-free reader access, the version stays valid until the guard is destroyed */
+    class ReadGuard final {
+    public:
+        explicit ReadGuard(const KvsRcuMap& map);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const KvsPersistentMap& operator*() const { return *version; }
+        const KvsPersistentMap* operator->() const { return version; }
+
+    private:
+        std::atomic<size_t>* readers;
+        const KvsPersistentMap* version;
+    };
+
+    /* Writer access, writers must be serialized by the caller */
+    const KvsPersistentMap& current() const;
+    /* Publish a new version, returns after the previous version is reclaimed */
+    void publish(KvsPersistentMap next);
+
+private:
+    struct alignas(64) ReaderShard {
+        std::array<std::atomic<size_t>, 2> readers{}; /* Active readers per epoch parity */
+    };
+
+    std::atomic<const KvsPersistentMap*> version;
+    std::atomic<uint64_t> epoch;
+    mutable std::array<ReaderShard, KVS_RCU_READER_SHARDS> shards;
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_RCU_HPP
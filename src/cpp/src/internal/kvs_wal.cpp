@@ -0,0 +1,101 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <array>
+#include "kvs_wal.hpp"
+#include "kvs_helper.hpp"
+
+namespace score::mw::per::kvs {
+
+/* Size of the record header (payload length) and trailer (checksum)*/
+constexpr size_t WAL_LENGTH_SIZE = 4U;
+constexpr size_t WAL_CHECKSUM_SIZE = 4U;
+/* Size of the fixed payload part (operation + key length)*/
+constexpr size_t WAL_PAYLOAD_HEADER_SIZE = 5U;
+
+/* Append uint32 in big endian byte order */
+static void append_u32(std::string& out, uint32_t value)
+{
+    std::array<uint8_t, 4> bytes = get_hash_bytes_adler32(value); /* Same byte order as the hash files*/
+    out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+/* Read uint32 in big endian byte order */
+static uint32_t read_u32(const std::string& data, size_t pos)
+{
+    return (uint32_t(uint8_t(data[pos])) << 24)
+         | (uint32_t(uint8_t(data[pos + 1])) << 16)
+         | (uint32_t(uint8_t(data[pos + 2])) <<  8)
+         |  uint32_t(uint8_t(data[pos + 3]));
+}
+
+/*********************** WAL Record Encoding *********************/
+std::string encode_wal_record(WalOperation operation, std::string_view key, std::string_view value)
+{
+    std::string payload;
+    payload.reserve(WAL_PAYLOAD_HEADER_SIZE + key.size() + value.size());
+    payload.push_back(static_cast<char>(operation));
+    append_u32(payload, static_cast<uint32_t>(key.size()));
+    payload.append(key.data(), key.size());
+    payload.append(value.data(), value.size());
+
+    std::string record;
+    record.reserve(WAL_LENGTH_SIZE + payload.size() + WAL_CHECKSUM_SIZE);
+    append_u32(record, static_cast<uint32_t>(payload.size()));
+    record.append(payload);
+    append_u32(record, calculate_hash_adler32(payload));
+
+    return record;
+}
+
+/*********************** WAL Record Decoding *********************/
+/* Decodes all complete and valid records. Decoding stops at the first incomplete or corrupted record
+   (e.g. torn write on power loss), valid_size returns the number of bytes covered by the decoded records */
+std::vector<WalRecord> decode_wal_records(const std::string& data, size_t& valid_size)
+{
+    std::vector<WalRecord> records;
+    size_t pos = 0;
+    bool done = false;
+
+    while (!done) {
+        done = true;
+        if ((data.size() - pos) >= WAL_LENGTH_SIZE) {
+            const size_t payload_size = read_u32(data, pos);
+            const size_t payload_pos = pos + WAL_LENGTH_SIZE;
+            if ((payload_size >= WAL_PAYLOAD_HEADER_SIZE)
+                && ((data.size() - payload_pos) >= WAL_CHECKSUM_SIZE)
+                && ((data.size() - payload_pos - WAL_CHECKSUM_SIZE) >= payload_size)) {
+                const std::string payload = data.substr(payload_pos, payload_size);
+                const uint32_t checksum = read_u32(data, payload_pos + payload_size);
+                const uint8_t operation = static_cast<uint8_t>(payload[0]);
+                const size_t key_size = read_u32(payload, 1U);
+                if ((calculate_hash_adler32(payload) == checksum)
+                    && (operation >= static_cast<uint8_t>(WalOperation::SetValue))
+                    && (operation <= static_cast<uint8_t>(WalOperation::Batch))
+                    && ((payload_size - WAL_PAYLOAD_HEADER_SIZE) >= key_size)) {
+                    WalRecord record;
+                    record.operation = static_cast<WalOperation>(operation);
+                    record.key = payload.substr(WAL_PAYLOAD_HEADER_SIZE, key_size);
+                    record.value = payload.substr(WAL_PAYLOAD_HEADER_SIZE + key_size);
+                    records.emplace_back(std::move(record));
+                    pos = payload_pos + payload_size + WAL_CHECKSUM_SIZE;
+                    done = false;
+                }
+            }
+        }
+    }
+    valid_size = pos;
+
+    return records;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,54 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_INTERNAL_KVS_WAL_HPP
+#define SCORE_LIB_KVS_INTERNAL_KVS_WAL_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * This header defines the record format of the KVS write-ahead log (WAL).
+ * It exists to allow unit tests to access these internal functions.
+ *
+ * Record layout (all integers big endian, like the hash files):
+ *   [payload length: 4 bytes][payload][Adler-32 of payload: 4 bytes]
+ * Payload layout:
+ *   [operation: 1 byte][key length: 4 bytes][key][value]
+ * The value of a Batch record holds SetValue and RemoveKey records in the same layout, so the checksum
+ * of the Batch record covers all changes of the batch.
+ */
+namespace score::mw::per::kvs {
+
+/* Operation stored in a WAL record */
+enum class WalOperation : std::uint8_t {
+    SetValue = 1,  /* value: serialized KvsValue*/
+    RemoveKey = 2, /* value: empty*/
+    Reset = 3,     /* key and value: empty*/
+    Restore = 4,   /* key: empty, value: serialized KVS data replacing the whole store*/
+    Batch = 5,     /* key: empty, value: encoded SetValue and RemoveKey records applied together*/
+};
+
+struct WalRecord {
+    WalOperation operation;
+    std::string key;
+    std::string value;
+};
+
+std::string encode_wal_record(WalOperation operation, std::string_view key, std::string_view value);
+std::vector<WalRecord> decode_wal_records(const std::string& data, size_t& valid_size);
+
+} /* namespace score::mw::per::kvs */
+
+#endif // SCORE_LIB_KVS_INTERNAL_KVS_WAL_HPP
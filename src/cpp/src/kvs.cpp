@@ -10,10 +10,24 @@
 *
 * SPDX-License-Identifier: Apache-2.0
 ********************************************************************************/
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <numeric>
 #include <sstream>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include "internal/kvs_binary.hpp"
+#include "internal/kvs_capture.hpp"
+#include "internal/kvs_defaults_image.hpp"
 #include "internal/kvs_helper.hpp"
+#include "internal/kvs_json_parser.hpp"
+#include "internal/kvs_json_stream.hpp"
+#include "internal/kvs_wal.hpp"
 #include "kvs.hpp"
 
 //TODO Default Value Handling TBD
@@ -27,50 +41,88 @@ namespace score::mw::per::kvs {
 
 /*********************** KVS Implementation *********************/
 Kvs::Kvs()
-    : filesystem(std::make_unique<score::filesystem::Filesystem>(score::filesystem::FilesystemFactory{}.CreateInstance())) /* Create Filesystem instance, noexcept call */
-    , parser(std::make_unique<score::json::JsonParser>())
+    : snapshot_generation(0)
+    , filesystem(std::make_unique<score::filesystem::Filesystem>(score::filesystem::FilesystemFactory{}.CreateInstance())) /* Create Filesystem instance, noexcept call */
     , writer(std::make_unique<score::json::JsonWriter>())
     , logger(std::make_unique<score::mw::log::Logger>("SKVS"))
+    , wal_size(0)
+    , generation(0)
+    , flushed_generation(0)
+    , worker_stop(false)
 {
 }
 
 Kvs::Kvs(Kvs&& other) noexcept
-    : filename_prefix(std::move(other.filename_prefix))
-    , filesystem(std::move(other.filesystem))
-    , parser(std::move(other.parser)) /* Not absolutely necessary, because a new JSON writer/parser object would also be okay*/
-    , writer(std::move(other.writer))
-    , logger(std::move(other.logger))
+    : worker_stop(false)
 {
+    other.worker_shutdown(); /* The worker uses the other object, pending changes are flushed first */
+    filename_prefix = std::move(other.filename_prefix);
+    filesystem = std::move(other.filesystem);
+    writer = std::move(other.writer); /* Not absolutely necessary, because a new JSON writer object would also be okay*/
+    logger = std::move(other.logger);
+    options = other.options;
     {
-        std::lock_guard<std::mutex> lock(other.kvs_mutex);
+        std::lock_guard<std::shared_timed_mutex> lock(other.kvs_mutex);
         kvs = std::move(other.kvs);
+        rcu_map = std::move(other.rcu_map);
+        shards = std::move(other.shards);
+        snapshot_files = std::move(other.snapshot_files);
+        snapshot_generation = other.snapshot_generation;
+        wal_stream = std::move(other.wal_stream);
+        wal_size = other.wal_size.load();
+        other.wal_size = 0;
+        generation = other.generation.load();
+        flushed_generation = other.flushed_generation.load();
+        flush_stats = other.flush_stats;
     }
 
     default_values = std::move(other.default_values);
+    default_image = std::move(other.default_image);
 
 }
 
+Kvs::~Kvs()
+{
+    worker_shutdown();
+}
+
 Kvs& Kvs::operator=(Kvs&& other) noexcept
 {
     if (this != &other) {
+        worker_shutdown();
+        other.worker_shutdown();
         {
-            std::lock_guard<std::mutex> lock_this(kvs_mutex);
+            std::lock_guard<std::shared_timed_mutex> lock_this(kvs_mutex);
             kvs.clear();
+            rcu_map.reset();
+            shards.clear();
         }
         default_values.clear();
+        default_image = KvsDefaultsImage();
         filename_prefix = std::move(other.filename_prefix);
 
         {
-            std::lock_guard<std::mutex> lock_other(other.kvs_mutex);
-            std::lock_guard<std::mutex> lock_this(kvs_mutex);
+            std::lock_guard<std::shared_timed_mutex> lock_other(other.kvs_mutex);
+            std::lock_guard<std::shared_timed_mutex> lock_this(kvs_mutex);
             kvs = std::move(other.kvs);
+            rcu_map = std::move(other.rcu_map);
+            shards = std::move(other.shards);
+            snapshot_files = std::move(other.snapshot_files);
+            snapshot_generation = other.snapshot_generation;
+            wal_stream = std::move(other.wal_stream);
+            wal_size = other.wal_size.load();
+            other.wal_size = 0;
+            generation = other.generation.load();
+            flushed_generation = other.flushed_generation.load();
+            flush_stats = other.flush_stats;
         }
         default_values = std::move(other.default_values);
+        default_image = std::move(other.default_image);
+        options = other.options;
 
         filesystem = std::move(other.filesystem);
-        /* Transfer ownership of JSON parser and writer
-            Not absolutely necessary, because a new JSON writer/parser object would also be okay*/
-        parser = std::move(other.parser);
+        /* Transfer ownership of JSON writer
+            Not absolutely necessary, because a new JSON writer object would also be okay*/
         writer = std::move(other.writer);
         logger = std::move(other.logger);
     }
@@ -78,52 +130,37 @@ Kvs& Kvs::operator=(Kvs&& other) noexcept
 }
 
 /* Helper Function to parse JSON data for open_json*/
-score::Result<std::unordered_map<std::string, KvsValue>> Kvs::parse_json_data(const std::string& data) {
+score::Result<KvsMap> Kvs::parse_json_data(const std::string& data, KvsResource* resource) {
 
-    score::Result<unordered_map<std::string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    auto any_res = parser->FromBuffer(data);
+    /* One-pass loader, builds the KvsValues directly from the buffer (no score::json::Any tree) */
+    return parse_kvs_json(data, resource);
+}
 
-    if (!any_res) {
-        result = score::MakeUnexpected(ErrorCode::JsonParserError);
-    }else{
-        score::json::Any root = std::move(any_res).value();
-        std::unordered_map<std::string, KvsValue> result_value;
+/* Helper Function to serialize KVS data for flush and the write-ahead log */
+score::Result<std::string> Kvs::serialize_json_data(const KvsMap& data) {
 
-        if (auto obj = root.As<score::json::Object>(); obj.has_value()) {
-            bool error = false;
-            for (const auto& element : obj.value().get()) {
-                auto sv = element.first.GetAsStringView();
-                std::string key(sv.data(), sv.size());
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::ostringstream out;
 
-                auto conv = any_to_kvsvalue(element.second);
-                if (!conv) {
-                    result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
-                    error = true;
-                    break;
-                }else{
-                    result_value.emplace(std::move(key), std::move(conv.value()));
-                }
-            }
-            if (!error) {
-                result = std::move(result_value);
-            }
-        } else {
-            result = score::MakeUnexpected(ErrorCode::JsonParserError);
-        }
+    auto stream_res = stream_json_data(data, out);
+    if (!stream_res) {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*stream_res.error()));
+    }else{
+        result = out.str();
     }
 
     return result;
 }
 
 /* Open and read JSON File */
-score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file)
+score::Result<KvsMap> Kvs::open_json(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file)
 {
     score::filesystem::Path json_file = prefix.Native() + ".json";
     score::filesystem::Path hash_file = prefix.Native() + ".hash";
     std::string data;
     bool error = false; /* Error flag */
     bool new_kvs = false; /* Flag to check if new KVS file is created*/
-    score::Result<std::unordered_map<string, KvsValue>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::Result<KvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
 
     /* Read JSON file */
     ifstream in(json_file.CStr());
@@ -135,7 +172,7 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
         }else{
             logger->LogInfo() << "file " << json_file << " not found, using empty data";
             new_kvs = true;
-            result = score::Result<std::unordered_map<string,KvsValue>>({});
+            result = score::Result<KvsMap>({});
         }
     }else{
         ostringstream ss;
@@ -165,7 +202,8 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
 
     /* Parse JSON Data */
     if((!error) && (!new_kvs)){
-        auto parse_res = parse_json_data(data);
+        KvsArena* arena = load_arena(data.size());
+        auto parse_res = parse_json_data(data, arena);
         if (!parse_res) {
             logger->LogError() << "error: parsing JSON data failed";
             error = true;
@@ -173,284 +211,559 @@ score::Result<std::unordered_map<string, KvsValue>> Kvs::open_json(const score::
         }else{
             result = std::move(parse_res.value());
         }
+        if (nullptr != arena) {
+            arena->release();
+        }
     }
 
     return result;
 }
 
 /* Open KVS Instance */
-score::Result<Kvs> Kvs::open(const InstanceId& instance_id, OpenNeedDefaults need_defaults, OpenNeedKvs need_kvs, const std::string&& dir)
+/* Open the default values. The defaults image is mapped, if it was generated from the current defaults JSON
+   (same hash) or if there is no defaults JSON. Otherwise the JSON is parsed and the image is (re-)generated */
+score::ResultBlank Kvs::open_defaults(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const score::filesystem::Path json_file = prefix.Native() + ".json";
+    const score::filesystem::Path hash_file = prefix.Native() + ".hash";
+    const score::filesystem::Path image_file = prefix.Native() + ".img";
+    const bool json_exists = ifstream(json_file.CStr()).good();
+    const bool image_exists = ifstream(image_file.CStr()).good();
+
+    bool image_current = false;
+    auto image_res = KvsDefaultsImage::map_file(image_file.Native());
+    if (image_res && json_exists) {
+        ifstream hin(hash_file.CStr(), ios::binary);
+        image_current = hin && (parse_hash_adler32(hin) == image_res.value().source_hash());
+    }else if (image_res) {
+        image_current = true; /* Image deployed without defaults JSON */
+    }
+
+    if (image_current) {
+        logger->LogInfo() << "using defaults image " << image_file;
+        default_image = std::move(image_res.value());
+        result = score::ResultBlank{};
+    }else if (image_exists && !json_exists) {
+        logger->LogError() << "error: defaults image " << image_file << " is invalid";
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*image_res.error()));
+    }else{
+        auto json_res = open_json(prefix, need_file);
+        if (!json_res) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*json_res.error()));
+        }else{
+            default_values = std::move(json_res.value());
+            result = score::ResultBlank{};
+            if (json_exists) {
+                /* Best effort (e.g. read-only directory): the parsed defaults are used, if the image can't be written */
+                ifstream hin(hash_file.CStr(), ios::binary);
+                auto write_res = write_defaults_image(parse_hash_adler32(hin), image_file);
+                if (!write_res) {
+                    logger->LogWarn() << "defaults image " << image_file << " could not be written";
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Generate the defaults image from the parsed default values and switch to the mapped image */
+score::ResultBlank Kvs::write_defaults_image(uint32_t source_hash, const score::filesystem::Path& image_path)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    /* Unique staging file, several processes may open the same defaults at the same time */
+    const score::filesystem::Path staged_path = image_path.Native() + ".tmp" + std::to_string(getpid());
+
+    auto image_data = serialize_defaults_image(default_values, source_hash);
+    if (!image_data) {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*image_data.error()));
+    }else{
+        result = write_binary_data(image_data.value(), staged_path);
+        if (result && (0 != std::rename(staged_path.CStr(), image_path.CStr()))) {
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        if (!result) {
+            (void)std::remove(staged_path.CStr());
+        }
+    }
+
+    if (result) {
+        auto image_res = KvsDefaultsImage::map_file(image_path.Native());
+        if (!image_res) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*image_res.error()));
+        }else{
+            default_image = std::move(image_res.value());
+            default_values.clear(); /* Served from the mapping */
+        }
+    }
+
+    return result;
+}
+
+score::Result<Kvs> Kvs::open(const InstanceId& instance_id, OpenNeedDefaults need_defaults, OpenNeedKvs need_kvs, const std::string&& dir, const KvsOptions& options)
 {
     score::Result<Kvs> result = score::MakeUnexpected(ErrorCode::UnmappedError); /* Redundant initialization needed, since Resul<KVS> would call the implicitly-deleted default constructor of KVS */
 
     score::filesystem::Path base_path(dir);
     score::filesystem::Path filename_prefix = base_path / ("kvs_" + std::to_string(instance_id.id));
     const score::filesystem::Path filename_default = filename_prefix.Native() + "_default";
-    const score::filesystem::Path filename_kvs = filename_prefix.Native() + "_0";
 
     Kvs kvs; /* Create KVS instance */
-    auto default_res = kvs.open_json(
-        filename_default,
-        need_defaults == OpenNeedDefaults::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
+    kvs.options = options;
+    kvs.filename_prefix = filename_prefix;
+    score::ResultBlank default_res{};
+    if (nullptr != options.compiled_defaults) {
+        kvs.logger->LogInfo() << "using compiled defaults";
+    }else{
+        default_res = kvs.open_defaults(
+            filename_default,
+            need_defaults == OpenNeedDefaults::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
+    }
     if (!default_res){
         result = score::MakeUnexpected(static_cast<ErrorCode>(*default_res.error())); /* Dereferences the Error class to its underlying code -> error.h*/
     }
     else{
-        auto kvs_res = kvs.open_json(
-            filename_kvs,
-            need_kvs == OpenNeedKvs::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
-        if (!kvs_res){
-            result = score::MakeUnexpected(static_cast<ErrorCode>(*kvs_res.error()));
+        auto scan_res = kvs.snapshot_scan();
+        if (!scan_res) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*scan_res.error()));
         }else{
-            kvs.kvs = std::move(kvs_res.value());
-            kvs.default_values = std::move(default_res.value());
-            kvs.filename_prefix = filename_prefix;
-            kvs.logger->LogInfo() << "opened KVS: instance '" << instance_id.id << "'";
-            kvs.logger->LogInfo() << "max snapshot count: " << KVS_MAX_SNAPSHOTS;
-            result = std::move(kvs);
+            /* The newest generation is the current KVS file */
+            const score::filesystem::Path filename_kvs = kvs.snapshot_files.empty()
+                ? score::filesystem::Path(filename_prefix.Native() + "_0")
+                : kvs.snapshot_files.front().prefix;
+            auto kvs_res = kvs.open_kvs_file(
+                filename_kvs,
+                need_kvs == OpenNeedKvs::Required ? OpenJsonNeedFile::Required : OpenJsonNeedFile::Optional);
+            if (!kvs_res){
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*kvs_res.error()));
+            }else{
+                /* Replay the write-ahead log (also if it is disabled now, to not lose changes of a previous run) */
+                auto wal_res = kvs.wal_replay(kvs_res.value());
+                if (!wal_res) {
+                    result = score::MakeUnexpected(static_cast<ErrorCode>(*wal_res.error()));
+                }else{
+                    /* The KVS is dirty, if there is no KVS file yet or it doesn't contain the replayed WAL records */
+                    if (kvs.snapshot_files.empty() || (0U != kvs.wal_size)) {
+                        kvs.generation = 1U;
+                    }
+                    for (size_t idx = 0; (1U < options.shard_count) && (idx < options.shard_count); ++idx) {
+                        kvs.shards.push_back(std::make_unique<KvsShard>());
+                    }
+                    if (options.read_mostly) {
+                        kvs.rcu_map = std::make_unique<KvsRcuMap>(KvsPersistentMap::from(kvs_res.value()));
+                    }
+                    kvs.data_assign(std::move(kvs_res.value()));
+                    kvs.logger->LogInfo() << "opened KVS: instance '" << instance_id.id << "'";
+                    kvs.logger->LogInfo() << "max snapshot count: " << options.snapshot_max_count;
+                    result = std::move(kvs);
+                }
+            }
         }
     }
 
     return result;
 }
 
-/* Reset KVS to initial state*/
-score::ResultBlank Kvs::reset() {
-    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        kvs.clear();
-        result = score::ResultBlank{};
+/* Acquire a lock according to the lock policy, the caller checks owns_lock() */
+template <typename Lock>
+static Lock acquire_lock(typename Lock::mutex_type& mutex, KvsLockPolicy policy, std::chrono::milliseconds timeout)
+{
+    Lock lock(mutex, std::defer_lock);
+    if (KvsLockPolicy::Blocking == policy) {
+        lock.lock();
+    }else if (KvsLockPolicy::Timed == policy) {
+        (void)lock.try_lock_for(timeout);
     }else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        (void)lock.try_lock();
     }
 
-    return result;
+    return lock;
 }
 
-/* Retrieve all keys in the KVS*/
-score::Result<std::vector<std::string>> Kvs::get_all_keys() {
-    score::Result<std::vector<std::string>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        std::vector<std::string> keys;
-        keys.reserve(kvs.size());
-        for (const auto& [key, _] : kvs) {
-            keys.emplace_back(key);
+/* Shared access to the KVS data (readers) */
+std::shared_lock<std::shared_timed_mutex> Kvs::lock_shared(KvsLockPolicy policy) {
+    return acquire_lock<std::shared_lock<std::shared_timed_mutex>>(kvs_mutex, policy, options.lock_timeout);
+}
+
+/* Exclusive access to the KVS data (writers) */
+std::unique_lock<std::shared_timed_mutex> Kvs::lock_exclusive() {
+    return acquire_lock<std::unique_lock<std::shared_timed_mutex>>(kvs_mutex, options.lock_policy, options.lock_timeout);
+}
+
+/* Locked map holding a key, the caller checks data. In the sharded mode the KVS lock is shared, so
+   functions on other shards run in parallel, and functions on the complete data are excluded */
+template <typename Lock>
+Kvs::KeyAccess<Lock> Kvs::lock_key(const KvsKey& key) {
+    KeyAccess<Lock> access;
+    if (shards.empty()) {
+        access.lock = acquire_lock<Lock>(kvs_mutex, options.lock_policy, options.lock_timeout);
+        if (access.lock.owns_lock()) {
+            access.data = &kvs;
+            access.capture = &kvs_capture;
         }
-        result = std::move(keys);
     }else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        access.kvs_lock = lock_shared(options.lock_policy);
+        if (access.kvs_lock.owns_lock()) {
+            KvsShard& shard = *shards[shard_index(key)];
+            access.lock = acquire_lock<Lock>(shard.mutex, options.lock_policy, options.lock_timeout);
+            if (access.lock.owns_lock()) {
+                access.data = &shard.data;
+                access.capture = &shard.capture;
+            }
+        }
     }
 
-    return result;
+    return access;
 }
 
-/* Check if a key exists*/
-score::Result<bool> Kvs::key_exists(const std::string_view key) {
-    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        auto search = kvs.find(std::string(key)); /* unordered_map find() needs string and doesnt work with string_view, workaround for c++20: heterogeneous lookup (applies to more functions) */
-        if (search != kvs.end()) {
-            result = true;
-        } else {
-            result = false;
+/* Sharded mode: shared access to all shards (in index order), the caller holds kvs_mutex shared and
+   compares the number of returned locks with the shard count */
+std::vector<std::shared_lock<std::shared_timed_mutex>> Kvs::lock_shards(KvsLockPolicy policy) {
+    std::vector<std::shared_lock<std::shared_timed_mutex>> locks;
+    locks.reserve(shards.size());
+    for (auto& shard : shards) {
+        auto lock = acquire_lock<std::shared_lock<std::shared_timed_mutex>>(shard->mutex, policy, options.lock_timeout);
+        if (!lock.owns_lock()) {
+            break;
         }
+        locks.push_back(std::move(lock));
+    }
+
+    return locks;
+}
+
+size_t Kvs::shard_index(const std::string_view key) const {
+    return std::hash<std::string_view>{}(key) % shards.size();
+}
+
+size_t Kvs::shard_index(const KvsKey& key) const {
+    return key.hash() % shards.size();
+}
+
+/* Functions on the complete KVS data, the caller holds kvs_mutex exclusively (or shared and all shard locks) */
+bool Kvs::data_empty() const {
+    bool empty = kvs_capture.empty(kvs);
+    for (const auto& shard : shards) {
+        empty = empty && shard->capture.empty(shard->data);
+    }
+    return empty;
+}
+
+void Kvs::data_assign(KvsMap&& data) {
+    if (shards.empty()) {
+        kvs_capture.assign(kvs, std::move(data));
     }else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        std::vector<KvsMap> parts(shards.size());
+        for (auto& [key, value] : data) {
+            parts[shard_index(key)].emplace(key, std::move(value));
+        }
+        for (size_t idx = 0; idx < shards.size(); ++idx) {
+            shards[idx]->capture.assign(shards[idx]->data, std::move(parts[idx]));
+        }
     }
+}
 
+const KvsValue* Kvs::data_find(const KvsKey& key) const {
+    const KvsValue* result = nullptr;
+    if (shards.empty()) {
+        result = kvs_capture.find(kvs, key.name());
+    }else{
+        const KvsShard& shard = *shards[shard_index(key)];
+        result = shard.capture.find(shard.data, key.name());
+    }
     return result;
 }
 
-/* Retrieve the value associated with a key*/
-score::Result<KvsValue> Kvs::get_value(const std::string_view key) {
-    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock_kvs(kvs_mutex, std::try_to_lock);
-    if (lock_kvs.owns_lock()){
-        auto search_kvs = kvs.find(std::string(key));
-        if (search_kvs != kvs.end()) {
-            result = search_kvs->second;
-        } else {
-            auto search_default = default_values.find(std::string(key));
-            if (search_default != default_values.end()) {
-                result = search_default->second;
-            } else {
-                result = score::MakeUnexpected(ErrorCode::KeyNotFound);
-            }
-        }
+/* Copy of the KVS data (sharded mode: merged from all shards) */
+KvsMap Kvs::data_copy() const {
+    KvsMap data = kvs_capture.copy(kvs);
+    for (const auto& shard : shards) {
+        auto shard_data = shard->capture.copy(shard->data);
+        data.insert(std::make_move_iterator(shard_data.begin()), std::make_move_iterator(shard_data.end()));
     }
-    else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    return data;
+}
+
+/* Capture the KVS data for flush (kvs_mutex must be held exclusively) */
+void Kvs::capture_begin() {
+    kvs_capture.begin(kvs);
+    for (auto& shard : shards) {
+        shard->capture.begin(shard->data);
     }
+}
 
-    return result;
+/* Fold the changes made during the capture into the KVS data (waits for kvs_mutex, the capture must always end) */
+void Kvs::capture_end() {
+    std::lock_guard<std::shared_timed_mutex> lock(kvs_mutex);
+    kvs_capture.end(kvs);
+    for (auto& shard : shards) {
+        shard->capture.end(shard->data);
+    }
 }
 
-/*Retrieve the default value associated with a key*/
-score::Result<KvsValue> Kvs::get_default_value(const std::string_view key) {
-    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+/* Read-mostly mode: publish a version with the key set to value (nullptr: key removed), the key's map must be locked exclusively */
+void Kvs::rcu_update(const std::string_view key, const KvsValue* value) {
+    if (rcu_map) {
+        std::lock_guard<std::mutex> lock(rcu_mutex);
+        if (nullptr != value) {
+            rcu_map->publish(rcu_map->current().set(key, *value));
+        }else{
+            rcu_map->publish(rcu_map->current().erase(key));
+        }
+    }
+}
 
-    auto search = default_values.find(std::string(key));
-    if (search != default_values.end()) {
-        result = search->second;
-    } else {
-        result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+/* Read-mostly mode: publish one version with all keys changed (nullptr: key removed), kvs_mutex must be held exclusively */
+void Kvs::rcu_update(const std::vector<std::pair<std::string_view, const KvsValue*>>& changes) {
+    if (rcu_map) {
+        std::lock_guard<std::mutex> lock(rcu_mutex);
+        KvsPersistentMap next = rcu_map->current();
+        for (const auto& [key, value] : changes) {
+            if (nullptr != value) {
+                next = next.set(key, *value);
+            }else{
+                next = next.erase(key);
+            }
+        }
+        rcu_map->publish(std::move(next));
     }
+}
 
-    return result;
+/* Read-mostly mode: publish a version of the complete KVS data, kvs_mutex must be held exclusively */
+void Kvs::rcu_reload() {
+    if (rcu_map) {
+        std::lock_guard<std::mutex> lock(rcu_mutex);
+        if (shards.empty() && !kvs_capture.active()) {
+            rcu_map->publish(KvsPersistentMap::from(kvs));
+        }else{
+            rcu_map->publish(KvsPersistentMap::from(data_copy()));
+        }
+    }
 }
 
-/* Resets a Key to its default value (Deletes written key if default is available) */
-score::ResultBlank Kvs::reset_key(const std::string_view key)
-{
+/* Reset KVS to initial state*/
+score::ResultBlank Kvs::reset() {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock_kvs(kvs_mutex, std::try_to_lock);
-    if (!lock_kvs.owns_lock()) {
+    std::unique_lock<std::shared_timed_mutex> lock = lock_exclusive();
+    if (lock.owns_lock()) {
+        const bool empty = data_empty();
+        if (empty) {
+            result = score::ResultBlank{}; /* Nothing to reset, KVS stays unmodified */
+        }else if (options.wal_enabled) {
+            result = wal_write(encode_wal_record(WalOperation::Reset, "", ""));
+        }else{
+            result = score::ResultBlank{};
+        }
+        if (result && !empty) {
+            data_assign({});
+            rcu_reload();
+            ++generation;
+            flush_schedule(false);
+        }
+    }else{
         result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
     }
-    else {
-        auto search_default = default_values.find(std::string(key));
-        if (search_default == default_values.end()) {
-            result = score::MakeUnexpected(ErrorCode::KeyDefaultNotFound);
+
+    return result;
+}
+
+/* Retrieve all keys in the KVS*/
+score::Result<std::vector<std::string>> Kvs::get_all_keys() {
+    score::Result<std::vector<std::string>> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if (rcu_map) {
+        KvsRcuMap::ReadGuard version(*rcu_map); /* Read-mostly mode: no lock */
+        result = version->keys();
+    }else{
+        std::shared_lock<std::shared_timed_mutex> lock = lock_shared(options.lock_policy);
+        std::vector<std::shared_lock<std::shared_timed_mutex>> shard_locks;
+        if (lock.owns_lock()) {
+            shard_locks = lock_shards(options.lock_policy);
         }
-        else {
-            auto search_kvs = kvs.find(std::string(key));
-            if (search_kvs != kvs.end()) {
-                (void)kvs.erase(std::string(key)); /* Return Value ignored, since its already secured, that the key exists*/
-                result = score::ResultBlank{};
-            }else{
-                result = score::ResultBlank{};
+        if (lock.owns_lock() && (shard_locks.size() == shards.size())) {
+            std::vector<std::string> keys = kvs_capture.keys(kvs);
+            for (const auto& shard : shards) {
+                std::vector<std::string> shard_keys = shard->capture.keys(shard->data);
+                keys.insert(keys.end(), std::make_move_iterator(shard_keys.begin()), std::make_move_iterator(shard_keys.end()));
             }
+            result = std::move(keys);
+        }else{
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
         }
     }
 
     return result;
 }
 
-/* Check if a key has a default value*/
-score::Result<bool> Kvs::has_default_value(const std::string_view key) {
-    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+/* Check if a key exists*/
+score::Result<bool> Kvs::key_exists(const std::string_view key) {
+    return key_exists(KvsKey(key));
+}
 
-    auto search = default_values.find(std::string(key)); /* unordered_map find() needs string and doesnt work with string_view, workaround for c++20: heterogeneous lookup (applies to more functions) */
-    if (search != default_values.end()) {
-        result = true;
-    } else {
-        result = false;
+score::Result<bool> Kvs::key_exists(const KvsKey& key) {
+    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if (rcu_map) {
+        KvsRcuMap::ReadGuard version(*rcu_map); /* Read-mostly mode: no lock */
+        result = (nullptr != version->find(key.name(), key.hash()));
+    }else{
+        auto access = lock_key<std::shared_lock<std::shared_timed_mutex>>(key);
+        if (nullptr != access.data) {
+            if (nullptr != access.capture->find(*access.data, key.name())) {
+                result = true;
+            } else {
+                result = false;
+            }
+        }else{
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
     }
 
     return result;
 }
 
-/* Set the value for a key*/
-score::ResultBlank Kvs::set_value(const std::string_view key, const KvsValue& value) {
-    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        kvs.insert_or_assign(std::string(key), value);
-        result = score::ResultBlank{};
+/* Retrieve the value associated with a key*/
+score::Result<KvsValue> Kvs::get_value(const std::string_view key) {
+    return get_value(KvsKey(key));
+}
+
+score::Result<KvsValue> Kvs::get_value(const KvsKey& key) {
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    if (rcu_map) {
+        KvsRcuMap::ReadGuard version(*rcu_map); /* Read-mostly mode: no lock */
+        const KvsValue* value = version->find(key.name(), key.hash());
+        if (nullptr != value) {
+            result = *value;
+        } else {
+            result = get_default_value(key);
+        }
     }else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        auto access = lock_key<std::shared_lock<std::shared_timed_mutex>>(key);
+        if (nullptr != access.data){
+            const KvsValue* value = access.capture->find(*access.data, key.name());
+            if (nullptr != value) {
+                result = *value;
+            } else {
+                result = get_default_value(key);
+            }
+        }
+        else{
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
     }
 
     return result;
 }
 
-/* Remove a key-value pair*/
-score::ResultBlank Kvs::remove_key(const std::string_view key) {
+/* Pass the value of a key to a visitor without a copy */
+score::ResultBlank Kvs::visit_value(const std::string_view key, const std::function<void(const KvsValue&)>& visitor) {
+    return visit_value(KvsKey(key), visitor);
+}
+
+score::ResultBlank Kvs::visit_value(const KvsKey& key, const std::function<void(const KvsValue&)>& visitor) {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        const auto erased = kvs.erase(std::string(key));
-        if (erased > 0U) {
+    if (rcu_map) {
+        KvsRcuMap::ReadGuard version(*rcu_map); /* Read-mostly mode: the version stays valid while it is visited */
+        const KvsValue* value = version->find(key.name(), key.hash());
+        if (nullptr != value) {
+            visitor(*value);
             result = score::ResultBlank{};
         } else {
-            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+            result = visit_default_value(key, visitor);
         }
     }else{
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        auto access = lock_key<std::shared_lock<std::shared_timed_mutex>>(key);
+        if (nullptr != access.data) {
+            const KvsValue* value = access.capture->find(*access.data, key.name());
+            if (nullptr != value) {
+                visitor(*value);
+                result = score::ResultBlank{};
+            } else {
+                result = visit_default_value(key, visitor);
+            }
+        }else{
+            result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
     }
 
     return result;
 }
 
-/* Helper Function to write JSON data to a file for flush process (also adds Hash file)*/
-score::ResultBlank Kvs::write_json_data(const std::string& buf)
-{
+/* Default values of the defaults file are visited in place, compiled defaults and the defaults image are decoded first */
+score::ResultBlank Kvs::visit_default_value(const KvsKey& key, const std::function<void(const KvsValue&)>& visitor) {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    score::filesystem::Path json_path{filename_prefix.Native() + "_0.json"};
-    score::filesystem::Path dir = json_path.ParentPath();
-    if  (!dir.Empty()) {
-        const auto create_path_res = filesystem->standard->CreateDirectories(dir);
-        if(!create_path_res.has_value()) {
-            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-        } else {
-            std::ofstream out(json_path.CStr(), std::ios::binary);
-            if (!out.write(buf.data(), buf.size())) {
-                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-            } else {
-                /* Write Hash File */
-                std::array<uint8_t, 4> hash_bytes = get_hash_bytes(buf);
-                score::filesystem::Path fn_hash = filename_prefix.Native() + "_0.hash";
-                std::ofstream hout(fn_hash.CStr(), std::ios::binary);
-                if (!hout.write(reinterpret_cast<const char*>(hash_bytes.data()), hash_bytes.size())) {
-                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-                } else {
-                    result = score::ResultBlank{};
-                }
-            }
+
+    if ((nullptr == options.compiled_defaults) && !default_image.is_mapped()) {
+        auto search = default_values.find(key.name());
+        if (search != default_values.end()) {
+            visitor(search->second);
+            result = score::ResultBlank{};
+        }else{
+            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        }
+    }else{
+        auto default_res = get_default_value(key);
+        if (default_res) {
+            visitor(default_res.value());
+            result = score::ResultBlank{};
+        }else{
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*default_res.error()));
         }
-    } else {
-        logger->LogError() << "Failed to create directory for KVS file '" << json_path << "'";
-        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
     }
 
     return result;
 }
 
-/* Flush the key-value store*/
-score::ResultBlank Kvs::flush() {
+/* Retrieve the values of several keys with one lock (read-mostly mode: from one version) */
+score::ResultBlank Kvs::get_values(const std::vector<std::string_view>& keys, std::vector<std::optional<KvsValue>>& values) {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    /* Create JSON Object */
-    score::json::Object root_obj;
-    bool error = false;
-    {
-        std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    values.resize(keys.size()); /* Existing elements are assigned, so their storage is reused */
+
+    if (rcu_map) {
+        KvsRcuMap::ReadGuard version(*rcu_map); /* Read-mostly mode: no lock */
+        KvsKey key; /* Reused for all keys, only allocates for a key longer than the ones before */
+        for (size_t idx = 0; idx < keys.size(); ++idx) {
+            key.assign(keys[idx]);
+            const KvsValue* value = version->find(key.name(), key.hash());
+            if (nullptr != value) {
+                values[idx] = *value;
+            }else{
+                values[idx].reset();
+            }
+        }
+        result = score::ResultBlank{};
+    }else{
+        std::shared_lock<std::shared_timed_mutex> lock = lock_shared(options.lock_policy);
+        std::vector<std::shared_lock<std::shared_timed_mutex>> shard_locks;
         if (lock.owns_lock()) {
-            for (auto const& [key, value] : kvs) {
-                auto conv = kvsvalue_to_any(value);
-                if (!conv) {
-                    result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
-                    error = true;
-                    break;
+            shard_locks = lock_shards(options.lock_policy);
+        }
+        if (lock.owns_lock() && (shard_locks.size() == shards.size())) {
+            KvsKey key;
+            for (size_t idx = 0; idx < keys.size(); ++idx) {
+                key.assign(keys[idx]);
+                const KvsValue* value = data_find(key);
+                if (nullptr != value) {
+                    values[idx] = *value;
                 }else{
-                    root_obj.emplace(
-                        key,
-                        std::move(conv.value()) /*emplace in map uses move operator*/
-                    );
+                    values[idx].reset();
                 }
             }
-        } else {
+            result = score::ResultBlank{};
+        }else{
             result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
-            error = true;
         }
     }
 
-    if(!error){
-        /* Serialize Buffer */
-        auto buf_res = writer->ToBuffer(root_obj);
-        if (!buf_res) {
-            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
-        }else{
-            /* Rotate Snapshots */
-            auto rotate_result = snapshot_rotate();
-            if (!rotate_result) {
-                result = rotate_result;
-            }else{
-                /* Write JSON Data */
-                std::string buf = std::move(buf_res.value());
-                result = write_json_data(buf);
+    /* Keys without a written value: default value (the defaults are not changed, no lock needed) */
+    if (result) {
+        KvsKey key;
+        for (size_t idx = 0; idx < keys.size(); ++idx) {
+            if (!values[idx]) {
+                key.assign(keys[idx]);
+                auto default_res = get_default_value(key);
+                if (default_res) {
+                    values[idx] = std::move(default_res.value());
+                }
             }
         }
     }
@@ -458,14 +771,698 @@ score::ResultBlank Kvs::flush() {
     return result;
 }
 
-/* Retrieve the snapshot count*/
-score::Result<size_t> Kvs::snapshot_count() const {
-    score::Result<size_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    size_t count = 0;
-    bool error = false;
-    for (size_t idx = 1; idx <= KVS_MAX_SNAPSHOTS; ++idx) {
-        const score::filesystem::Path fname = filename_prefix.Native() + "_" + to_string(idx) + ".json";
-        const auto fname_exists_res = filesystem->standard->Exists(fname);
+/*Retrieve the default value associated with a key*/
+score::Result<KvsValue> Kvs::get_default_value(const std::string_view key) {
+    return get_default_value(KvsKey(key));
+}
+
+score::Result<KvsValue> Kvs::get_default_value(const KvsKey& key) {
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if (nullptr != options.compiled_defaults) {
+        const KvsCompiledValue* value = options.compiled_defaults->find(key.name());
+        if (nullptr != value) {
+            result = value->to_kvsvalue();
+        }else{
+            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        }
+    }else if (default_image.is_mapped()) {
+        result = default_image.get(key.name()); /* Decoded directly from the mapped image */
+    }else{
+        auto search = default_values.find(key.name());
+        if (search != default_values.end()) {
+            result = search->second;
+        } else {
+            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        }
+    }
+
+    return result;
+}
+
+/* Resets a Key to its default value (Deletes written key if default is available) */
+score::ResultBlank Kvs::reset_key(const std::string_view key)
+{
+    return reset_key(KvsKey(key));
+}
+
+score::ResultBlank Kvs::reset_key(const KvsKey& key)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto access = lock_key<std::unique_lock<std::shared_timed_mutex>>(key);
+    if (nullptr == access.data) {
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+    else {
+        auto has_default = has_default_value(key);
+        if (!has_default.value()) {
+            result = score::MakeUnexpected(ErrorCode::KeyDefaultNotFound);
+        }
+        else {
+            if (nullptr != access.capture->find(*access.data, key.name())) {
+                if (options.wal_enabled) {
+                    result = wal_write(encode_wal_record(WalOperation::RemoveKey, key.name(), ""));
+                }else{
+                    result = score::ResultBlank{};
+                }
+                if (result) {
+                    (void)access.capture->erase(*access.data, key.name());
+                    rcu_update(key.name(), nullptr);
+                    ++generation;
+                    flush_schedule(false);
+                }
+            }else{
+                result = score::ResultBlank{};
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Check if a key has a default value*/
+score::Result<bool> Kvs::has_default_value(const std::string_view key) {
+    return has_default_value(KvsKey(key));
+}
+
+score::Result<bool> Kvs::has_default_value(const KvsKey& key) {
+    score::Result<bool> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if (nullptr != options.compiled_defaults) {
+        result = (nullptr != options.compiled_defaults->find(key.name()));
+    }else if (default_image.is_mapped()) {
+        result = default_image.contains(key.name());
+    }else{
+        auto search = default_values.find(key.name());
+        if (search != default_values.end()) {
+            result = true;
+        } else {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+/* Set the value for a key*/
+score::ResultBlank Kvs::set_value(const std::string_view key, const KvsValue& value) {
+    return set_value(KvsKey(key), value);
+}
+
+score::ResultBlank Kvs::set_value(const std::string_view key, KvsValue&& value) {
+    return set_value(KvsKey(key), std::move(value));
+}
+
+score::ResultBlank Kvs::set_value(const KvsKey& key, const KvsValue& value) {
+    return set_value_impl(key, value);
+}
+
+score::ResultBlank Kvs::set_value(const KvsKey& key, KvsValue&& value) {
+    return set_value_impl(key, std::move(value));
+}
+
+score::ResultBlank Kvs::set_value(KvsKey&& key, const KvsValue& value) {
+    return set_value_impl(std::move(key), value);
+}
+
+score::ResultBlank Kvs::set_value(KvsKey&& key, KvsValue&& value) {
+    return set_value_impl(std::move(key), std::move(value));
+}
+
+/* Key is const KvsKey& (name copied on insert) or KvsKey (name moved on insert),
+   Value is const KvsValue& (copied into the KVS) or KvsValue (moved) */
+template <typename Key, typename Value>
+score::ResultBlank Kvs::set_value_impl(Key&& key, Value&& value) {
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto access = lock_key<std::unique_lock<std::shared_timed_mutex>>(key);
+    if (nullptr != access.data) {
+        const KvsValue* current = access.capture->find(*access.data, key.name());
+        if ((nullptr != current) && (*current == value)) {
+            result = score::ResultBlank{}; /* Value unchanged, KVS stays unmodified */
+        }else if (options.wal_enabled) {
+            auto record_res = wal_encode(WalOperation::SetValue, key.name(), &value);
+            if (!record_res) {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*record_res.error()));
+            }else{
+                result = wal_write(record_res.value());
+            }
+        }else{
+            result = score::ResultBlank{};
+        }
+        if (result && ((nullptr == current) || (*current != value))) {
+            rcu_update(key.name(), &value); /* Copies the value before it is moved */
+            if constexpr (std::is_rvalue_reference_v<Key&&>) {
+                access.capture->set(*access.data, std::move(key.key), KvsValue(std::forward<Value>(value)));
+            }else{
+                access.capture->set(*access.data, key.name(), std::forward<Value>(value));
+            }
+            ++generation;
+            flush_schedule(false);
+        }
+    }else{
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Remove a key-value pair*/
+score::ResultBlank Kvs::remove_key(const std::string_view key) {
+    return remove_key(KvsKey(key));
+}
+
+score::ResultBlank Kvs::remove_key(const KvsKey& key) {
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto access = lock_key<std::unique_lock<std::shared_timed_mutex>>(key);
+    if (nullptr != access.data) {
+        if (nullptr != access.capture->find(*access.data, key.name())) {
+            if (options.wal_enabled) {
+                result = wal_write(encode_wal_record(WalOperation::RemoveKey, key.name(), ""));
+            }else{
+                result = score::ResultBlank{};
+            }
+            if (result) {
+                (void)access.capture->erase(*access.data, key.name());
+                rcu_update(key.name(), nullptr);
+                ++generation;
+                flush_schedule(false);
+            }
+        } else {
+            result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+        }
+    }else{
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Prepared key */
+KvsKey::KvsKey(const std::string_view name)
+    : key(name)
+    , key_hash(std::hash<std::string_view>{}(name))
+{
+}
+
+KvsKey::KvsKey(std::string&& name)
+    : key(std::move(name))
+    , key_hash(std::hash<std::string_view>{}(key))
+{
+}
+
+KvsKey::KvsKey(const char* name)
+    : KvsKey(std::string_view(name))
+{
+}
+
+KvsKey::KvsKey()
+    : key_hash(std::hash<std::string_view>{}(std::string_view()))
+{
+}
+
+void KvsKey::assign(const std::string_view name) {
+    key.assign(name.data(), name.size()); /* Keeps the capacity */
+    key_hash = std::hash<std::string_view>{}(name);
+}
+
+const std::string& KvsKey::name() const {
+    return key;
+}
+
+size_t KvsKey::hash() const {
+    return key_hash;
+}
+
+/* Write batch: staged changes for Kvs::commit() */
+KvsWriteBatch& KvsWriteBatch::set_value(const std::string_view key, const KvsValue& value) {
+    changes.push_back(Change{std::string(key), value});
+    return *this;
+}
+
+KvsWriteBatch& KvsWriteBatch::set_value(const std::string_view key, KvsValue&& value) {
+    changes.push_back(Change{std::string(key), std::move(value)});
+    return *this;
+}
+
+KvsWriteBatch& KvsWriteBatch::remove_key(const std::string_view key) {
+    changes.push_back(Change{std::string(key), std::nullopt});
+    return *this;
+}
+
+size_t KvsWriteBatch::size() const {
+    return changes.size();
+}
+
+void KvsWriteBatch::clear() {
+    changes.clear();
+}
+
+/* Apply the changes of a write batch atomically */
+score::ResultBlank Kvs::commit(const KvsWriteBatch& batch) {
+    std::vector<std::pair<std::string_view, const KvsValue*>> staged;
+    staged.reserve(batch.changes.size());
+    for (const auto& change : batch.changes) {
+        staged.emplace_back(change.key, change.value ? &change.value.value() : nullptr);
+    }
+
+    return commit_changes(staged);
+}
+
+/* Set the values of several keys atomically */
+score::ResultBlank Kvs::set_values(const std::vector<std::pair<std::string_view, KvsValue>>& entries) {
+    std::vector<std::pair<std::string_view, const KvsValue*>> staged;
+    staged.reserve(entries.size());
+    for (const auto& [key, value] : entries) {
+        staged.emplace_back(key, &value);
+    }
+
+    return commit_changes(staged);
+}
+
+/* Apply staged changes (nullptr: remove the key) in order with one exclusive lock, either all or none */
+score::ResultBlank Kvs::commit_changes(const std::vector<std::pair<std::string_view, const KvsValue*>>& staged) {
+    score::ResultBlank result = score::ResultBlank{};
+    /* Exclusive KVS lock: excludes the writers of all shards, readers and the capture of flush */
+    std::unique_lock<std::shared_timed_mutex> lock = lock_exclusive();
+    if (lock.owns_lock()) {
+        /* Group the changes by key (stable: changes of a key stay in order) without allocating per key */
+        std::vector<size_t> order(staged.size());
+        std::iota(order.begin(), order.end(), 0U);
+        std::stable_sort(order.begin(), order.end(), [&staged](size_t lhs, size_t rhs) {
+            return staged[lhs].first < staged[rhs].first;
+        });
+
+        /* Resolve the final value of each key (nullptr: removed), validate the removes and
+           keep the keys whose final value differs from the stored value */
+        std::vector<std::pair<std::string_view, const KvsValue*>> changes;
+        changes.reserve(staged.size());
+        KvsKey lookup;
+        for (size_t idx = 0; result && (idx < order.size());) {
+            const std::string_view key = staged[order[idx]].first;
+            lookup.assign(key);
+            const KvsValue* current = data_find(lookup);
+            const KvsValue* value = current;
+            for (; (idx < order.size()) && (staged[order[idx]].first == key); ++idx) {
+                if ((nullptr == staged[order[idx]].second) && (nullptr == value)) {
+                    result = score::MakeUnexpected(ErrorCode::KeyNotFound);
+                    break;
+                }
+                value = staged[order[idx]].second;
+            }
+            if ((nullptr == value) ? (nullptr != current) : ((nullptr == current) || (*current != *value))) {
+                changes.emplace_back(key, value);
+            }
+        }
+        if (result) {
+            if (options.wal_enabled && !changes.empty()) {
+                auto record_res = wal_encode_batch(changes);
+                if (!record_res) {
+                    result = score::MakeUnexpected(static_cast<ErrorCode>(*record_res.error()));
+                }else{
+                    result = wal_write(record_res.value());
+                }
+            }
+        }
+
+        if (result && !changes.empty()) {
+            for (const auto& [key, value] : changes) {
+                lookup.assign(key);
+                KvsCapture& capture = shards.empty() ? kvs_capture : shards[shard_index(lookup)]->capture;
+                KvsMap& data = shards.empty() ? kvs : shards[shard_index(lookup)]->data;
+                if (nullptr != value) {
+                    capture.set(data, lookup.name(), *value);
+                }else{
+                    (void)capture.erase(data, lookup.name());
+                }
+            }
+            rcu_update(changes);
+            ++generation;
+            flush_schedule(false);
+        }
+    }else{
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Helper Function to write JSON data to a file for flush process (also adds Hash file)*/
+score::Result<uint32_t> Kvs::write_json_data(const KvsMap& data, const score::filesystem::Path& json_path)
+{
+    score::Result<uint32_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::filesystem::Path dir = json_path.ParentPath();
+    if  (!dir.Empty()) {
+        const auto create_path_res = filesystem->standard->CreateDirectories(dir);
+        if(!create_path_res.has_value()) {
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        } else {
+            std::ofstream out(json_path.CStr(), std::ios::binary);
+            if (!out) {
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            } else {
+                /* Stream JSON data directly from the map, checksum is calculated on the written chunks */
+                result = stream_json_data(data, out);
+                out.close();
+                if (result && out.fail()) {
+                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+                }
+            }
+        }
+    } else {
+        logger->LogError() << "Failed to create directory for KVS file '" << json_path << "'";
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+
+    return result;
+}
+
+score::ResultBlank Kvs::write_hash_data(uint32_t hash, const score::filesystem::Path& hash_path)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::array<uint8_t, 4> hash_bytes = get_hash_bytes_adler32(hash);
+    std::ofstream hout(hash_path.CStr(), std::ios::binary);
+    if (!hout.write(reinterpret_cast<const char*>(hash_bytes.data()), hash_bytes.size())) {
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    } else {
+        result = score::ResultBlank{};
+    }
+
+    return result;
+}
+
+/* Open and read binary File */
+score::Result<KvsMap> Kvs::open_binary(const score::filesystem::Path& prefix)
+{
+    score::filesystem::Path bin_file = prefix.Native() + ".bin";
+    score::Result<KvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    ifstream in(bin_file.CStr(), ios::binary);
+    if (!in) {
+        logger->LogError() << "error: file " << bin_file << " could not be read";
+        result = score::MakeUnexpected(ErrorCode::KvsFileReadError);
+    }else{
+        ostringstream ss;
+        ss << in.rdbuf();
+        const std::string data = ss.str();
+        KvsArena* arena = load_arena(data.size());
+        auto data_res = deserialize_kvs_binary(data, arena);
+        if (!data_res) {
+            logger->LogError() << "error: KVS data corrupted (" << bin_file << ")";
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*data_res.error()));
+        }else{
+            result = std::move(data_res.value());
+        }
+        if (nullptr != arena) {
+            arena->release();
+        }
+    }
+
+    return result;
+}
+
+/* Arena for the data of a KVS file (nullptr: heap allocations), released by the caller after loading */
+KvsArena* Kvs::load_arena(size_t file_size) const
+{
+    return options.load_arena ? KvsArena::create(file_size * KVS_LOAD_ARENA_FACTOR) : nullptr;
+}
+
+/* Write binary File (checksum is embedded, no hash file needed) */
+score::ResultBlank Kvs::write_binary_data(const std::string& buf, const score::filesystem::Path& bin_path)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::filesystem::Path dir = bin_path.ParentPath();
+    if  (!dir.Empty()) {
+        const auto create_path_res = filesystem->standard->CreateDirectories(dir);
+        if(!create_path_res.has_value()) {
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        } else {
+            std::ofstream out(bin_path.CStr(), std::ios::binary);
+            if (!out.write(buf.data(), buf.size())) {
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            } else {
+                result = score::ResultBlank{};
+            }
+        }
+    } else {
+        logger->LogError() << "Failed to create directory for KVS file '" << bin_path << "'";
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }
+
+    return result;
+}
+
+/* Write a file's data to the storage device, so it survives a power loss */
+score::ResultBlank Kvs::sync_file(const score::filesystem::Path& path)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    const int fd = ::open(path.CStr(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        logger->LogError() << "error: file " << path << " could not be opened for sync";
+    }else{
+        if (0 != ::fsync(fd)) {
+            logger->LogError() << "error: file " << path << " could not be synced. Errorcode " << errno;
+        }else{
+            result = score::ResultBlank{};
+        }
+        (void)::close(fd);
+    }
+
+    return result;
+}
+
+/* Open a KVS file in the configured storage format. If only the file of the other format exists, it is read instead */
+score::Result<KvsMap> Kvs::open_kvs_file(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file)
+{
+    score::Result<KvsMap> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const bool bin_exists = ifstream(prefix.Native() + ".bin").good();
+    bool use_binary = false;
+
+    if (bin_exists) {
+        if (KvsStorageFormat::Binary == options.storage_format) {
+            use_binary = true;
+        }else{
+            use_binary = !ifstream(prefix.Native() + ".json").good();
+        }
+    }
+
+    if (use_binary) {
+        result = open_binary(prefix);
+    }else{
+        result = open_json(prefix, need_file);
+    }
+
+    return result;
+}
+
+/* Flush the key-value store*/
+score::ResultBlank Kvs::flush() {
+    return flush(options.lock_policy);
+}
+
+/* Flush with a lock policy (the flush worker waits for the locks) */
+score::ResultBlank Kvs::flush(KvsLockPolicy policy) {
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    const bool binary = (KvsStorageFormat::Binary == options.storage_format);
+    const score::filesystem::Path staged_path{filename_prefix.Native() + "_0.tmp"};
+    score::ResultBlank staged = score::MakeUnexpected(ErrorCode::UnmappedError);
+    uint32_t hash = 0;
+    size_t flushed_wal_size = 0;
+    uint64_t captured_generation = 0;
+    uint64_t new_generation = 0;
+    bool unmodified = false;
+    /* Flushes are serialized. The KVS data is captured under a brief exclusive lock, serialization and
+       file I/O run without a lock, so the time writers wait doesn't depend on the KVS size */
+    std::unique_lock<std::timed_mutex> flush_lock = acquire_lock<std::unique_lock<std::timed_mutex>>(flush_mutex, policy, options.lock_timeout);
+    if (!flush_lock.owns_lock()) {
+        staged = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }else{
+        std::shared_lock<std::shared_timed_mutex> lock = lock_shared(policy);
+        std::unique_lock<std::shared_timed_mutex> capture_lock;
+        if (lock.owns_lock() && (generation == flushed_generation)) {
+            /* Nothing changed since the last flush: skip serialization, writing and a new snapshot */
+            unmodified = true;
+            std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+            ++flush_stats.skipped;
+        }else if (lock.owns_lock()) {
+            lock.unlock();
+            capture_lock = acquire_lock<std::unique_lock<std::shared_timed_mutex>>(kvs_mutex, policy, options.lock_timeout);
+        }
+        if (capture_lock.owns_lock()) {
+            captured_generation = generation;
+            new_generation = snapshot_generation + 1U; /* A failed flush doesn't use the generation number */
+            flushed_wal_size = wal_size; /* WAL records contained in the serialized data*/
+            capture_begin();
+            capture_lock.unlock();
+
+            /* Sharded mode: merge the captured shards (without a lock) */
+            KvsMap shard_data;
+            for (const auto& shard : shards) {
+                shard_data.insert(shard->capture.captured().begin(), shard->capture.captured().end());
+            }
+            const KvsMap& data = shards.empty() ? kvs_capture.captured() : shard_data;
+            /* Serialize into a staged file, the current KVS file is only replaced after successful serialization */
+            if (binary) {
+                auto buf_res = serialize_kvs_binary(data);
+                if (!buf_res) {
+                    staged = score::MakeUnexpected(static_cast<ErrorCode>(*buf_res.error()));
+                }else{
+                    staged = write_binary_data(buf_res.value(), staged_path);
+                }
+            }else{
+                auto hash_res = write_json_data(data, staged_path);
+                if (!hash_res) {
+                    staged = score::MakeUnexpected(static_cast<ErrorCode>(*hash_res.error()));
+                }else{
+                    hash = hash_res.value();
+                    staged = score::ResultBlank{};
+                }
+            }
+            capture_end();
+            if (!staged) {
+                (void)std::remove(staged_path.CStr());
+            }
+        }else if (!unmodified) {
+            staged = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        }
+    }
+
+    if (unmodified) {
+        result = score::ResultBlank{};
+    }else if (!staged) {
+        result = staged;
+    }else{
+        /* Publish the staged data as new generation, the previous KVS file stays untouched and becomes snapshot 1.
+           For JSON the hash is written first, so the KVS file never appears without its hash */
+        const score::filesystem::Path new_prefix{filename_prefix.Native() + "_g" + to_string(new_generation)};
+        const score::filesystem::Path kvs_path{new_prefix.Native() + (binary ? ".bin" : ".json")};
+        const score::filesystem::Path hash_path{new_prefix.Native() + ".hash"};
+        if (!binary) {
+            result = write_hash_data(hash, hash_path);
+        }else{
+            result = score::ResultBlank{};
+        }
+        /* The flushed generation is published as durable (wait_durable()) and the WAL is truncated afterwards:
+           the KVS file, its hash and the directory entries must be on the device before */
+        if (result) {
+            result = sync_file(staged_path);
+            if (result && !binary) {
+                result = sync_file(hash_path);
+            }
+        }
+        if (result && (0 != std::rename(staged_path.CStr(), kvs_path.CStr()))) {
+            logger->LogError() << "error: could not rename staged file " << staged_path << ". Rename Errorcode " << errno;
+            result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+        }
+        if (result) {
+            const score::filesystem::Path dir = kvs_path.ParentPath();
+            result = sync_file(dir.Empty() ? score::filesystem::Path{"."} : dir);
+        }
+        if (!result) {
+            (void)std::remove(staged_path.CStr());
+            (void)std::remove(hash_path.CStr());
+        }else{
+            std::lock_guard<std::shared_timed_mutex> lock(kvs_mutex);
+            std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+            snapshot_files.insert(snapshot_files.begin(), SnapshotFile{new_generation, new_prefix, binary});
+            snapshot_generation = new_generation;
+            snapshot_prune();
+            flushed_generation = captured_generation;
+            ++flush_stats.written;
+        }
+        if (result && (0U != flushed_wal_size)) {
+            result = wal_truncate(flushed_wal_size);
+        }
+    }
+    if (result) {
+        std::lock_guard<std::mutex> lock(worker_mutex); /* wait_durable() checks flushed_generation with this mutex */
+        durable_cv.notify_all();
+    }
+
+    return result;
+}
+
+/* Flush on the worker thread */
+std::future<score::ResultBlank> Kvs::flush_async() {
+    std::promise<score::ResultBlank> request;
+    std::future<score::ResultBlank> result = request.get_future();
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    flush_requests.push_back(std::move(request));
+    worker_start();
+    worker_cv.notify_one();
+
+    return result;
+}
+
+/* Retrieve the modification counter */
+uint64_t Kvs::current_generation() const {
+    return generation;
+}
+
+/* Wait until a generation is contained in a KVS file (or the write-ahead log synced to the device) */
+score::ResultBlank Kvs::wait_durable(uint64_t target, std::chrono::milliseconds timeout) {
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::ResourceBusy);
+    if (options.wal_enabled && (target <= generation)) {
+        /* The records of the generation were appended to the WAL before the generation was incremented.
+           The WAL file is opened under the WAL mutex (a truncation doesn't replace it meanwhile) and synced
+           without it, writers keep appending during the sync. An empty WAL was truncated by a synced flush */
+        const score::filesystem::Path wal_path{filename_prefix.Native() + "_0.wal"};
+        int fd = -1;
+        {
+            std::lock_guard<std::mutex> wal_lock(wal_mutex);
+            if ((0U != wal_size) && (flushed_generation < target)) {
+                fd = ::open(wal_path.CStr(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    logger->LogError() << "error: file " << wal_path << " could not be opened for sync";
+                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+                }
+            }else{
+                result = score::ResultBlank{};
+            }
+        }
+        if (0 <= fd) {
+            if (0 != ::fsync(fd)) {
+                logger->LogError() << "error: file " << wal_path << " could not be synced. Errorcode " << errno;
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            }else{
+                result = score::ResultBlank{};
+            }
+            (void)::close(fd);
+        }
+    }else{
+        /* Without WAL (or a generation not reached yet) the generation is durable, once a flush contains it */
+        std::unique_lock<std::mutex> lock(worker_mutex);
+        if (durable_cv.wait_for(lock, timeout, [this, target]() { return flushed_generation >= target; })) {
+            result = score::ResultBlank{};
+        }
+    }
+
+    return result;
+}
+
+/* Retrieve flush statistics */
+score::Result<KvsFlushStatistics> Kvs::flush_statistics() {
+    score::Result<KvsFlushStatistics> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::shared_lock<std::shared_timed_mutex> lock = lock_shared(options.lock_policy);
+    if (lock.owns_lock()) {
+        std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+        result = flush_stats;
+    }else{
+        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+    }
+
+    return result;
+}
+
+/* Retrieve the snapshot count*/
+score::Result<size_t> Kvs::snapshot_count() const {
+    score::Result<size_t> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    size_t count = 0;
+    bool error = false;
+    for (size_t idx = 1; (idx < snapshot_files.size()) && (idx <= options.snapshot_max_count); ++idx) {
+        const SnapshotFile& file = snapshot_files[idx];
+        const score::filesystem::Path fname = file.prefix.Native() + (file.binary ? ".bin" : ".json");
+        auto fname_exists_res = filesystem->standard->Exists(fname);
         if (fname_exists_res) {
             if(false == fname_exists_res.value()) {
                 break;
@@ -487,60 +1484,107 @@ score::Result<size_t> Kvs::snapshot_count() const {
 
 /* Retrieve the max snapshot count*/
 size_t Kvs::snapshot_max_count() const {
-    return KVS_MAX_SNAPSHOTS;
+    return options.snapshot_max_count;
+}
+
+/* Parse a KVS filename: <prefix>_g<generation>.json/.bin or the legacy <prefix>_<n>.json/.bin */
+static bool parse_snapshot_filename(const std::string& name, const std::string& name_prefix, bool& generation_file, uint64_t& number, bool& binary)
+{
+    bool valid = false;
+    std::string_view rest(name);
+    if ((rest.size() > name_prefix.size()) && (0 == rest.compare(0, name_prefix.size(), name_prefix))) {
+        rest.remove_prefix(name_prefix.size());
+        valid = true;
+        if ((rest.size() > 5U) && (0 == rest.compare(rest.size() - 5U, 5U, ".json"))) {
+            binary = false;
+            rest.remove_suffix(5U);
+        }else if ((rest.size() > 4U) && (0 == rest.compare(rest.size() - 4U, 4U, ".bin"))) {
+            binary = true;
+            rest.remove_suffix(4U);
+        }else{
+            valid = false;
+        }
+        generation_file = valid && !rest.empty() && ('g' == rest.front());
+        if (generation_file) {
+            rest.remove_prefix(1U);
+        }
+        if (valid && !rest.empty()) {
+            const auto [ptr, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), number);
+            valid = (std::errc() == ec) && (rest.data() + rest.size() == ptr);
+        }else{
+            valid = false;
+        }
+    }
+
+    return valid;
 }
 
-/* Rotate Snapshots */
-score::ResultBlank Kvs::snapshot_rotate() {
+/* Scan the directory for the KVS files: generation files newest first, followed by the legacy files _0, _1, ... */
+score::ResultBlank Kvs::snapshot_scan() {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
-    if (lock.owns_lock()) {
-        bool error = false;
-        for (size_t idx = KVS_MAX_SNAPSHOTS; idx > 0; --idx) {
-            score::filesystem::Path hash_old = filename_prefix.Native() + "_" + to_string(idx - 1) + ".hash";
-            score::filesystem::Path hash_new = filename_prefix.Native() + "_" + to_string(idx)     + ".hash";
-            score::filesystem::Path snap_old = filename_prefix.Native() + "_" + to_string(idx - 1) + ".json";
-            score::filesystem::Path snap_new = filename_prefix.Native() + "_" + to_string(idx)     + ".json";
-
-            logger->LogInfo() << "rotating: " << snap_old << " -> " << snap_new;
-            /* Rename hash */
-            int32_t hash_rename = std::rename(hash_old.CStr(), hash_new.CStr());
-            if (0 != hash_rename) {
-                if (errno != ENOENT) {
-                    error = true;
-                    logger->LogError() << "error: could not rename hash file " << snap_old << ". Rename Errorcode " << errno;
-                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-                }
-            }
-            if(!error){
-                /* Rename snapshot */
-                int32_t snap_rename = std::rename(snap_old.CStr(), snap_new.CStr());
-                if (0 != snap_rename) {
-                    if (errno != ENOENT) {
-                        error = true;
-                        logger->LogError() << "error: could not rename snapshot file " << snap_old << ". Rename Errorcode " << errno;
-                        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
-                    }
-                }
-            }
-            if(error){
-                break;
+    const std::filesystem::path prefix_path(filename_prefix.Native());
+    const std::string name_prefix = prefix_path.filename().string() + "_";
+    const std::filesystem::path dir = prefix_path.has_parent_path() ? prefix_path.parent_path() : std::filesystem::path(".");
+    const bool prefer_binary = (KvsStorageFormat::Binary == options.storage_format);
+    std::map<uint64_t, bool> generations; /* generation -> binary */
+    std::map<uint64_t, bool> legacy;      /* n -> binary */
+
+    std::error_code ec;
+    std::filesystem::directory_iterator it(dir, ec);
+    const std::filesystem::directory_iterator end;
+    while (!ec && (it != end)) {
+        bool generation_file = false;
+        uint64_t number = 0;
+        bool binary = false;
+        if (parse_snapshot_filename(it->path().filename().string(), name_prefix, generation_file, number, binary)) {
+            auto& files = generation_file ? generations : legacy;
+            const auto inserted = files.emplace(number, binary);
+            if (!inserted.second && (binary == prefer_binary)) {
+                inserted.first->second = binary; /* Both formats exist, the configured one is used */
             }
         }
-        if(!error){
-            result = score::ResultBlank{};
+        it.increment(ec);
+    }
+    if (ec && (std::errc::no_such_file_or_directory != ec)) {
+        logger->LogError() << "error: could not scan directory " << dir.string() << ": " << ec.message();
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }else{
+        std::vector<SnapshotFile> files;
+        for (auto gen = generations.rbegin(); gen != generations.rend(); ++gen) {
+            files.push_back(SnapshotFile{gen->first, filename_prefix.Native() + "_g" + to_string(gen->first), gen->second});
         }
-    } else {
-        result = score::MakeUnexpected(ErrorCode::MutexLockFailed);
+        for (uint64_t idx = 0; (legacy.end() != legacy.find(idx)); ++idx) {
+            files.push_back(SnapshotFile{0U, filename_prefix.Native() + "_" + to_string(idx), legacy[idx]});
+        }
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot_files = std::move(files);
+        snapshot_generation = generations.empty() ? 0U : generations.rbegin()->first;
+        result = score::ResultBlank{};
     }
 
     return result;
 }
 
+/* Remove the snapshots exceeding the maximum count (snapshot_mutex must be held) */
+void Kvs::snapshot_prune() {
+    while (snapshot_files.size() > (options.snapshot_max_count + 1U)) {
+        const SnapshotFile& oldest = snapshot_files.back();
+        const score::filesystem::Path kvs_path{oldest.prefix.Native() + (oldest.binary ? ".bin" : ".json")};
+        const score::filesystem::Path hash_path{oldest.prefix.Native() + ".hash"};
+        logger->LogInfo() << "removing snapshot: " << kvs_path;
+        if ((0 != std::remove(kvs_path.CStr())) && (ENOENT != errno)) {
+            /* Not an error of the flush, the file is removed by the next flush after reopening */
+            logger->LogWarn() << "warning: could not remove snapshot file " << kvs_path << ". Remove Errorcode " << errno;
+        }
+        (void)std::remove(hash_path.CStr());
+        snapshot_files.pop_back();
+    }
+}
+
 /* Restore the key-value store from a snapshot*/
 score::ResultBlank Kvs::snapshot_restore(const SnapshotId& snapshot_id) {
     score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
-    std::unique_lock<std::mutex> lock(kvs_mutex, std::try_to_lock);
+    std::unique_lock<std::shared_timed_mutex> lock = lock_exclusive();
     if (lock.owns_lock()) {
         auto snapshot_count_res = snapshot_count();
         if (!snapshot_count_res) {
@@ -552,15 +1596,32 @@ score::ResultBlank Kvs::snapshot_restore(const SnapshotId& snapshot_id) {
             }else if (snapshot_count_res.value() < snapshot_id.id) {
                 result = score::MakeUnexpected(ErrorCode::InvalidSnapshotId);
             }else{
-                score::filesystem::Path restore_path = filename_prefix.Native() + "_" + to_string(snapshot_id.id);
-                auto data_res = open_json(
-                    restore_path,
-                    OpenJsonNeedFile::Required);
+                /* The snapshot list is only changed by flush, which holds kvs_mutex */
+                /* The snapshot is read in the format found by the scan, not in the configured storage format */
+                const SnapshotFile& snapshot = snapshot_files[snapshot_id.id];
+                auto data_res = snapshot.binary
+                    ? open_binary(snapshot.prefix)
+                    : open_json(snapshot.prefix, OpenJsonNeedFile::Required);
                 if (!data_res) {
                     result = score::MakeUnexpected(static_cast<ErrorCode>(*data_res.error()));
                 }else{
-                    kvs = std::move(data_res.value());
-                    result = score::ResultBlank{};
+                    if (options.wal_enabled) {
+                        /* Log the restored data as a single record, so a torn write can't leave a partial restore */
+                        auto data_json_res = serialize_json_data(data_res.value());
+                        if (!data_json_res) {
+                            result = score::MakeUnexpected(static_cast<ErrorCode>(*data_json_res.error()));
+                        }else{
+                            result = wal_write(encode_wal_record(WalOperation::Restore, "", data_json_res.value()));
+                        }
+                    }else{
+                        result = score::ResultBlank{};
+                    }
+                    if (result) {
+                        data_assign(std::move(data_res.value()));
+                        rcu_reload();
+                        ++generation;
+                        flush_schedule(false);
+                    }
                 }
             }
         }
@@ -573,38 +1634,421 @@ score::ResultBlank Kvs::snapshot_restore(const SnapshotId& snapshot_id) {
 
 /* Get the filename for a snapshot*/
 score::Result<score::filesystem::Path> Kvs::get_kvs_filename(const SnapshotId& snapshot_id) const {
-    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".json";
     score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
 
-    const auto fname_exists_res = filesystem->standard->Exists(filename);
-    if (fname_exists_res) {
-        if (false == fname_exists_res.value()) {
-            result = score::MakeUnexpected(ErrorCode::FileNotFound);
+    if (snapshot_files.size() <= snapshot_id.id) {
+        result = score::MakeUnexpected(ErrorCode::FileNotFound);
+    }else{
+        const SnapshotFile& file = snapshot_files[snapshot_id.id];
+        const score::filesystem::Path filename = file.prefix.Native() + (file.binary ? ".bin" : ".json");
+        const auto fname_exists_res = filesystem->standard->Exists(filename);
+        if (fname_exists_res) {
+            if (false == fname_exists_res.value()) {
+                result = score::MakeUnexpected(ErrorCode::FileNotFound);
+            } else {
+                result = filename;
+            }
         } else {
-            result = filename;
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
         }
-    } else {
-        result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
     }
     return result;
 }
 
 /* Get the hash filename for a snapshot*/
 score::Result<score::filesystem::Path> Kvs::get_hash_filename(const SnapshotId& snapshot_id) const {
-    score::filesystem::Path filename = filename_prefix.Native() + "_" + std::to_string(snapshot_id.id) + ".hash";
     score::Result<score::filesystem::Path> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
 
-    const auto fname_exists_res = filesystem->standard->Exists(filename);
-    if (fname_exists_res) {
-        if (false == fname_exists_res.value()) {
-            result = score::MakeUnexpected(ErrorCode::FileNotFound);
+    if (snapshot_files.size() <= snapshot_id.id) {
+        result = score::MakeUnexpected(ErrorCode::FileNotFound);
+    }else{
+        const score::filesystem::Path filename = snapshot_files[snapshot_id.id].prefix.Native() + ".hash";
+        const auto fname_exists_res = filesystem->standard->Exists(filename);
+        if (fname_exists_res) {
+            if (false == fname_exists_res.value()) {
+                result = score::MakeUnexpected(ErrorCode::FileNotFound);
+            } else {
+                result = filename;
+            }
         } else {
-            result = filename;
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
+        }
+    }
+    return result;
+}
+
+/*********************** Write-Ahead Log *********************/
+/* Encode a change as WAL record. SetValue stores the value as JSON object {key: {"t":..,"v":..}} */
+score::Result<std::string> Kvs::wal_encode(WalOperation operation, const std::string_view key, const KvsValue* value)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+
+    if (nullptr == value) {
+        result = encode_wal_record(operation, key, "");
+    }else{
+        auto conv = kvsvalue_to_any(*value);
+        if (!conv) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
+        }else{
+            score::json::Object entry;
+            entry.emplace(std::string(key), std::move(conv.value()));
+            auto buf_res = writer->ToBuffer(entry);
+            if (!buf_res) {
+                result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
+            }else{
+                result = encode_wal_record(operation, key, buf_res.value());
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Encode the changes of a write batch (nullptr: key removed) as one Batch record, so a torn write drops
+   the whole batch on replay. All set values are stored in one SetValue record {key: {"t":..,"v":..}, ...} */
+score::Result<std::string> Kvs::wal_encode_batch(const std::vector<std::pair<std::string_view, const KvsValue*>>& changes)
+{
+    score::Result<std::string> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    std::string records;
+    score::json::Object entries;
+    bool error = false;
+
+    for (const auto& [key, value] : changes) {
+        if (nullptr == value) {
+            records += encode_wal_record(WalOperation::RemoveKey, key, "");
+        }else{
+            auto conv = kvsvalue_to_any(*value);
+            if (!conv) {
+                result = score::MakeUnexpected(static_cast<ErrorCode>(*conv.error()));
+                error = true;
+                break;
+            }
+            entries.emplace(std::string(key), std::move(conv.value()));
         }
-    } else {
-        result = score::MakeUnexpected(static_cast<ErrorCode>(*fname_exists_res.error()));
     }
+    if (!error && !entries.empty()) {
+        auto buf_res = writer->ToBuffer(entries);
+        if (!buf_res) {
+            result = score::MakeUnexpected(ErrorCode::JsonGeneratorError);
+            error = true;
+        }else{
+            records += encode_wal_record(WalOperation::SetValue, "", buf_res.value());
+        }
+    }
+    if (!error) {
+        result = encode_wal_record(WalOperation::Batch, "", records);
+    }
+
+    return result;
+}
+
+/* Append records to the WAL (the changed map must be locked by the caller).
+   Every record type counts towards the compaction threshold */
+score::ResultBlank Kvs::wal_write(const std::string& records)
+{
+    score::ResultBlank result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    score::filesystem::Path wal_path{filename_prefix.Native() + "_0.wal"};
+    bool error = false;
+    std::unique_lock<std::mutex> lock(wal_mutex);
+
+    if (!wal_stream.is_open()) {
+        score::filesystem::Path dir = wal_path.ParentPath();
+        if (!dir.Empty()) {
+            const auto create_path_res = filesystem->standard->CreateDirectories(dir);
+            if (!create_path_res.has_value()) {
+                error = true;
+            }
+        }
+        if (!error) {
+            wal_stream.open(wal_path.CStr(), std::ios::binary | std::ios::app);
+            if (!wal_stream.is_open()) {
+                error = true;
+            }
+        }
+    }
+
+    if (!error) {
+        if (!wal_stream.write(records.data(), records.size()) || !wal_stream.flush()) {
+            wal_stream.close(); /* Reopen on next write, the torn record is dropped on replay */
+            error = true;
+        }else{
+            wal_size += records.size();
+            result = score::ResultBlank{};
+        }
+    }
+    lock.unlock();
+
+    if (error) {
+        logger->LogError() << "error: write-ahead log " << wal_path << " could not be written";
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }else if (wal_size >= options.wal_compaction_threshold) {
+        wal_compact();
+    }
+
+    return result;
+}
+
+/* Apply the WAL to the data read from the KVS file */
+score::ResultBlank Kvs::wal_replay(KvsMap& data)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    score::filesystem::Path wal_path{filename_prefix.Native() + "_0.wal"};
+
+    wal_size = 0;
+    ifstream in(wal_path.CStr(), ios::binary);
+    if (in) {
+        ostringstream ss;
+        ss << in.rdbuf();
+        const std::string wal_data = ss.str();
+        in.close();
+
+        size_t valid_size = 0;
+        const std::vector<WalRecord> records = decode_wal_records(wal_data, valid_size);
+        for (const auto& record : records) {
+            result = wal_apply(record, data);
+            if (!result) {
+                break;
+            }
+        }
+
+        /* Drop a torn or corrupted tail, so new records are appended after the last valid one */
+        if (result && (valid_size < wal_data.size())) {
+            logger->LogWarn() << "write-ahead log " << wal_path << " has an invalid tail, dropping "
+                              << (wal_data.size() - valid_size) << " bytes";
+            std::error_code ec;
+            std::filesystem::resize_file(wal_path.Native(), valid_size, ec);
+            if (ec) {
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            }
+        }
+        if (result) {
+            wal_size = valid_size;
+            logger->LogInfo() << "replayed " << records.size() << " write-ahead log records";
+        }
+    }
+
+    return result;
+}
+
+/* Apply a WAL record to the data */
+score::ResultBlank Kvs::wal_apply(const WalRecord& record, KvsMap& data)
+{
+    score::ResultBlank result = score::ResultBlank{};
+
+    if (WalOperation::SetValue == record.operation) {
+        auto entry_res = parse_json_data(record.value);
+        if (!entry_res) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*entry_res.error()));
+        }else{
+            for (auto& [key, value] : entry_res.value()) {
+                data.insert_or_assign(key, std::move(value));
+            }
+        }
+    }else if (WalOperation::RemoveKey == record.operation) {
+        (void)data.erase(record.key);
+    }else if (WalOperation::Reset == record.operation) {
+        data.clear();
+    }else if (WalOperation::Restore == record.operation) {
+        auto restore_res = parse_json_data(record.value);
+        if (!restore_res) {
+            result = score::MakeUnexpected(static_cast<ErrorCode>(*restore_res.error()));
+        }else{
+            data = std::move(restore_res.value());
+        }
+    }else{ /* WalOperation::Batch: the changes are only applied if all of them are valid */
+        size_t batch_size = 0;
+        const std::vector<WalRecord> changes = decode_wal_records(record.value, batch_size);
+        std::vector<std::pair<std::string, std::optional<KvsValue>>> staged; /* Remove: no value */
+        if (batch_size != record.value.size()) {
+            result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+        }else{
+            for (const auto& change : changes) {
+                if (WalOperation::RemoveKey == change.operation) {
+                    staged.emplace_back(change.key, std::nullopt);
+                }else if (WalOperation::SetValue == change.operation) {
+                    auto entry_res = parse_json_data(change.value);
+                    if (!entry_res) {
+                        result = score::MakeUnexpected(static_cast<ErrorCode>(*entry_res.error()));
+                        break;
+                    }
+                    for (auto& [key, value] : entry_res.value()) {
+                        staged.emplace_back(key, std::move(value));
+                    }
+                }else{
+                    result = score::MakeUnexpected(ErrorCode::ValidationFailed);
+                    break;
+                }
+            }
+        }
+        if (result) {
+            for (auto& [key, value] : staged) {
+                if (value) {
+                    data.insert_or_assign(key, std::move(value.value()));
+                }else{
+                    (void)data.erase(key);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Append size bytes at offset of a file to out, false if the file is shorter */
+static bool read_file_range(const score::filesystem::Path& path, size_t offset, size_t size, std::string& out)
+{
+    bool result = (0U == size);
+    if (!result) {
+        ifstream in(path.CStr(), ios::binary);
+        const size_t old_size = out.size();
+        out.resize(old_size + size);
+        result = in.seekg(static_cast<std::streamoff>(offset)).read(&out[old_size], static_cast<std::streamsize>(size)).good();
+    }
+
+    return result;
+}
+
+/* Remove the first flushed_size bytes from the WAL, they are contained in the flushed KVS file.
+   Records appended after the flush captured the data are kept. Truncation is serialized by the flush mutex.
+   The kept records are copied and synced while writers append, the WAL mutex is only held to copy the
+   records appended meanwhile and to replace the WAL */
+score::ResultBlank Kvs::wal_truncate(size_t flushed_size)
+{
+    score::ResultBlank result = score::ResultBlank{};
+    score::filesystem::Path wal_path{filename_prefix.Native() + "_0.wal"};
+    const score::filesystem::Path staged_path{wal_path.Native() + ".tmp"};
+    size_t copied_size = wal_size; /* Only grows until the WAL is replaced below */
+    std::string remaining;
+
+    /* The remaining records are staged and synced, the WAL is replaced by a rename: a crash leaves either
+       the old or the new WAL, never a partially written one */
+    if (!read_file_range(wal_path, flushed_size, copied_size - flushed_size, remaining)) {
+        logger->LogError() << "error: write-ahead log " << wal_path << " could not be read";
+        result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+    }else{
+        result = write_binary_data(remaining, staged_path);
+    }
+    if (result) {
+        result = sync_file(staged_path);
+    }
+    if (result) {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (copied_size < wal_size) {
+            std::string appended;
+            if (!read_file_range(wal_path, copied_size, wal_size - copied_size, appended)) {
+                logger->LogError() << "error: write-ahead log " << wal_path << " could not be read";
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            }else{
+                std::ofstream out(staged_path.CStr(), std::ios::binary | std::ios::app);
+                if (!out.write(appended.data(), appended.size()) || !out.flush()) {
+                    result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+                }else{
+                    out.close();
+                    result = sync_file(staged_path);
+                    remaining += appended;
+                }
+            }
+        }
+        if (result) {
+            wal_stream.close(); /* Reopened on the next write */
+            if (0 != std::rename(staged_path.CStr(), wal_path.CStr())) {
+                logger->LogError() << "error: could not rename staged file " << staged_path << ". Rename Errorcode " << errno;
+                result = score::MakeUnexpected(ErrorCode::PhysicalStorageFailure);
+            }else{
+                wal_size = remaining.size();
+            }
+        }
+    }
+    if (!result) {
+        (void)std::remove(staged_path.CStr());
+    }
+
     return result;
 }
 
+/* Fold the WAL into a new KVS snapshot. The flush runs on the flush worker with any flush policy,
+   a writer crossing the threshold doesn't wait for it */
+void Kvs::wal_compact()
+{
+    flush_schedule(true);
+}
+
+/*********************** Flush Worker *********************/
+/* Arm the flush deadline after a change with the background flush policy,
+   immediate: flush as soon as possible with any flush policy (WAL compaction) */
+void Kvs::flush_schedule(bool immediate)
+{
+    if (immediate || (KvsFlushPolicy::Background == options.flush_policy)) {
+        const auto now = std::chrono::steady_clock::now();
+        const bool count_reached = (0U != options.flush_change_count)
+            && ((generation - flushed_generation) >= options.flush_change_count);
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        if (immediate || count_reached) {
+            if (!flush_deadline || (*flush_deadline > now)) {
+                flush_deadline = now;
+            }
+        }else if (!flush_deadline) {
+            flush_deadline = now + options.flush_delay; /* Changes until the deadline are coalesced */
+        }
+        worker_start();
+        worker_cv.notify_one();
+    }
+}
+
+/* Start the worker thread, if it is not running (worker_mutex must be held by the caller) */
+void Kvs::worker_start()
+{
+    if (!worker_thread.joinable()) {
+        worker_thread = std::thread(&Kvs::worker_run, this);
+    }
+}
+
+/* Stop the worker thread, pending requests and changes are flushed before */
+void Kvs::worker_shutdown()
+{
+    std::unique_lock<std::mutex> lock(worker_mutex);
+    if (worker_thread.joinable()) {
+        worker_stop = true;
+        worker_cv.notify_one();
+        lock.unlock();
+        worker_thread.join();
+        lock.lock();
+        worker_stop = false;
+    }
+}
+
+void Kvs::worker_run()
+{
+    std::unique_lock<std::mutex> lock(worker_mutex);
+    while (!worker_stop || flush_deadline || !flush_requests.empty()) {
+        const auto now = std::chrono::steady_clock::now();
+        if (worker_stop || !flush_requests.empty() || (flush_deadline && (*flush_deadline <= now))) {
+            std::vector<std::promise<score::ResultBlank>> requests = std::move(flush_requests);
+            flush_requests.clear();
+            flush_deadline.reset();
+            /* Changes and requests arriving during the flush are handled by the next flush */
+            lock.unlock();
+            const score::ResultBlank result = flush(KvsLockPolicy::Blocking); /* The worker doesn't block a caller */
+            lock.lock();
+            if (!result && requests.empty() && (KvsFlushPolicy::Background != options.flush_policy)) {
+                logger->LogWarn() << "write-ahead log compaction failed, log is kept until the next flush";
+            }else if (!result && !worker_stop && (KvsFlushPolicy::Background == options.flush_policy)) {
+                logger->LogWarn() << "background flush failed, retry in " << options.flush_delay.count() << " ms";
+                if (!flush_deadline) {
+                    flush_deadline = now + options.flush_delay;
+                }
+            }
+            for (auto& request : requests) {
+                request.set_value(result);
+            }
+        }else if (flush_deadline) {
+            (void)worker_cv.wait_until(lock, *flush_deadline);
+        }else{
+            worker_cv.wait(lock);
+        }
+    }
+}
+
 } /* namespace score::mw::per::kvs */
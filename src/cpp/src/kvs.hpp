@@ -14,24 +14,42 @@
 #define SCORE_LIB_KVS_KVS_HPP
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include "internal/error.hpp"
+#include "internal/kvs_capture.hpp"
+#include "internal/kvs_defaults_image.hpp"
+#include "internal/kvs_rcu.hpp"
+#include "kvs_compiled_defaults.hpp"
 #include "kvsvalue.hpp"
 #include "score/filesystem/filesystem.h"
-#include "score/json/json_parser.h"
 #include "score/json/json_writer.h"
 #include "score/result/result.h"
 #include "score/mw/log/logger.h"
 
-#define KVS_MAX_SNAPSHOTS 3
+#define KVS_MAX_SNAPSHOTS 3 /* Default maximum snapshot count*/
+#define KVS_WAL_COMPACTION_THRESHOLD (64U * 1024U) /* Default WAL size in bytes which triggers a compaction*/
+#define KVS_LOCK_TIMEOUT_MS 10U /* Default wait time of KvsLockPolicy::Timed*/
+#define KVS_FLUSH_DELAY_MS 100U /* Default delay of KvsFlushPolicy::Background*/
+#define KVS_LOAD_ARENA_FACTOR 8U /* Size of the load arena relative to the file length*/
 
 namespace score::mw::per::kvs {
 
+/* Write-ahead log operation and record (defined in internal/kvs_wal.hpp)*/
+enum class WalOperation : std::uint8_t;
+struct WalRecord;
+
 struct InstanceId {
     size_t id;
 
@@ -66,6 +84,186 @@ enum class OpenJsonNeedFile {
     Required = 1 /* Required: The file must already exist */
 };
 
+/* Storage format of the KVS files*/
+enum class KvsStorageFormat {
+    Json = 0,  /* JSON: kvs_<id>_g<n>.json with checksum in kvs_<id>_g<n>.hash */
+    Binary = 1 /* Binary: kvs_<id>_g<n>.bin with embedded checksum (layout see internal/kvs_binary.hpp) */
+};
+
+/* Behavior of the KVS functions, if the KVS is locked by another thread*/
+enum class KvsLockPolicy {
+    Try = 0,      /* Try: Fail immediately with MutexLockFailed */
+    Timed = 1,    /* Timed: Wait up to KvsOptions::lock_timeout, then fail with MutexLockFailed */
+    Blocking = 2  /* Blocking: Wait until the lock is acquired */
+};
+
+/* When the KVS data is flushed*/
+enum class KvsFlushPolicy {
+    Manual = 0,    /* Manual: Only flush() and flush_async() */
+    Background = 1 /* Background: A worker thread flushes the changes of KvsOptions::flush_delay
+                      (or after KvsOptions::flush_change_count changes) in one flush */
+};
+
+/* Optional settings for opening a KVS (all members have defaults)*/
+struct KvsOptions {
+    /* Write-ahead log: set_value, remove_key, reset_key, reset, commit and snapshot_restore append a record to
+       kvs_<id>_0.wal, so changes are persisted without a full flush. Open replays the log over the KVS file*/
+    bool wal_enabled = false;
+
+    /* WAL size in bytes after which the log is compacted (flushed by the flush worker) into a new KVS snapshot*/
+    size_t wal_compaction_threshold = KVS_WAL_COMPACTION_THRESHOLD;
+
+    /* Format used by flush. Reading falls back to the other format if only that file exists,
+       so existing JSON stores are migrated in place by the next flush*/
+    KvsStorageFormat storage_format = KvsStorageFormat::Json;
+
+    /* Default values compiled into the binary (kvs_compiled_defaults Bazel rule). If set, the defaults
+       files (kvs_<id>_default.*) are not read. The table must outlive the KVS (static storage)*/
+    const KvsCompiledDefaults* compiled_defaults = nullptr;
+
+    /* Maximum number of snapshots kept besides the current KVS file. 0 keeps no history, each flush
+       then only removes the previous KVS file*/
+    size_t snapshot_max_count = KVS_MAX_SNAPSHOTS;
+
+    /* Locking: reading functions (get_value, key_exists, get_all_keys, flush) share the KVS, modifying
+       functions need exclusive access. The policy selects what happens if the access is not available*/
+    KvsLockPolicy lock_policy = KvsLockPolicy::Try;
+    std::chrono::milliseconds lock_timeout = std::chrono::milliseconds(KVS_LOCK_TIMEOUT_MS);
+
+    /* Read-mostly mode: get_value, key_exists and get_all_keys read an immutable version of the KVS data
+       without any lock (internal/kvs_rcu.hpp). Every change publishes a new version, which makes writing
+       more expensive and needs memory for a second copy of the data*/
+    bool read_mostly = false;
+
+    /* Load arena: the map nodes and array/object elements of loaded KVS and defaults files are allocated
+       in one chunk sized from the file length (internal/kvs_arena.hpp) instead of one heap allocation each.
+       The chunk is freed at once, when the loaded data was replaced (e.g. reset, snapshot_restore) and no
+       value of it is used anymore. Removing single keys doesn't free arena memory*/
+    bool load_arena = false;
+
+    /* Sharded mode (shard_count > 1): keys are distributed by their hash over independently locked shards,
+       so changes of keys in different shards run in parallel. Functions on the complete data (get_all_keys,
+       flush, reset, snapshot_restore) lock all shards. 0 and 1 disable the sharded mode*/
+    size_t shard_count = 1U;
+
+    /* Background flush: the first change after a flush is flushed by the worker after flush_delay, all changes
+       until then are coalesced. flush_change_count (0: disabled) flushes earlier, after this number of changes*/
+    KvsFlushPolicy flush_policy = KvsFlushPolicy::Manual;
+    std::chrono::milliseconds flush_delay = std::chrono::milliseconds(KVS_FLUSH_DELAY_MS);
+    size_t flush_change_count = 0U;
+};
+
+/* Flush statistics of a KVS instance*/
+struct KvsFlushStatistics {
+    size_t written = 0; /* Flushes which wrote a new KVS file */
+    size_t skipped = 0; /* Flushes which were skipped, because the KVS was not modified since the last flush */
+};
+
+/**
+ * @class KvsKey
+ * @brief A prepared key for frequently accessed keys.
+ *
+ * The key stores its name and the hash of the name, so the Kvs functions taking a KvsKey neither
+ * copy the key nor compute the hash for the shard selection (sharded mode) or the lookup of the
+ * read-mostly version. Create the key once and reuse it for every access.
+ */
+class KvsKey final {
+    public:
+        /**
+         * @brief Constructs a prepared key.
+         * @param name The key.
+         */
+        explicit KvsKey(const std::string_view name);
+
+        /**
+         * @brief Constructs a prepared key from an owned string (moved, not copied).
+         *        Passed as rvalue to set_value() or emplace_value(), the name is moved on into the KVS,
+         *        if the key is inserted.
+         * @param name The key.
+         */
+        explicit KvsKey(std::string&& name);
+
+        /* String literals (the std::string_view and std::string overloads would be ambiguous) */
+        explicit KvsKey(const char* name);
+
+        /**
+         * @brief Retrieves the name of the key.
+         * @return The key.
+         */
+        const std::string& name() const;
+
+        /**
+         * @brief Retrieves the hash of the key (std::hash<std::string_view> of the name).
+         * @return The hash.
+         */
+        size_t hash() const;
+
+    private:
+        friend class Kvs;
+
+        /* Key reused by the Kvs functions taking several std::string_view keys */
+        KvsKey();
+        void assign(const std::string_view name);
+
+        std::string key;
+        size_t key_hash;
+};
+
+/**
+ * @class KvsWriteBatch
+ * @brief Changes of several keys, which are applied together by Kvs::commit().
+ *
+ * The changes are only staged in the batch, the KVS is not accessed until the commit.
+ * Changes of the same key are applied in the order they were staged.
+ */
+class KvsWriteBatch final {
+    public:
+        /**
+         * @brief Stages setting the value of a key.
+         * @param key The key to set.
+         * @param value The value to store.
+         * @return Reference to this batch (for chaining).
+         */
+        KvsWriteBatch& set_value(const std::string_view key, const KvsValue& value);
+
+        /**
+         * @brief Stages setting the value of a key, the value is moved into the batch.
+         * @param key The key to set.
+         * @param value The value to store (moved).
+         * @return Reference to this batch (for chaining).
+         */
+        KvsWriteBatch& set_value(const std::string_view key, KvsValue&& value);
+
+        /**
+         * @brief Stages removing a key. The commit fails with ErrorCode::KeyNotFound,
+         *        if the key doesn't exist at this point of the batch.
+         * @param key The key to remove.
+         * @return Reference to this batch (for chaining).
+         */
+        KvsWriteBatch& remove_key(const std::string_view key);
+
+        /**
+         * @brief Retrieves the number of staged changes.
+         * @return The number of changes.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Removes all staged changes.
+         */
+        void clear();
+
+    private:
+        friend class Kvs;
+
+        /* Staged change, a remove has no value */
+        struct Change {
+            std::string key;
+            std::optional<KvsValue> value;
+        };
+        std::vector<Change> changes;
+};
+
 /**
  * @class Kvs
  * @brief A thread-safe key-value store (KVS) CPP Class.
@@ -81,34 +279,36 @@ enum class OpenJsonNeedFile {
  * - `get_all_keys`: Retrieves all keys stored in the KVS (only written keys, not defaults).
  * - `key_exists`: Checks if a specific key exists in the KVS (only written keys).
  * - `get_value`: Retrieves the value associated with a specific key (returns default if not written).
+ * - `visit_value`: Passes the value of a key to a visitor without copying it (visits default if not written).
  * - `get_default_value`: Retrieves the default value associated with a specific key.
  * - `reset_key`: Resets a key to its default value if available.
  * - `has_default_value`: Checks if a default value exists for a specific key.
- * - `set_value`: Sets the value for a specific key in the KVS.
+ * - `set_value`: Sets the value for a specific key in the KVS (KvsValue or typed C++ value).
+ * - `emplace_value`: Constructs the value of a key from KvsValue constructor arguments and moves it into the KVS.
+ * - `get_value_as`: Retrieves the value of a key as C++ type.
  * - `remove_key`: Removes a specific key from the KVS.
+ * - `commit`: Applies the changes of a KvsWriteBatch atomically.
+ * - `get_values`: Retrieves the values of several keys with one lock.
+ * - `set_values`: Sets the values of several keys atomically with one lock.
+ * - The key functions are also available with a prepared KvsKey (no key copy, precomputed hash),
+ *   set_value and emplace_value also with an owned KvsKey (the name is moved into the KVS).
  * - `flush`: Flushes the KVS to storage.
  * - `flush_default`: Flushes the default values to storage.
+ * - `flush_statistics`: Retrieves the number of written and skipped flushes.
+ * - `flush_async`: Flushes the KVS on the flush worker thread.
+ * - `current_generation`: Retrieves the modification counter of the KVS data.
+ * - `wait_durable`: Waits until a generation of the KVS data is persisted.
  * - `snapshot_count`: Retrieves the number of available snapshots.
  * - `snapshot_max_count`: Retrieves the maximum number of snapshots allowed.
  * - `snapshot_restore`: Restores the KVS from a specified snapshot.
  * - `get_kvs_filename`: Retrieves the filename (path) associated with a snapshot.
  * - `get_hash_filename`: Retrieves the hashname (path) associated with a snapshot.
  *
- * Private Methods:
- * - `snapshot_rotate`: Rotates the snapshots, ensuring that the maximum count is maintained.
- * - `parse_json_data`: Parses JSON data into an unordered map of key-value pairs.
- * - `open_json`: Opens a JSON file and returns its contents as an unordered map of key-value pairs.
- * - `write_json_data`: Writes the provided data to a JSON file.
- *
- * Private Members:
- * - `kvs_mutex`: A mutex for ensuring thread safety.
- * - `kvs`: An unordered map for storing key-value pairs.
- * - `default_mutex`: A mutex for default value operations.
- * - `default_values`: An unordered map for storing optional default values.
- * - `filename_prefix`: A path prefix for filenames associated with snapshots.
- * - `filesystem`: A unique pointer to a filesystem handler for file operations.
- * - `parser`: A unique pointer to a JSON parser for reading KVS data.
- * - `writer`: A unique pointer to a JSON writer for writing KVS data.
+ * Snapshot files:
+ * Each flush writes a new file kvs_<id>_g<generation>.json/.bin (with .hash for JSON), the previous
+ * files are not renamed and become the snapshots. Only the oldest snapshot exceeding the maximum
+ * count is removed. Files of the former layout (kvs_<id>_<n>.json/.bin) are read as older generations.
+ * The Rust implementation uses the same JSON file names, so both read the files written by the other.
  *
  * ----------------Notice----------------
  * - Blank should be used instead of void for Result class
@@ -128,12 +328,17 @@ class Kvs final {
         Kvs(Kvs&& other) noexcept;
         Kvs& operator=(Kvs&& other) noexcept;
 
+        /* Stops the flush worker, pending changes of KvsFlushPolicy::Background are flushed */
+        ~Kvs();
+
         /**
          * @brief Opens the key-value store with the specified instance ID and flags.
          *
          * This function initializes and opens the key-value store (KVS) for a given instance ID.
          * It allows the caller to specify whether default values and an existing KVS are required
          * or optional during the opening process.
+         * The default values are served from a read-only mapped defaults image (kvs_<id>_default.img),
+         * which is generated from the defaults JSON on the first open and regenerated when the JSON changes.
          *
          * @param id The instance ID of the KVS. This uniquely identifies the KVS instance.
          * @param need_defaults A flag of type OpenNeedDefaults indicating whether default values
@@ -145,6 +350,7 @@ class Kvs final {
          *                 - OpenNeedKvs::Optional: An empty KVS will be used if no KVS exists.
          * @param dir The directory path where the KVS files are located. It is passed as an rvalue reference to avoid unnecessary copying.
          *            Use "" or "." for the current directory.
+         * @param options Optional settings (e.g. write-ahead log), see KvsOptions.
          * @return A Result object containing either:
          *         - A Kvs object if the operation is successful.
          *         - An ErrorCode if an error occurs during the operation.
@@ -152,7 +358,7 @@ class Kvs final {
          * IMPORTANT: Instead of using the Kvs::open method directly, it is recommended to use the KvsBuilder class.
          *
          */
-        static score::Result<Kvs> open(const InstanceId& instance_id, OpenNeedDefaults need_defaults, OpenNeedKvs need_kvs, const std::string&& dir);
+        static score::Result<Kvs> open(const InstanceId& instance_id, OpenNeedDefaults need_defaults, OpenNeedKvs need_kvs, const std::string&& dir, const KvsOptions& options = KvsOptions{});
 
 
         /**
@@ -196,6 +402,22 @@ class Kvs final {
         score::Result<KvsValue> get_value(const std::string_view key);
 
 
+        /**
+         * @brief Calls a visitor with the value of a key without copying the value.
+         *        Like get_value(), the default value is visited for a key without a written value.
+         *        The visitor runs while the KVS is locked for reading (read-mostly mode: while the
+         *        version is in use), so the read takes the same time for any value size.
+         *        The visitor must not keep the reference and must not call functions of this KVS.
+         *
+         * @param key The key of the value.
+         * @param visitor Called once with the value, if the key has a written or a default value.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result (the visitor was called).
+         *         - On failure: Returns an ErrorCode describing the error (e.g. KeyNotFound).
+         */
+        score::ResultBlank visit_value(const std::string_view key, const std::function<void(const KvsValue&)>& visitor);
+
+
         /**
          * @brief Retrieves the default value associated with the specified key.
          *
@@ -258,6 +480,64 @@ class Kvs final {
         score::ResultBlank set_value(const std::string_view key, const KvsValue& value);
 
 
+        /**
+         * @brief Stores a key-value pair, the value is moved into the key-value store.
+         *
+         * @param key The key associated with the value to be stored.
+         * @param value The value to be stored (moved).
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error.
+         */
+        score::ResultBlank set_value(const std::string_view key, KvsValue&& value);
+
+
+        /**
+         * @brief Stores a C++ value, e.g. set_value("count", 5) or set_value("names", std::move(names)).
+         *        Strings and containers passed as rvalue are moved into the key-value store.
+         *
+         * @tparam T A type writable by KvsValueConverter (kvsvalue.hpp): int32_t, uint32_t, int64_t, uint64_t,
+         *           double, bool, std::string, string literals and std::vector / std::unordered_map<std::string, ...> of those.
+         * @param key The key associated with the value to be stored.
+         * @param value The value to be stored.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error.
+         */
+        template <typename T, typename = std::enable_if_t<KvsValueConverter<std::decay_t<T>>::writable>>
+        score::ResultBlank set_value(const std::string_view key, T&& value);
+
+
+        /**
+         * @brief Constructs a value from the arguments and stores it, e.g. emplace_value("list", std::move(elements))
+         *        or emplace_value("name", "text"). The constructed value is moved into the key-value store, not copied.
+         *
+         * @param key The key associated with the value to be stored.
+         * @param args The arguments of a KvsValue constructor.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error.
+         */
+        template <typename... Args>
+        score::ResultBlank emplace_value(const std::string_view key, Args&&... args);
+
+
+        /**
+         * @brief Retrieves the value of a key as C++ type. Scalars are read from the stored value
+         *        without copying the KvsValue. Like get_value(), the default value is returned
+         *        for a key without a written value.
+         *
+         * @tparam T A type readable by KvsValueConverter (kvsvalue.hpp), other types (e.g. const char*) don't compile.
+         *           Number types are not converted, T must match the stored type.
+         * @param key The key of the value.
+         * @return A score::Result object containing the value or an error.
+         *         - On success: The value.
+         *         - On failure: An ErrorCode, InvalidValueType if the value has another type.
+         */
+        template <typename T>
+        score::Result<T> get_value_as(const std::string_view key);
+
+
         /**
          * @brief Removes a key-value pair from the store based on the specified key.
          *
@@ -270,9 +550,85 @@ class Kvs final {
         score::ResultBlank remove_key(const std::string_view key);
 
 
+        /**
+         * @brief Applies all changes of a write batch atomically with one exclusive lock of the KVS.
+         *        Readers and flush see either none or all changes, the write-ahead log receives
+         *        a single record for the batch. The batch counts as one change of the KVS data
+         *        (see current_generation()).
+         *        If a change fails (e.g. removing a missing key), no change of the batch is applied.
+         *
+         * @param batch The staged changes, the batch is not modified.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error.
+         */
+        score::ResultBlank commit(const KvsWriteBatch& batch);
+
+
+        /**
+         * @brief Retrieves the values of several keys with one lock of the KVS
+         *        (in read-mostly mode all values are read from the same version).
+         *        Like get_value(), the default value is returned for a key without a written value.
+         *
+         * @param keys The keys to retrieve.
+         * @param values Output, resized to the number of keys. Element i holds the value of keys[i],
+         *               or no value, if the key has neither a written nor a default value.
+         *               Reusing the container avoids allocations for values of the same type.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error (values is then unspecified).
+         */
+        score::ResultBlank get_values(const std::vector<std::string_view>& keys, std::vector<std::optional<KvsValue>>& values);
+
+
+        /**
+         * @brief Sets the values of several keys with one lock of the KVS.
+         *        The values are applied atomically like a KvsWriteBatch of set_value() changes,
+         *        if a key occurs more than once, the last value is stored.
+         *
+         * @param entries The keys and their values.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: Returns an ErrorCode describing the error (no value is changed).
+         */
+        score::ResultBlank set_values(const std::vector<std::pair<std::string_view, KvsValue>>& entries);
+
+
+        /* Overloads with a prepared key: same behavior as the std::string_view functions above,
+           the key is not copied and its hash is only computed by the lookup of the map (see KvsKey) */
+        score::Result<bool> key_exists(const KvsKey& key);
+        score::Result<KvsValue> get_value(const KvsKey& key);
+        score::ResultBlank visit_value(const KvsKey& key, const std::function<void(const KvsValue&)>& visitor);
+        score::Result<KvsValue> get_default_value(const KvsKey& key);
+        score::ResultBlank reset_key(const KvsKey& key);
+        score::Result<bool> has_default_value(const KvsKey& key);
+        score::ResultBlank set_value(const KvsKey& key, const KvsValue& value);
+        score::ResultBlank set_value(const KvsKey& key, KvsValue&& value);
+        template <typename T, typename = std::enable_if_t<KvsValueConverter<std::decay_t<T>>::writable>>
+        score::ResultBlank set_value(const KvsKey& key, T&& value);
+        template <typename... Args>
+        score::ResultBlank emplace_value(const KvsKey& key, Args&&... args);
+        template <typename T>
+        score::Result<T> get_value_as(const KvsKey& key);
+        score::ResultBlank remove_key(const KvsKey& key);
+
+        /* Overloads with an owned key: the name of the key is moved into the KVS, if the key is inserted
+           (e.g. set_value(KvsKey(std::move(name)), std::move(value)) stores a new entry without any copy) */
+        score::ResultBlank set_value(KvsKey&& key, const KvsValue& value);
+        score::ResultBlank set_value(KvsKey&& key, KvsValue&& value);
+        template <typename T, typename = std::enable_if_t<KvsValueConverter<std::decay_t<T>>::writable>>
+        score::ResultBlank set_value(KvsKey&& key, T&& value);
+        template <typename... Args>
+        score::ResultBlank emplace_value(KvsKey&& key, Args&&... args);
+
+
         /**
          * @brief Flushes the key-value store, ensuring that all pending changes
          *        are written to the underlying storage.
+         *        If the write-ahead log is used, the flushed records are removed from the log.
+         *        The data is written to a new KVS file, the previous KVS file becomes snapshot 1.
+         *        If the KVS was not modified since the last flush, nothing is written and
+         *        no snapshot is created (see flush_statistics()).
          *
          * @return A score::Result object that indicates the success or failure of the operation.
          *         - On success: Returns a blank score::Result.
@@ -281,6 +637,48 @@ class Kvs final {
         score::ResultBlank flush();
 
 
+        /**
+         * @brief Retrieves the flush statistics of the key-value store.
+         *
+         * @return A score::Result containing the KvsFlushStatistics or an ErrorCode.
+         */
+        score::Result<KvsFlushStatistics> flush_statistics();
+
+
+        /**
+         * @brief Flushes the key-value store on the flush worker thread.
+         *        Requests arriving while the worker is busy are coalesced into one flush.
+         *
+         * @return A future with the result of the flush (see flush()).
+         */
+        std::future<score::ResultBlank> flush_async();
+
+
+        /**
+         * @brief Retrieves the generation of the KVS data, which is incremented by every change.
+         *
+         * @return The current generation (argument of wait_durable()).
+         */
+        uint64_t current_generation() const;
+
+
+        /**
+         * @brief Waits until a generation of the KVS data is persisted.
+         *        A generation is persisted, if it is contained in a flushed KVS file.
+         *        With the write-ahead log, the changes of a reached generation are already in the log, which is
+         *        synced to the storage device before returning. A generation not reached yet is waited for
+         *        like without the log.
+         *
+         * @param generation The generation to wait for (see current_generation()).
+         * @param timeout The maximum wait time.
+         * @return A score::Result object that indicates the success or failure of the operation.
+         *         - On success: Returns a blank score::Result.
+         *         - On failure: ErrorCode::ResourceBusy, if the generation is not persisted within the timeout,
+         *           ErrorCode::PhysicalStorageFailure, if the write-ahead log could not be synced.
+         */
+        score::ResultBlank wait_durable(uint64_t generation, std::chrono::milliseconds timeout);
+
+
         /**
          * @brief Retrieves the number of snapshots currently stored in the key-value store.
          *
@@ -295,7 +693,8 @@ class Kvs final {
          * @brief Retrieves the maximum number of snapshots that can be stored.
          *
          * This function returns the upper limit on the number of snapshots
-         * that the key-value store can maintain at any given time.
+         * that the key-value store can maintain at any given time
+         * (configured with KvsBuilder::snapshot_max_count, default: KVS_MAX_SNAPSHOTS).
          *
          * @return The maximum count of snapshots as a size_t value.
          */
@@ -320,6 +719,8 @@ class Kvs final {
         /**
          * @brief Retrieves the filename associated with a given snapshot ID in the key-value store.
          *
+         * The file of the configured storage format (.json or .bin) is preferred, if both exist.
+         *
          * @param snapshot_id The identifier of the snapshot for which the filename is to be retrieved.
          * @return score::ResultBlank
          *         - On success: A score::filesystem::Path with the filename (path) associated with the snapshot ID.
@@ -347,33 +748,183 @@ class Kvs final {
         Kvs();
 
         /* Internal storage and configuration details.*/
-        std::mutex kvs_mutex;
-        std::unordered_map<std::string, KvsValue> kvs;
+        std::shared_timed_mutex kvs_mutex;  /* Shared for readers, exclusive for writers and the flush capture */
+        std::timed_mutex flush_mutex;       /* Serializes flushes and the WAL truncation */
+        KvsMap kvs;
+        KvsCapture kvs_capture;             /* Flush: captured data, kvs then only holds the changes */
+        std::unique_ptr<KvsRcuMap> rcu_map; /* Read-mostly mode: lock-free readable copy of kvs */
+        std::mutex rcu_mutex;               /* Serializes publishing, writers of different shards run in parallel */
+
+        /* Sharded mode: part of the KVS data with the keys hashing to this shard */
+        struct KvsShard {
+            std::shared_timed_mutex mutex;
+            KvsMap data;
+            KvsCapture capture;
+        };
+        std::vector<std::unique_ptr<KvsShard>> shards; /* Sharded mode: KVS data, kvs stays empty */
+
+        /* Locked map holding a key: kvs, or in the sharded mode the key's shard with the KVS lock shared */
+        template <typename Lock>
+        struct KeyAccess {
+            std::shared_lock<std::shared_timed_mutex> kvs_lock; /* Sharded mode only */
+            Lock lock;                                          /* Lock of kvs or the shard */
+            KvsMap* data = nullptr; /* nullptr if a lock is not available */
+            KvsCapture* capture = nullptr;                             /* Capture of data (see flush) */
+        };
 
         /* Optional default values */
-        std::unordered_map<std::string, KvsValue> default_values;
+        KvsMap default_values;
+        KvsDefaultsImage default_image;
 
         /* Filename prefix */
         score::filesystem::Path filename_prefix;
 
+        /* KVS file of a generation (legacy files kvs_<id>_<n> have generation 0) */
+        struct SnapshotFile {
+            uint64_t generation;
+            score::filesystem::Path prefix; /* Path without extension */
+            bool binary;                    /* Stored as .bin instead of .json */
+        };
+
+        /* Snapshot files */
+        mutable std::mutex snapshot_mutex;        /* Also guards flush_stats */
+        std::vector<SnapshotFile> snapshot_files; /* KVS file and snapshots, newest first (index = SnapshotId) */
+        uint64_t snapshot_generation;             /* Highest generation of the KVS files */
+
         /* Filesystem handling */
         std::unique_ptr<score::filesystem::Filesystem> filesystem;
 
         /* Json handling */
-        std::unique_ptr<score::json::IJsonParser> parser;
         std::unique_ptr<score::json::IJsonWriter> writer;
 
         /* Logging */
         std::unique_ptr<score::mw::log::Logger> logger;
 
+        /* Options */
+        KvsOptions options;
+
+        /* Write-ahead log */
+        std::mutex wal_mutex; /* Writers of different shards append concurrently */
+        std::ofstream wal_stream;    /* Opened on first write */
+        std::atomic<size_t> wal_size;
+
+        /* Dirty tracking */
+        std::atomic<uint64_t> generation;         /* Incremented by every change */
+        std::atomic<uint64_t> flushed_generation; /* Contained in the last written KVS file */
+        KvsFlushStatistics flush_stats;
+
+        /* Flush worker (started on first use) */
+        std::mutex worker_mutex;
+        std::condition_variable worker_cv;  /* Wakes the worker: flush due, request or stop */
+        std::condition_variable durable_cv; /* Wakes wait_durable() after a flush */
+        std::thread worker_thread;
+        bool worker_stop;
+        std::optional<std::chrono::steady_clock::time_point> flush_deadline; /* Unset: nothing to flush */
+        std::vector<std::promise<score::ResultBlank>> flush_requests;
+
         /* Private Methods */
-        score::ResultBlank snapshot_rotate();
-        score::Result<std::unordered_map<std::string, KvsValue>> parse_json_data(const std::string& data);
-        score::Result<std::unordered_map<std::string, KvsValue>> open_json(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file);
-        score::ResultBlank write_json_data(const std::string& buf);
+        std::shared_lock<std::shared_timed_mutex> lock_shared(KvsLockPolicy policy);
+        std::unique_lock<std::shared_timed_mutex> lock_exclusive();
+        template <typename Lock>
+        KeyAccess<Lock> lock_key(const KvsKey& key);
+        std::vector<std::shared_lock<std::shared_timed_mutex>> lock_shards(KvsLockPolicy policy);
+        size_t shard_index(const std::string_view key) const;
+        size_t shard_index(const KvsKey& key) const;
+        bool data_empty() const;
+        void data_assign(KvsMap&& data);
+        KvsMap data_copy() const;
+        const KvsValue* data_find(const KvsKey& key) const;
+        void capture_begin();
+        void capture_end();
+        void rcu_update(const std::string_view key, const KvsValue* value);
+        void rcu_update(const std::vector<std::pair<std::string_view, const KvsValue*>>& changes);
+        void rcu_reload();
+        template <typename Key, typename Value>
+        score::ResultBlank set_value_impl(Key&& key, Value&& value);
+        score::ResultBlank visit_default_value(const KvsKey& key, const std::function<void(const KvsValue&)>& visitor);
+        score::ResultBlank commit_changes(const std::vector<std::pair<std::string_view, const KvsValue*>>& staged);
+        score::ResultBlank snapshot_scan();
+        void snapshot_prune();
+        score::Result<KvsMap> parse_json_data(const std::string& data, KvsResource* resource = nullptr);
+        score::Result<std::string> serialize_json_data(const KvsMap& data);
+        score::Result<KvsMap> open_json(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file);
+        score::Result<uint32_t> write_json_data(const KvsMap& data, const score::filesystem::Path& json_path);
+        score::ResultBlank write_hash_data(uint32_t hash, const score::filesystem::Path& hash_path);
+        score::Result<KvsMap> open_binary(const score::filesystem::Path& prefix);
+        KvsArena* load_arena(size_t file_size) const;
+        score::ResultBlank write_binary_data(const std::string& buf, const score::filesystem::Path& bin_path);
+        score::ResultBlank sync_file(const score::filesystem::Path& path);
+        score::ResultBlank open_defaults(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file);
+        score::ResultBlank write_defaults_image(uint32_t source_hash, const score::filesystem::Path& image_path);
+        score::Result<KvsMap> open_kvs_file(const score::filesystem::Path& prefix, OpenJsonNeedFile need_file);
+        score::Result<std::string> wal_encode(WalOperation operation, const std::string_view key, const KvsValue* value);
+        score::Result<std::string> wal_encode_batch(const std::vector<std::pair<std::string_view, const KvsValue*>>& changes);
+        score::ResultBlank wal_write(const std::string& records);
+        score::ResultBlank wal_replay(KvsMap& data);
+        score::ResultBlank wal_apply(const WalRecord& record, KvsMap& data);
+        score::ResultBlank wal_truncate(size_t flushed_size); /* Keeps the records appended after the flush capture */
+        void wal_compact();
+        score::ResultBlank flush(KvsLockPolicy policy); /* The flush worker waits for the locks */
+        void flush_schedule(bool immediate);
+        void worker_start();
+        void worker_shutdown();
+        void worker_run();
 
 };
 
+/* Typed access (templates, see KvsValueConverter in kvsvalue.hpp) */
+template <typename T, typename>
+score::ResultBlank Kvs::set_value(const std::string_view key, T&& value) {
+    return set_value(key, KvsValueConverter<std::decay_t<T>>::make(std::forward<T>(value)));
+}
+
+template <typename T, typename>
+score::ResultBlank Kvs::set_value(const KvsKey& key, T&& value) {
+    return set_value(key, KvsValueConverter<std::decay_t<T>>::make(std::forward<T>(value)));
+}
+
+template <typename T, typename>
+score::ResultBlank Kvs::set_value(KvsKey&& key, T&& value) {
+    return set_value(std::move(key), KvsValueConverter<std::decay_t<T>>::make(std::forward<T>(value)));
+}
+
+template <typename... Args>
+score::ResultBlank Kvs::emplace_value(const std::string_view key, Args&&... args) {
+    return set_value(key, KvsValue(std::forward<Args>(args)...));
+}
+
+template <typename... Args>
+score::ResultBlank Kvs::emplace_value(const KvsKey& key, Args&&... args) {
+    return set_value(key, KvsValue(std::forward<Args>(args)...));
+}
+
+template <typename... Args>
+score::ResultBlank Kvs::emplace_value(KvsKey&& key, Args&&... args) {
+    return set_value(std::move(key), KvsValue(std::forward<Args>(args)...));
+}
+
+template <typename T>
+score::Result<T> Kvs::get_value_as(const std::string_view key) {
+    return get_value_as<T>(KvsKey(key));
+}
+
+template <typename T>
+score::Result<T> Kvs::get_value_as(const KvsKey& key) {
+    static_assert(KvsValueConverter<T>::readable, "get_value_as: type not readable by KvsValueConverter");
+    score::Result<T> result = score::MakeUnexpected(ErrorCode::InvalidValueType);
+    auto visit_res = visit_value(key, [&result](const KvsValue& value) {
+        T typed{};
+        if (KvsValueConverter<T>::read(value, typed)) {
+            result = std::move(typed);
+        }
+    });
+    if (!visit_res) {
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*visit_res.error()));
+    }
+
+    return result;
+}
+
 } /* namespace score::mw::per::kvs */
 
 #endif /* SCORE_LIB_KVS_KVS_HPP */
@@ -0,0 +1,95 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#include <memory>
+#include "kvs_compiled_defaults.hpp"
+
+namespace score::mw::per::kvs {
+
+/* Packed array from the element values, read with the member of the element type */
+template <typename T, typename Member>
+static KvsValue to_packed(const KvsCompiledValue* elements, size_t count, Member member) {
+    typename KvsPackedArray<T>::Storage packed;
+    packed.reserve(count);
+    for (size_t idx = 0; idx < count; ++idx) {
+        packed.push_back(static_cast<T>(elements[idx].*member));
+    }
+    return KvsValue(KvsPackedArray<T>(std::move(packed)));
+}
+
+KvsValue KvsCompiledValue::to_kvsvalue() const {
+    KvsValue result(nullptr);
+    switch (type) {
+        case KvsValue::Type::i32:
+            result = KvsValue(static_cast<int32_t>(integer));
+            break;
+        case KvsValue::Type::u32:
+            result = KvsValue(static_cast<uint32_t>(unsigned_integer));
+            break;
+        case KvsValue::Type::i64:
+            result = KvsValue(integer);
+            break;
+        case KvsValue::Type::u64:
+            result = KvsValue(unsigned_integer);
+            break;
+        case KvsValue::Type::f64:
+            result = KvsValue(number);
+            break;
+        case KvsValue::Type::Boolean:
+            result = KvsValue(0 != integer);
+            break;
+        case KvsValue::Type::String:
+            result = KvsValue(std::string(string));
+            break;
+        case KvsValue::Type::Bytes:
+            result = KvsValue(KvsValue::Bytes(reinterpret_cast<const uint8_t*>(string.data()), string.size()));
+            break;
+        case KvsValue::Type::Array: {
+            KvsValue::Array array;
+            array.reserve(count);
+            for (size_t idx = 0; idx < count; ++idx) {
+                array.push_back(elements[idx].to_kvsvalue());
+            }
+            result = KvsValue(std::move(array));
+            break;
+        }
+        case KvsValue::Type::Object: {
+            KvsValue::Object::Members object;
+            object.reserve(count);
+            for (size_t idx = 0; idx < count; ++idx) {
+                object.emplace_back(std::string(members[idx].key), members[idx].value.to_kvsvalue());
+            }
+            result = KvsValue(KvsValue::Object(std::move(object)));
+            break;
+        }
+        case KvsValue::Type::ArrayI32:
+            result = to_packed<int32_t>(elements, count, &KvsCompiledValue::integer);
+            break;
+        case KvsValue::Type::ArrayU32:
+            result = to_packed<uint32_t>(elements, count, &KvsCompiledValue::unsigned_integer);
+            break;
+        case KvsValue::Type::ArrayI64:
+            result = to_packed<int64_t>(elements, count, &KvsCompiledValue::integer);
+            break;
+        case KvsValue::Type::ArrayU64:
+            result = to_packed<uint64_t>(elements, count, &KvsCompiledValue::unsigned_integer);
+            break;
+        case KvsValue::Type::ArrayF64:
+            result = to_packed<double>(elements, count, &KvsCompiledValue::number);
+            break;
+        default:
+            break; /* Null */
+    }
+    return result;
+}
+
+} /* namespace score::mw::per::kvs */
@@ -0,0 +1,114 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+#ifndef SCORE_LIB_KVS_KVS_COMPILED_DEFAULTS_HPP
+#define SCORE_LIB_KVS_KVS_COMPILED_DEFAULTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "kvsvalue.hpp"
+
+namespace score::mw::per::kvs {
+
+struct KvsCompiledEntry;
+
+/**
+ * @brief Typed default value, stored in a constexpr table.
+ * Only the member(s) of the type are used, the others are zero.
+ */
+struct KvsCompiledValue {
+    KvsValue::Type type;
+    int64_t integer;                  ///< i32, i64 and bool (0 or 1)
+    uint64_t unsigned_integer;        ///< u32 and u64
+    double number;                    ///< f64
+    std::string_view string;          ///< str and bin (decoded bytes)
+    const KvsCompiledValue* elements; ///< arr and packed arrays (arr_i32 ... arr_f64)
+    const KvsCompiledEntry* members;  ///< obj
+    size_t count;                     ///< Number of elements or members
+
+    /* Create the KvsValue (deep copy of arrays and objects) */
+    KvsValue to_kvsvalue() const;
+};
+
+/* Key with its default value */
+struct KvsCompiledEntry {
+    std::string_view key;
+    KvsCompiledValue value;
+};
+
+/* Displacement of a bucket of the perfect hash */
+struct KvsCompiledDisplacement {
+    uint32_t d0;
+    uint32_t d1;
+};
+
+/* 64 bit FNV-1a hash with seed (offset basis) and a 64 bit finalizer, used by the generated tables.
+   FNV-1a alone spreads keys differing only in the last characters badly over the buckets */
+constexpr uint64_t kvs_compiled_hash(std::string_view key, uint64_t seed) {
+    uint64_t hash = seed;
+    for (const char c : key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001B3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @class KvsCompiledDefaults
+ * @brief Default values compiled into the binary by the kvs_compiled_defaults Bazel rule (kvs_defaults.bzl).
+ *
+ * The table is generated from a defaults JSON (same format as kvs_<id>_default.json) and has static storage duration,
+ * so using it as defaults source needs no file access and no allocation on open (see KvsBuilder::compiled_defaults).
+ *
+ * Lookup (minimal perfect hash, hash and displace): one hash of the key selects a bucket, the displacement
+ * of the bucket selects the slot, followed by a single key comparison.
+ *   hash = kvs_compiled_hash(key, seed), f1 = lower 32 bits, f2 = upper 32 bits
+ *   slot = (f1 + d0 * f2 + d1) % slot_count, with (d0, d1) = displacements[(f2 * bucket_count) >> 32]
+ * The bucket uses the upper bits of f2, so the keys of a bucket don't share f1 modulo the slot count.
+ */
+struct KvsCompiledDefaults {
+    const KvsCompiledEntry* slots;
+    size_t slot_count;
+    const KvsCompiledDisplacement* displacements;
+    size_t bucket_count;
+    uint64_t seed;
+
+    /* Returns the value of the key or nullptr */
+    constexpr const KvsCompiledValue* find(std::string_view key) const {
+        const KvsCompiledValue* result = nullptr;
+        if (slot_count > 0U) {
+            const uint64_t hash = kvs_compiled_hash(key, seed);
+            const uint64_t f1 = hash & 0xFFFFFFFFULL;
+            const uint64_t f2 = hash >> 32;
+            const KvsCompiledDisplacement& displacement = displacements[(f2 * bucket_count) >> 32];
+            const KvsCompiledEntry& entry = slots[(f1 + (displacement.d0 * f2) + displacement.d1) % slot_count];
+            if (entry.key == key) {
+                result = &entry.value;
+            }
+        }
+        return result;
+    }
+
+    constexpr size_t size() const {
+        return slot_count;
+    }
+};
+
+} /* namespace score::mw::per::kvs */
+
+#endif /* SCORE_LIB_KVS_KVS_COMPILED_DEFAULTS_HPP */
@@ -0,0 +1,56 @@
+# *******************************************************************************
+# Copyright (c) 2025 Contributors to the Eclipse Foundation
+#
+# See the NOTICE file(s) distributed with this work for additional
+# information regarding copyright ownership.
+#
+# This program and the accompanying materials are made available under the
+# terms of the Apache License Version 2.0 which is available at
+# https://www.apache.org/licenses/LICENSE-2.0
+#
+# SPDX-License-Identifier: Apache-2.0
+# *******************************************************************************
+
+"""Compile a KVS defaults JSON into a constexpr KvsCompiledDefaults table."""
+
+load("@rules_cc//cc:cc_library.bzl", "cc_library")
+
+def kvs_compiled_defaults(name, src, symbol = None, visibility = None, **kwargs):
+    """Generates a cc_library holding the default values of `src` as compiled table.
+
+    The library provides the header `<name>.hpp`, declaring the table
+    `extern const score::mw::per::kvs::KvsCompiledDefaults <symbol>;`
+    which is attached to a KVS with KvsBuilder::compiled_defaults().
+
+    Args:
+        name: Name of the cc_library (and of the generated files).
+        src: Defaults JSON file (kvs_<id>_default.json format).
+        symbol: Name of the table, defaults to `name`.
+        visibility: Visibility of the cc_library.
+        **kwargs: Further arguments of the cc_library.
+    """
+    symbol = symbol or name
+    header = name + ".hpp"
+    source = name + ".cpp"
+
+    native.genrule(
+        name = name + "_gen",
+        srcs = [src],
+        outs = [header, source],
+        cmd = "$(execpath //src/cpp/src:kvs_defaults_compiler) --input $(location {src}) --symbol {symbol} ".format(src = src, symbol = symbol) +
+              "--header $(location {header}) --header-include {header} --source $(location {source})".format(
+                  header = header,
+                  source = source,
+              ),
+        tools = ["//src/cpp/src:kvs_defaults_compiler"],
+    )
+
+    cc_library(
+        name = name,
+        srcs = [source],
+        hdrs = [header],
+        includes = ["."],
+        visibility = visibility,
+        deps = ["//src/cpp/src:kvs_compiled_defaults"],
+        **kwargs
+    )
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+
+# *******************************************************************************
+# Copyright (c) 2025 Contributors to the Eclipse Foundation
+#
+# See the NOTICE file(s) distributed with this work for additional
+# information regarding copyright ownership.
+#
+# This program and the accompanying materials are made available under the
+# terms of the Apache License Version 2.0 which is available at
+# https://www.apache.org/licenses/LICENSE-2.0
+#
+# SPDX-License-Identifier: Apache-2.0
+# *******************************************************************************
+
+"""
+Compile a KVS defaults JSON (kvs_<id>_default.json format) into a C++ header and
+translation unit holding a constexpr KvsCompiledDefaults table (kvs_compiled_defaults.hpp).
+
+The keys are placed with a minimal perfect hash (hash and displace), the hash function and
+slot computation must match KvsCompiledDefaults::find().
+"""
+
+import argparse
+import base64
+import binascii
+import bisect
+import json
+import math
+import sys
+from typing import Any
+
+FNV_PRIME = 0x100000001B3
+FNV_OFFSET_BASIS = 0xCBF29CE484222325
+MASK_64 = 0xFFFFFFFFFFFFFFFF
+MAX_SEEDS = 64
+# Average number of keys per bucket of the perfect hash
+BUCKET_SIZE = 4
+# Values of the displacement factor d0 tried per bucket, before the next seed is tried
+MAX_DISPLACEMENTS = 16
+
+INTEGER_RANGES = {
+    "i32": (-(2**31), 2**31 - 1),
+    "u32": (0, 2**32 - 1),
+    "i64": (-(2**63), 2**63 - 1),
+    "u64": (0, 2**64 - 1),
+}
+
+# Packed array tags with the KvsValue::Type, the elements are numbers of the tag suffix
+PACKED_ARRAYS = {
+    "arr_i32": "ArrayI32",
+    "arr_u32": "ArrayU32",
+    "arr_i64": "ArrayI64",
+    "arr_u64": "ArrayU64",
+    "arr_f64": "ArrayF64",
+}
+
+
+class CompileError(Exception):
+    pass
+
+
+def kvs_compiled_hash(key: bytes, seed: int) -> int:
+    """
+    64 bit FNV-1a with seed and finalizer, same as kvs_compiled_hash() in C++.
+    """
+    value = seed
+    for byte in key:
+        value ^= byte
+        value = (value * FNV_PRIME) & MASK_64
+    value ^= value >> 33
+    value = (value * 0xFF51AFD7ED558CCD) & MASK_64
+    value ^= value >> 33
+    value = (value * 0xC4CEB9FE1A85EC53) & MASK_64
+    value ^= value >> 33
+    return value
+
+
+def bucket_of(value: int, bucket_count: int) -> int:
+    # Upper bits of f2, independent of the slot: keys of a bucket must not share f1 modulo the slot count
+    return ((value >> 32) * bucket_count) >> 32
+
+
+def slot_of(value: int, d0: int, d1: int, slot_count: int) -> int:
+    f1 = value & 0xFFFFFFFF
+    f2 = value >> 32
+    return ((f1 + d0 * f2 + d1) & MASK_64) % slot_count
+
+
+def build_perfect_hash(keys: list[bytes]) -> tuple[int, list[tuple[int, int]], list[int]]:
+    """
+    Returns the seed, the displacement of each bucket and the key index of each slot.
+    A bucket whose displacement isn't found within the bounded search restarts with the next seed.
+    """
+    slot_count = len(keys)
+    bucket_count = max(1, math.ceil(slot_count / BUCKET_SIZE))
+    for attempt in range(MAX_SEEDS):
+        seed = (FNV_OFFSET_BASIS + attempt) & MASK_64
+        hashes = [kvs_compiled_hash(key, seed) for key in keys]
+        buckets: list[list[int]] = [[] for _ in range(bucket_count)]
+        for index, value in enumerate(hashes):
+            buckets[bucket_of(value, bucket_count)].append(index)
+
+        displacements = [(0, 0)] * bucket_count
+        slots = [-1] * slot_count
+        free = list(range(slot_count))
+        complete = True
+        # Place the largest buckets first, while most slots are free
+        for bucket in sorted(range(bucket_count), key=lambda b: len(buckets[b]), reverse=True):
+            members = buckets[bucket]
+            if not members:
+                continue
+            placed = False
+            # d0 is searched in a small bounded range, d1 is derived from the free slots: it moves the
+            # first key of the bucket to a free slot, so a bucket with a single key is placed at once.
+            # The free slots are tried from the first key's own slot on, so the free slots stay spread
+            for d0 in range(min(slot_count, MAX_DISPLACEMENTS)):
+                first = slot_of(hashes[members[0]], d0, 0, slot_count)
+                start = bisect.bisect_left(free, first)
+                for offset in range(len(free)):
+                    d1 = (free[(start + offset) % len(free)] - first) % slot_count
+                    candidate = {slot_of(hashes[i], d0, d1, slot_count) for i in members}
+                    if len(candidate) == len(members) and all(slots[s] < 0 for s in candidate):
+                        for i in members:
+                            slots[slot_of(hashes[i], d0, d1, slot_count)] = i
+                        for s in candidate:
+                            free.remove(s)
+                        displacements[bucket] = (d0, d1)
+                        placed = True
+                        break
+                if placed:
+                    break
+            if not placed:
+                complete = False
+                break
+        if complete:
+            return seed, displacements, slots
+    raise CompileError("no perfect hash found")
+
+
+def cpp_string(data: str) -> str:
+    """
+    C++ string_view literal (byte exact, independent of the source character set).
+    """
+    return cpp_bytes(data.encode("utf-8"))
+
+
+def cpp_bytes(data: bytes) -> str:
+    """
+    C++ string_view literal of raw bytes (str values and the decoded bin values).
+    """
+    out = []
+    for byte in data:
+        if byte in (0x22, 0x5C):
+            out.append("\\" + chr(byte))
+        elif 0x20 <= byte < 0x7F and byte != 0x3F:  # '?' escaped to avoid trigraphs
+            out.append(chr(byte))
+        else:
+            out.append("\\%03o" % byte)
+    return 'std::string_view("%s", %d)' % ("".join(out), len(data))
+
+
+def cpp_double(number: float) -> str:
+    if not math.isfinite(number):
+        raise CompileError("f64 value must be finite")
+    text = repr(number)
+    if "." not in text and "e" not in text and "inf" not in text:
+        text += ".0"
+    return text
+
+
+def cpp_int64(number: int) -> str:
+    if number == -(2**63):
+        return "(-9223372036854775807LL - 1)"
+    return "%dLL" % number
+
+
+class Generator:
+    def __init__(self) -> None:
+        self.definitions: list[str] = []
+
+    def add_array(self, ctype: str, items: list[str]) -> str:
+        name = "kvs_defaults_%d" % len(self.definitions)
+        self.definitions.append(
+            "constexpr %s %s[] = {\n    %s,\n};\n" % (ctype, name, ",\n    ".join(items))
+        )
+        return name
+
+    def value(self, typed: Any, path: str) -> str:
+        """
+        C++ initializer of a KvsCompiledValue for a {"t": .., "v": ..} object.
+        """
+        if not isinstance(typed, dict) or "t" not in typed or "v" not in typed:
+            raise CompileError('%s: expected {"t": ..., "v": ...}' % path)
+        tag = typed["t"]
+        value = typed["v"]
+        integer, unsigned, number, string, elements, members, count = "0", "0U", "0.0", "{}", "nullptr", "nullptr", "0U"
+        if tag in INTEGER_RANGES:
+            if isinstance(value, float) and value.is_integer():
+                value = int(value)
+            if isinstance(value, bool) or not isinstance(value, int):
+                raise CompileError("%s: %s value must be an integer" % (path, tag))
+            low, high = INTEGER_RANGES[tag]
+            if not low <= value <= high:
+                raise CompileError("%s: %s value out of range" % (path, tag))
+            if tag.startswith("u"):
+                unsigned = "%dULL" % value
+            else:
+                integer = cpp_int64(value)
+            ctype = tag
+        elif tag == "f64":
+            if isinstance(value, bool) or not isinstance(value, (int, float)):
+                raise CompileError("%s: f64 value must be a number" % path)
+            number = cpp_double(float(value))
+            ctype = "f64"
+        elif tag == "bool":
+            if not isinstance(value, bool):
+                raise CompileError("%s: bool value must be true or false" % path)
+            integer = "1" if value else "0"
+            ctype = "Boolean"
+        elif tag == "str":
+            if not isinstance(value, str):
+                raise CompileError("%s: str value must be a string" % path)
+            string = cpp_string(value)
+            ctype = "String"
+        elif tag == "bin":
+            if not isinstance(value, str):
+                raise CompileError("%s: bin value must be a base64 string" % path)
+            try:
+                payload = base64.b64decode(value, validate=True)
+            except binascii.Error as error:
+                raise CompileError("%s: bin value must be a base64 string" % path) from error
+            string = cpp_bytes(payload)
+            ctype = "Bytes"
+        elif tag == "null":
+            if value is not None:
+                raise CompileError("%s: null value must be null" % path)
+            ctype = "Null"
+        elif tag == "arr":
+            if not isinstance(value, list):
+                raise CompileError("%s: arr value must be an array" % path)
+            items = [self.value(item, "%s[%d]" % (path, i)) for i, item in enumerate(value)]
+            if items:
+                elements = self.add_array("KvsCompiledValue", items)
+            count = "%dU" % len(items)
+            ctype = "Array"
+        elif tag in PACKED_ARRAYS:
+            if not isinstance(value, list):
+                raise CompileError("%s: %s value must be an array" % (path, tag))
+            element_tag = tag[len("arr_"):]
+            items = [self.value({"t": element_tag, "v": item}, "%s[%d]" % (path, i)) for i, item in enumerate(value)]
+            if items:
+                elements = self.add_array("KvsCompiledValue", items)
+            count = "%dU" % len(items)
+            ctype = PACKED_ARRAYS[tag]
+        elif tag == "obj":
+            if not isinstance(value, dict):
+                raise CompileError("%s: obj value must be an object" % path)
+            items = [
+                "{%s, %s}" % (cpp_string(key), self.value(item, "%s.%s" % (path, key))) for key, item in value.items()
+            ]
+            if items:
+                members = self.add_array("KvsCompiledEntry", items)
+            count = "%dU" % len(items)
+            ctype = "Object"
+        else:
+            raise CompileError("%s: unknown type tag %r" % (path, tag))
+        return "{KvsValue::Type::%s, %s, %s, %s, %s, %s, %s, %s}" % (
+            ctype, integer, unsigned, number, string, elements, members, count
+        )
+
+
+def reject_constant(name: str) -> None:
+    raise CompileError("invalid JSON number %s" % name)
+
+
+def compile_defaults(defaults_json: str, symbol: str, header_include: str, source: str) -> tuple[str, str]:
+    data = json.loads(defaults_json, parse_constant=reject_constant)
+    if not isinstance(data, dict):
+        raise CompileError("defaults JSON must be an object")
+
+    generator = Generator()
+    keys = list(data.keys())
+    values = [generator.value(data[key], key) for key in keys]
+    seed, displacements, slots = build_perfect_hash([key.encode("utf-8") for key in keys])
+
+    table_slots = "nullptr"
+    table_displacements = "nullptr"
+    if keys:
+        table_slots = generator.add_array(
+            "KvsCompiledEntry", ["{%s, %s}" % (cpp_string(keys[i]), values[i]) for i in slots]
+        )
+        table_displacements = generator.add_array(
+            "KvsCompiledDisplacement", ["{%dU, %dU}" % displacement for displacement in displacements]
+        )
+
+    guard = "KVS_COMPILED_DEFAULTS_%s_HPP" % symbol.upper()
+    banner = "/* Generated by kvs_defaults_compiler.py from %s, do not edit */\n" % source
+    header = (
+        banner
+        + "#ifndef %s\n#define %s\n\n" % (guard, guard)
+        + '#include "kvs_compiled_defaults.hpp"\n\n'
+        + "extern const score::mw::per::kvs::KvsCompiledDefaults %s;\n\n" % symbol
+        + "#endif /* %s */\n" % guard
+    )
+    source_code = (
+        banner
+        + '#include "%s"\n\n' % header_include
+        + "namespace {\n\n"
+        + "using score::mw::per::kvs::KvsCompiledDisplacement;\n"
+        + "using score::mw::per::kvs::KvsCompiledEntry;\n"
+        + "using score::mw::per::kvs::KvsCompiledValue;\n"
+        + "using score::mw::per::kvs::KvsValue;\n\n"
+        + "\n".join(generator.definitions)
+        + "\n} /* namespace */\n\n"
+        + "extern const score::mw::per::kvs::KvsCompiledDefaults %s = {\n" % symbol
+        + "    %s, %dU, %s, %dU, 0x%016XULL,\n};\n"
+        % (table_slots, len(keys), table_displacements, len(displacements) if keys else 0, seed)
+    )
+    return header, source_code
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--input", required=True, help="defaults JSON file")
+    parser.add_argument("--symbol", required=True, help="name of the generated KvsCompiledDefaults table")
+    parser.add_argument("--header", required=True, help="generated header file")
+    parser.add_argument("--header-include", required=True, help="include path of the generated header")
+    parser.add_argument("--source", required=True, help="generated source file")
+    args = parser.parse_args()
+
+    with open(args.input, encoding="utf-8") as file:
+        defaults_json = file.read()
+    try:
+        header, source_code = compile_defaults(defaults_json, args.symbol, args.header_include, args.input)
+    except (CompileError, ValueError) as error:
+        print("%s: error: %s" % (args.input, error), file=sys.stderr)
+        return 1
+
+    with open(args.header, "w", encoding="utf-8") as file:
+        file.write(header)
+    with open(args.source, "w", encoding="utf-8") as file:
+        file.write(source_code)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
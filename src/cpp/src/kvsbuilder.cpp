@@ -37,6 +37,71 @@ KvsBuilder& KvsBuilder::dir(std::string&& dir_path) {
     return *this;
 }
 
+KvsBuilder& KvsBuilder::wal_flag(bool flag) {
+    options.wal_enabled = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::wal_compaction_threshold(size_t threshold) {
+    options.wal_compaction_threshold = threshold;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::storage_format(KvsStorageFormat format) {
+    options.storage_format = format;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::compiled_defaults(const KvsCompiledDefaults& defaults) {
+    options.compiled_defaults = &defaults;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::snapshot_max_count(size_t count) {
+    options.snapshot_max_count = count;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::lock_policy(KvsLockPolicy policy) {
+    options.lock_policy = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::lock_timeout(std::chrono::milliseconds timeout) {
+    options.lock_timeout = timeout;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::read_mostly_flag(bool flag) {
+    options.read_mostly = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::load_arena_flag(bool flag) {
+    options.load_arena = flag;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::shard_count(size_t count) {
+    options.shard_count = count;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::flush_policy(KvsFlushPolicy policy) {
+    options.flush_policy = policy;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::flush_delay(std::chrono::milliseconds delay) {
+    options.flush_delay = delay;
+    return *this;
+}
+
+KvsBuilder& KvsBuilder::flush_change_count(size_t count) {
+    options.flush_change_count = count;
+    return *this;
+}
+
 
 score::Result<Kvs> KvsBuilder::build() {
     score::Result<Kvs> result = score::MakeUnexpected(ErrorCode::UnmappedError);
@@ -50,7 +115,8 @@ score::Result<Kvs> KvsBuilder::build() {
         instance_id,
         need_defaults ? OpenNeedDefaults::Required : OpenNeedDefaults::Optional,
         need_kvs      ? OpenNeedKvs::Required      : OpenNeedKvs::Optional,
-        std::move(directory)
+        std::move(directory),
+        options
     );
 
     return result;
@@ -87,6 +87,112 @@ public:
      */
     KvsBuilder& dir(std::string&& dir_path);
 
+    /**
+     * @brief Enable the write-ahead log.
+     * Changes are appended to a log file on every write and replayed on open,
+     * so they survive without calling flush().
+     * @param flag True to enable the write-ahead log; false (default) to disable it.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& wal_flag(bool flag);
+
+    /**
+     * @brief Set the write-ahead log size which triggers a compaction (flush).
+     * @param threshold Log size in bytes (default: KVS_WAL_COMPACTION_THRESHOLD).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& wal_compaction_threshold(size_t threshold);
+
+    /**
+     * @brief Select the storage format written by flush().
+     * Files of the other format are still read, if no file of the selected format exists.
+     * @param format KvsStorageFormat::Json (default) or KvsStorageFormat::Binary.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& storage_format(KvsStorageFormat format);
+
+    /**
+     * @brief Use default values compiled into the binary instead of the defaults files.
+     * The table is generated from a defaults JSON by the kvs_compiled_defaults Bazel rule (kvs_defaults.bzl),
+     * opening the KVS then doesn't read kvs_<id>_default.json. need_defaults_flag is fulfilled by the table.
+     * @param defaults Generated table (static storage duration, must outlive the KVS).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& compiled_defaults(const KvsCompiledDefaults& defaults);
+
+    /**
+     * @brief Set the maximum number of snapshots kept besides the current KVS file.
+     * Older snapshots are removed by flush(). With 0 no history is kept and snapshot_restore() always fails.
+     * @param count Maximum snapshot count (default: KVS_MAX_SNAPSHOTS).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& snapshot_max_count(size_t count);
+
+    /**
+     * @brief Select how the KVS functions behave, if the KVS is locked by another thread.
+     * Reading functions share the KVS with each other, so only writers (and readers waiting for a writer) are affected.
+     * @param policy KvsLockPolicy::Try (default, fail with MutexLockFailed), KvsLockPolicy::Timed or KvsLockPolicy::Blocking.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& lock_policy(KvsLockPolicy policy);
+
+    /**
+     * @brief Set the maximum wait time of KvsLockPolicy::Timed.
+     * @param timeout Wait time (default: KVS_LOCK_TIMEOUT_MS).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& lock_timeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Enable the read-mostly mode.
+     * get_value, key_exists and get_all_keys then read without any lock (independent of the lock policy),
+     * every change publishes a new immutable version of the KVS data.
+     * @param flag True to enable the read-mostly mode; false (default) to disable it.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& read_mostly_flag(bool flag);
+
+    /**
+     * @brief Load the KVS and defaults files into an arena.
+     * The loaded data is allocated in one chunk sized from the file length instead of one heap allocation
+     * per map entry and array/object, and freed at once after reset() or snapshot_restore() replaced it.
+     * @param flag True to use the load arena; false (default) for heap allocations.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& load_arena_flag(bool flag);
+
+    /**
+     * @brief Set the number of independently locked shards of the KVS data.
+     * Changes of keys in different shards run in parallel, functions on the complete data
+     * (get_all_keys, flush, reset, snapshot_restore) lock all shards.
+     * @param count Shard count (default: 1, the KVS data is locked as a whole).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& shard_count(size_t count);
+
+    /**
+     * @brief Select when the KVS data is flushed.
+     * With KvsFlushPolicy::Background a worker thread flushes the changes, so the writing threads don't wait for storage.
+     * Use Kvs::wait_durable() to wait for a change to be persisted.
+     * @param policy KvsFlushPolicy::Manual (default) or KvsFlushPolicy::Background.
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& flush_policy(KvsFlushPolicy policy);
+
+    /**
+     * @brief Set the delay of KvsFlushPolicy::Background from the first change to the flush (all changes meanwhile are coalesced).
+     * @param delay Flush delay (default: KVS_FLUSH_DELAY_MS).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& flush_delay(std::chrono::milliseconds delay);
+
+    /**
+     * @brief Set the number of changes after which KvsFlushPolicy::Background flushes before the delay expired.
+     * @param count Change count (default: 0, only the delay is used).
+     * @return Reference to this builder (for chaining).
+     */
+    KvsBuilder& flush_change_count(size_t count);
+
     /**
      * @brief Builds and opens the Kvs instance with the configured options.
      *
@@ -101,6 +207,7 @@ private:
     bool                               need_defaults; ///< Whether default values are required
     bool                               need_kvs;      ///< Whether an existing KVS is required
     std::string                        directory;     ///< Directory where to store the KVS Files
+    KvsOptions                         options;       ///< Optional settings (e.g. write-ahead log)
 };
 
 } /* namespace score::mw::per::kvs */
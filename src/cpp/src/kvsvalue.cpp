@@ -14,80 +14,33 @@
 
 namespace score::mw::per::kvs {
 
-KvsValue::KvsValue(const Array& array){
-    Array shared_array;
-    shared_array.reserve(array.size());
-    for (const auto& item : array) {
-        shared_array.push_back(std::make_shared<KvsValue>(*item));
-    }
-    value = std::move(shared_array);
-    type = Type::Array;
-}
-
-KvsValue::KvsValue(const Object& object) {
-    Object shared_object;
-    for (const auto& [key, value] : object) {
-        shared_object[key] = std::make_shared<KvsValue>(*value);
-    }
-    value = std::move(shared_object);
-    type = Type::Object;
+/* The members are sorted once */
+KvsValue::KvsValue(const std::unordered_map<std::string, KvsValue>& object)
+    : value(Object(std::vector<Object::value_type>(object.begin(), object.end())))
+    , type(Type::Object)
+{
 }
 
-KvsValue::KvsValue(const std::vector<KvsValue>& array) {
-    Array shared_array;
-    shared_array.reserve(array.size());  // Reserve space for N elements
-    for (const auto& item : array) {
-        shared_array.emplace_back(std::make_shared<KvsValue>(item));
+KvsValue::KvsValue(const std::vector<std::shared_ptr<KvsValue>>& array)
+    : type(Type::Array)
+{
+    Array elements;
+    elements.reserve(array.size());
+    for (const auto& element : array) {
+        elements.push_back((nullptr != element) ? *element : KvsValue(nullptr));
     }
-    value = std::move(shared_array);
-    type = Type::Array;
+    value = std::move(elements);
 }
 
-KvsValue::KvsValue(const std::unordered_map<std::string, KvsValue>& object) {
-    Object shared_object;
-    for (const auto& [key, value] : object) {
-        shared_object[key] = std::make_shared<KvsValue>(value);
+KvsValue::KvsValue(const std::unordered_map<std::string, std::shared_ptr<KvsValue>>& object)
+    : type(Type::Object)
+{
+    std::vector<Object::value_type> members;
+    members.reserve(object.size());
+    for (const auto& [key, member] : object) {
+        members.emplace_back(key, (nullptr != member) ? *member : KvsValue(nullptr));
     }
-    value = std::move(shared_object);
-    type = Type::Object;
-}
-
-/* copy constructor */
-KvsValue::KvsValue(const KvsValue& other) : type(other.type) {
-    switch(other.type){
-        case Type::Array:{
-            const Array& otherArray = std::get<Array>(other.value);
-            Array copiedArray;
-            copiedArray.reserve(otherArray.size());
-            for (const auto& item : otherArray) {
-                copiedArray.push_back(std::make_shared<KvsValue>(*item));
-            }
-            value = std::move(copiedArray);
-            break;
-        }
-        case Type::Object:{
-            const Object& otherObject = std::get<Object>(other.value);
-            Object copiedObject;
-            for (const auto& [key, value] : otherObject) {
-                copiedObject[key] = std::make_shared<KvsValue>(*value);
-            }
-            value = std::move(copiedObject);
-            break;
-        }
-        default:
-            value = other.value; // For other types, just copy the value
-            break;
-    }
-}
-
-/* copy Assignment Operator */
-KvsValue& KvsValue::operator=(const KvsValue& other) {
-    if (this != &other) {
-        KvsValue temp(other); // deep copy
-        std::swap(value, temp.value);
-        type = other.type;
-    }
-    return *this;
+    value = Object(std::move(members));
 }
 
 /* move Assignment Operator */
@@ -99,4 +52,9 @@ KvsValue& KvsValue::operator=(KvsValue&& other) noexcept {
     return *this;
 }
 
+/* Equality Operator (arrays and objects compare their elements, objects are sorted by key) */
+bool KvsValue::operator==(const KvsValue& other) const {
+    return (type == other.type) && (value == other.value);
+}
+
 } /* end namespace score::mw::per::kvs */
\ No newline at end of file
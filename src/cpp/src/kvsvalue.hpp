@@ -13,14 +13,231 @@
 #ifndef SCORE_LIB_KVS_KVSVALUE_HPP
 #define SCORE_LIB_KVS_KVSVALUE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
+#include "internal/kvs_arena.hpp"
 
 namespace score::mw::per::kvs {
 
+class KvsValue;
+
+/* Copy-on-write storage without another owner. use_count() is a relaxed load: the fence orders the following
+   changes after the reads of an owner which concurrently dropped its reference */
+template <typename T>
+inline bool kvs_storage_unique(const std::shared_ptr<T>& storage) {
+    const bool unique = (1 == storage.use_count());
+    if (unique) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return unique;
+}
+
+/**
+ * @class KvsArray
+ * @brief Elements of an array KvsValue (KvsValue::Array).
+ *
+ * The elements are shared between copies (copy-on-write): copying an array only increments a reference
+ * count. Functions which may change the elements (non-const access, insertions) first copy shared elements.
+ * This copy is shallow, nested arrays and objects stay shared, so a change copies only the changed path.
+ *
+ * Mutable references and iterators (non-const begin, operator[], back, emplace_back) stay valid like those
+ * of a std::vector: after they were handed out, the array doesn't share its elements anymore, copies of it
+ * copy the elements (until clear() or an assignment). Like std containers, an array must not be copied
+ * while another thread changes it, different copies may be used by different threads.
+ */
+class KvsArray final {
+public:
+    using value_type = KvsValue;
+    /* Element storage, allocated with KvsAllocator (in the load arena if constructed with its allocator) */
+    using Elements = std::vector<KvsValue, KvsAllocator<KvsValue>>;
+    using iterator = Elements::iterator;
+    using const_iterator = Elements::const_iterator;
+
+    KvsArray() = default;
+    KvsArray(std::initializer_list<KvsValue> init);
+    explicit KvsArray(const std::vector<KvsValue>& init);
+    explicit KvsArray(std::vector<KvsValue>&& init);
+    /* Elements are taken over with their allocator (e.g. parsed in the load arena) */
+    explicit KvsArray(Elements&& init);
+    KvsArray(const KvsArray& other);
+    KvsArray(KvsArray&& other) noexcept = default;
+    KvsArray& operator=(const KvsArray& other);
+    KvsArray& operator=(KvsArray&& other) noexcept = default;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    iterator begin();
+    iterator end();
+    size_t size() const;
+    bool empty() const;
+    const KvsValue& operator[](size_t idx) const;
+    KvsValue& operator[](size_t idx);
+    const KvsValue& back() const;
+    KvsValue& back();
+
+    void reserve(size_t count);
+    void clear();
+    void push_back(const KvsValue& value);
+    void push_back(KvsValue&& value);
+    template <typename... Args>
+    KvsValue& emplace_back(Args&&... args);
+
+    bool operator==(const KvsArray& other) const;
+    bool operator!=(const KvsArray& other) const;
+
+private:
+    const Elements& items() const;
+    /* Unshare the elements before a change */
+    Elements& detach();
+    /* Unshare the elements for a mutable reference or iterator, copies then don't share them */
+    Elements& expose();
+
+    std::shared_ptr<Elements> elements; /* nullptr: no elements */
+    bool exposed = false;               /* Mutable references were handed out */
+};
+
+/**
+ * @class KvsObject
+ * @brief Members of an object KvsValue (KvsValue::Object), stored as flat vector of key-value pairs sorted by key.
+ *
+ * Provides the map functions used for objects (find, at, count, emplace, insert_or_assign, erase and
+ * iteration in key order). All members are stored in one allocation without a node per member, lookups
+ * are binary searches. Appending members in key order (e.g. parsing a value written by the KVS) takes
+ * constant time, other insertions move the following members.
+ * Like KvsArray, the members are shared between copies (copy-on-write), with the same rules for mutable
+ * references and iterators (non-const begin, find, at, and the iterators returned by emplace and insert_or_assign).
+ */
+class KvsObject final {
+public:
+    using value_type = std::pair<std::string, KvsValue>;
+    using Members = std::vector<value_type, KvsAllocator<value_type>>;
+    using iterator = Members::iterator;
+    using const_iterator = Members::const_iterator;
+
+    KvsObject() = default;
+    KvsObject(std::initializer_list<value_type> init);
+    /* Members in any order, for duplicate keys the last member is used */
+    explicit KvsObject(std::vector<value_type>&& init);
+    /* Members in key order (e.g. parsed from a KVS file) are taken over with their allocator without sorting */
+    explicit KvsObject(Members&& init);
+    KvsObject(const KvsObject& other);
+    KvsObject(KvsObject&& other) noexcept = default;
+    KvsObject& operator=(const KvsObject& other);
+    KvsObject& operator=(KvsObject&& other) noexcept = default;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    iterator begin();
+    iterator end();
+    size_t size() const;
+    bool empty() const;
+    void reserve(size_t count);
+    void clear();
+
+    const_iterator find(std::string_view key) const;
+    iterator find(std::string_view key);
+    size_t count(std::string_view key) const;
+    /* Throws std::out_of_range, if the key doesn't exist (like std::unordered_map::at) */
+    const KvsValue& at(std::string_view key) const;
+    KvsValue& at(std::string_view key);
+
+    /* Inserts the member, if the key doesn't exist (like std::unordered_map::emplace) */
+    std::pair<iterator, bool> emplace(std::string key, KvsValue value);
+    /* Inserts the member or replaces the value of an existing key */
+    std::pair<iterator, bool> insert_or_assign(std::string key, KvsValue value);
+    size_t erase(std::string_view key);
+
+    bool operator==(const KvsObject& other) const;
+    bool operator!=(const KvsObject& other) const;
+
+private:
+    const Members& items() const;
+    Members& detach();
+    Members& expose();
+    /* Position of the key in the unshared members */
+    iterator insert_position(const std::string& key, bool& exists);
+    /* Sorts the members by key, for duplicate keys the last member is kept */
+    template <typename Vector>
+    static void sort_members(Vector& init);
+
+    std::shared_ptr<Members> members; /* nullptr: no members */
+    bool exposed = false;             /* Mutable references were handed out */
+};
+
+/**
+ * @class KvsPackedArray
+ * @brief Elements of a homogeneous number array or binary KvsValue, stored contiguously.
+ *
+ * Large tables of one number type (e.g. calibration maps of doubles) use 8 bytes per double instead of a
+ * KvsValue per element. They are serialized as one JSON array without per-element type tags and as one
+ * block in the binary format. data() and size() give direct access to the elements (like std::span).
+ * Like KvsArray, the elements are shared between copies (copy-on-write), non-const data() first copies
+ * shared elements, copies made after it copy the elements. The elements are a std::vector<T> (not allocated by KvsAllocator), so a vector
+ * passed as rvalue is taken over without a copy.
+ */
+template <typename T>
+class KvsPackedArray final {
+public:
+    using value_type = T;
+    using Storage = std::vector<T>;
+    using const_iterator = const T*;
+
+    KvsPackedArray() = default;
+    KvsPackedArray(const T* data, size_t size);
+    KvsPackedArray(std::initializer_list<T> init);
+    explicit KvsPackedArray(const Storage& init);
+    /* Take ownership of the elements without a copy (e.g. for parsers and KvsValueConverter) */
+    explicit KvsPackedArray(Storage&& init);
+    KvsPackedArray(const KvsPackedArray& other);
+    KvsPackedArray(KvsPackedArray&& other) noexcept = default;
+    KvsPackedArray& operator=(const KvsPackedArray& other);
+    KvsPackedArray& operator=(KvsPackedArray&& other) noexcept = default;
+
+    const T* data() const;
+    T* data();
+    size_t size() const;
+    bool empty() const;
+    const T& operator[](size_t idx) const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    /* Copy of the elements (e.g. for KvsValueConverter) */
+    std::vector<T> to_vector() const;
+
+    void assign(const T* data, size_t size);
+    /* Resizes the unshared elements (new elements are zero), e.g. to read a payload directly into data() */
+    void resize(size_t size);
+    void clear();
+
+    bool operator==(const KvsPackedArray& other) const;
+    bool operator!=(const KvsPackedArray& other) const;
+
+private:
+    const Storage& items() const;
+    Storage& detach();
+
+    std::shared_ptr<Storage> elements; /* nullptr: no elements */
+    bool exposed = false;              /* data() was handed out */
+};
+
+/**
+ * @brief Contents of a binary KvsValue (KvsValue::Bytes).
+ *
+ * Opaque payloads (e.g. calibration blobs) are stored at raw size in the binary format (base64 in JSON files).
+ */
+using KvsBytes = KvsPackedArray<uint8_t>;
+
 /* Define the KvsValue class*/
 /**
  * @class KvsValue
@@ -36,8 +253,13 @@ namespace score::mw::per::kvs {
  * - Boolean (bool)
  * - String (std::string)
  * - Null (std::nullptr_t)
- * - Array (std::vector<KvsValue>)
- * - Object (std::unordered_map<std::string, KvsValue>)
+ * - Array (KvsArray, elements in a vector)
+ * - Object (KvsObject, members sorted by key)
+ * - Bytes (KvsBytes, contiguous binary data)
+ * - ArrayI32, ArrayU32, ArrayI64, ArrayU64, ArrayF64 (KvsPackedArray, contiguous numbers of one type)
+ *
+ * Arrays and objects store their elements inline (no allocation per element) and share them between
+ * copies (copy-on-write), so copying an array or object takes constant time.
  *
  * ## Public Methods:
  * - `KvsValue(double number)`: Constructs a KvsValue holding a number.
@@ -59,8 +281,14 @@ namespace score::mw::per::kvs {
 class KvsValue final {
 public:
     /* Define the possible types for KvsValue*/
-    using Array = std::vector<std::shared_ptr<KvsValue>>;
-    using Object = std::unordered_map<std::string, std::shared_ptr<KvsValue>>;
+    using Array = KvsArray;
+    using Object = KvsObject;
+    using Bytes = KvsBytes;
+    using ArrayI32 = KvsPackedArray<int32_t>;
+    using ArrayU32 = KvsPackedArray<uint32_t>;
+    using ArrayI64 = KvsPackedArray<int64_t>;
+    using ArrayU64 = KvsPackedArray<uint64_t>;
+    using ArrayF64 = KvsPackedArray<double>;
 
     /* Enum to represent the type of the value*/
     enum class Type {
@@ -73,7 +301,13 @@ public:
         String,
         Null,
         Array,
-        Object
+        Object,
+        Bytes,
+        ArrayI32,
+        ArrayU32,
+        ArrayI64,
+        ArrayU64,
+        ArrayF64
     };
 
     /* Constructors for each type*/
@@ -85,17 +319,34 @@ public:
     explicit KvsValue(bool boolean) : value(boolean), type(Type::Boolean) {}
     explicit KvsValue(const char* str) : value(std::string(str)), type(Type::String) {}
     explicit KvsValue(const std::string& str) : value(str), type(Type::String) {}
+    explicit KvsValue(std::string&& str) : value(std::move(str)), type(Type::String) {}
     explicit KvsValue(std::nullptr_t) : value(nullptr), type(Type::Null) {}
-    explicit KvsValue(const Array& array) ;
-    explicit KvsValue(const Object& object);
-    explicit KvsValue(const std::vector<KvsValue>& array);
+    explicit KvsValue(const Array& array) : value(array), type(Type::Array) {}
+    explicit KvsValue(const Object& object) : value(object), type(Type::Object) {}
+    /* Take ownership of the elements without a copy (e.g. for parsers building new values)*/
+    explicit KvsValue(Array&& array) : value(std::move(array)), type(Type::Array) {}
+    explicit KvsValue(Object&& object) : value(std::move(object)), type(Type::Object) {}
+    explicit KvsValue(const std::vector<KvsValue>& array) : value(Array(array)), type(Type::Array) {}
+    explicit KvsValue(std::vector<KvsValue>&& array) : value(Array(std::move(array))), type(Type::Array) {}
     explicit KvsValue(const std::unordered_map<std::string, KvsValue>& object);
+    /* Former Array and Object types, the elements are copied (a nullptr element becomes a Null value) */
+    [[deprecated("use KvsValue::Array or std::vector<KvsValue>")]]
+    explicit KvsValue(const std::vector<std::shared_ptr<KvsValue>>& array);
+    [[deprecated("use KvsValue::Object or std::unordered_map<std::string, KvsValue>")]]
+    explicit KvsValue(const std::unordered_map<std::string, std::shared_ptr<KvsValue>>& object);
+    explicit KvsValue(const Bytes& bytes) : value(bytes), type(Type::Bytes) {}
+    explicit KvsValue(Bytes&& bytes) : value(std::move(bytes)), type(Type::Bytes) {}
+    explicit KvsValue(ArrayI32 array) : value(std::move(array)), type(Type::ArrayI32) {}
+    explicit KvsValue(ArrayU32 array) : value(std::move(array)), type(Type::ArrayU32) {}
+    explicit KvsValue(ArrayI64 array) : value(std::move(array)), type(Type::ArrayI64) {}
+    explicit KvsValue(ArrayU64 array) : value(std::move(array)), type(Type::ArrayU64) {}
+    explicit KvsValue(ArrayF64 array) : value(std::move(array)), type(Type::ArrayF64) {}
 
-    /* Copy constructor */
-    KvsValue(const KvsValue& other);
+    /* Copy constructor (arrays and objects are shared) */
+    KvsValue(const KvsValue& other) = default;
 
     /* copy assignment operator */
-    KvsValue& operator=(const KvsValue& other);
+    KvsValue& operator=(const KvsValue& other) = default;
 
     /* Move constructor */
     KvsValue(KvsValue&& other) noexcept : value(std::move(other.value)), type(other.type) {}
@@ -103,22 +354,573 @@ public:
     /* move assignment operator */
     KvsValue& operator=(KvsValue&& other) noexcept;
 
+    /* Equality operators (deep comparison of arrays and objects, unless they are shared)*/
+    bool operator==(const KvsValue& other) const;
+    bool operator!=(const KvsValue& other) const { return !(*this == other); }
+
     /* Get the type of the value*/
     Type getType() const { return type; }
 
+    /* The underlying value type */
+    using Variant = std::variant<int32_t, uint32_t, int64_t, uint64_t, double, bool, std::string, std::nullptr_t, Array, Object, Bytes,
+                                 ArrayI32, ArrayU32, ArrayI64, ArrayU64, ArrayF64>;
+
     /* Access the underlying value (use std::get to retrieve the value)*/
-    const std::variant<int32_t, uint32_t, int64_t, uint64_t, double, bool, std::string, std::nullptr_t, Array, Object>& getValue() const {
+    const Variant& getValue() const {
         return value;
     }
 
 private:
     /* The underlying value*/
-    std::variant<int32_t, uint32_t, int64_t, uint64_t, double, bool, std::string, std::nullptr_t, Array, Object> value;
+    Variant value;
 
     /* The type of the value*/
     Type type;
 };
 
+/* Keys and values of the KVS, the map nodes are allocated with KvsAllocator (in the load arena for a loaded map) */
+using KvsMap = std::unordered_map<std::string, KvsValue, std::hash<std::string>, std::equal_to<std::string>,
+                                  KvsAllocator<std::pair<const std::string, KvsValue>>>;
+
+/* KvsArray functions (need the complete KvsValue) */
+inline KvsArray::KvsArray(std::initializer_list<KvsValue> init)
+{
+    if (0U != init.size()) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>(), init.begin(), init.end());
+    }
+}
+
+inline KvsArray::KvsArray(const std::vector<KvsValue>& init)
+{
+    if (!init.empty()) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>(), init.begin(), init.end());
+    }
+}
+
+inline KvsArray::KvsArray(std::vector<KvsValue>&& init)
+{
+    if (!init.empty()) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>(), std::make_move_iterator(init.begin()),
+                                                  std::make_move_iterator(init.end()));
+    }
+}
+
+inline KvsArray::KvsArray(Elements&& init)
+{
+    if (!init.empty()) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>(init.get_allocator()), std::move(init));
+    }
+}
+
+inline const KvsArray::Elements& KvsArray::items() const {
+    static const Elements none;
+    return elements ? *elements : none;
+}
+
+inline KvsArray::KvsArray(const KvsArray& other)
+    : elements((other.exposed && other.elements) ? std::allocate_shared<Elements>(KvsAllocator<Elements>(), *other.elements)
+                                                 : other.elements)
+{
+}
+
+inline KvsArray& KvsArray::operator=(const KvsArray& other) {
+    if (this != &other) {
+        *this = KvsArray(other);
+    }
+    return *this;
+}
+
+inline KvsArray::Elements& KvsArray::detach() {
+    if (!elements) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>());
+    }else if (!kvs_storage_unique(elements)) {
+        elements = std::allocate_shared<Elements>(KvsAllocator<Elements>(), *elements); /* Copies the element handles only */
+    }
+    return *elements;
+}
+
+inline KvsArray::Elements& KvsArray::expose() {
+    Elements& unshared = detach();
+    exposed = true;
+    return unshared;
+}
+
+inline KvsArray::const_iterator KvsArray::begin() const { return items().begin(); }
+inline KvsArray::const_iterator KvsArray::end() const { return items().end(); }
+inline KvsArray::iterator KvsArray::begin() { return expose().begin(); }
+inline KvsArray::iterator KvsArray::end() { return expose().end(); }
+inline size_t KvsArray::size() const { return items().size(); }
+inline bool KvsArray::empty() const { return items().empty(); }
+inline const KvsValue& KvsArray::operator[](size_t idx) const { return items()[idx]; }
+inline KvsValue& KvsArray::operator[](size_t idx) { return expose()[idx]; }
+inline const KvsValue& KvsArray::back() const { return items().back(); }
+inline KvsValue& KvsArray::back() { return expose().back(); }
+
+inline void KvsArray::reserve(size_t count) {
+    if (count > items().capacity()) {
+        detach().reserve(count);
+    }
+}
+
+inline void KvsArray::clear() {
+    elements.reset();
+    exposed = false;
+}
+inline void KvsArray::push_back(const KvsValue& value) { detach().push_back(value); }
+inline void KvsArray::push_back(KvsValue&& value) { detach().push_back(std::move(value)); }
+
+template <typename... Args>
+inline KvsValue& KvsArray::emplace_back(Args&&... args) {
+    return expose().emplace_back(std::forward<Args>(args)...);
+}
+
+inline bool KvsArray::operator==(const KvsArray& other) const {
+    return (elements == other.elements) || (items() == other.items());
+}
+
+inline bool KvsArray::operator!=(const KvsArray& other) const { return !(*this == other); }
+
+/* KvsObject functions (need the complete KvsValue) */
+inline KvsObject::KvsObject(std::initializer_list<value_type> init)
+    : KvsObject(std::vector<value_type>(init))
+{
+}
+
+inline KvsObject::KvsObject(std::vector<value_type>&& init)
+{
+    sort_members(init);
+    if (!init.empty()) {
+        members = std::allocate_shared<Members>(KvsAllocator<Members>(), std::make_move_iterator(init.begin()),
+                                                std::make_move_iterator(init.end()));
+    }
+}
+
+inline KvsObject::KvsObject(Members&& init)
+{
+    sort_members(init);
+    if (!init.empty()) {
+        members = std::allocate_shared<Members>(KvsAllocator<Members>(init.get_allocator()), std::move(init));
+    }
+}
+
+inline KvsObject::KvsObject(const KvsObject& other)
+    : members((other.exposed && other.members) ? std::allocate_shared<Members>(KvsAllocator<Members>(), *other.members)
+                                               : other.members)
+{
+}
+
+inline KvsObject& KvsObject::operator=(const KvsObject& other) {
+    if (this != &other) {
+        *this = KvsObject(other);
+    }
+    return *this;
+}
+
+template <typename Vector>
+inline void KvsObject::sort_members(Vector& init) {
+    const auto not_ascending = [](const value_type& lhs, const value_type& rhs) { return !(lhs.first < rhs.first); };
+    if (std::adjacent_find(init.begin(), init.end(), not_ascending) != init.end()) {
+        std::stable_sort(init.begin(), init.end(),
+                         [](const value_type& lhs, const value_type& rhs) { return lhs.first < rhs.first; });
+        /* Keep the last member of equal keys */
+        auto last = std::unique(init.rbegin(), init.rend(),
+                                [](const value_type& lhs, const value_type& rhs) { return lhs.first == rhs.first; });
+        (void)init.erase(init.begin(), last.base());
+    }
+}
+
+inline const KvsObject::Members& KvsObject::items() const {
+    static const Members none;
+    return members ? *members : none;
+}
+
+inline KvsObject::Members& KvsObject::detach() {
+    if (!members) {
+        members = std::allocate_shared<Members>(KvsAllocator<Members>());
+    }else if (!kvs_storage_unique(members)) {
+        members = std::allocate_shared<Members>(KvsAllocator<Members>(), *members);
+    }
+    return *members;
+}
+
+inline KvsObject::Members& KvsObject::expose() {
+    Members& unshared = detach();
+    exposed = true;
+    return unshared;
+}
+
+inline KvsObject::const_iterator KvsObject::begin() const { return items().begin(); }
+inline KvsObject::const_iterator KvsObject::end() const { return items().end(); }
+inline KvsObject::iterator KvsObject::begin() { return expose().begin(); }
+inline KvsObject::iterator KvsObject::end() { return expose().end(); }
+inline size_t KvsObject::size() const { return items().size(); }
+inline bool KvsObject::empty() const { return items().empty(); }
+
+inline void KvsObject::reserve(size_t count) {
+    if (count > items().capacity()) {
+        detach().reserve(count);
+    }
+}
+
+inline void KvsObject::clear() {
+    members.reset();
+    exposed = false;
+}
+
+inline KvsObject::const_iterator KvsObject::find(std::string_view key) const {
+    const Members& sorted = items();
+    auto search = std::lower_bound(sorted.begin(), sorted.end(), key,
+                                   [](const value_type& member, std::string_view name) { return member.first < name; });
+    return ((search != sorted.end()) && (search->first == key)) ? search : sorted.end();
+}
+
+inline KvsObject::iterator KvsObject::find(std::string_view key) {
+    const auto search = static_cast<const KvsObject&>(*this).find(key);
+    const auto offset = search - items().begin();
+    return expose().begin() + offset;
+}
+
+inline size_t KvsObject::count(std::string_view key) const {
+    return (find(key) != end()) ? 1U : 0U;
+}
+
+inline const KvsValue& KvsObject::at(std::string_view key) const {
+    auto search = find(key);
+    if (search == end()) {
+        throw std::out_of_range("KvsObject::at: key not found");
+    }
+    return search->second;
+}
+
+inline KvsValue& KvsObject::at(std::string_view key) {
+    (void)static_cast<const KvsObject&>(*this).at(key); /* Throws before the members are unshared */
+    return find(key)->second;
+}
+
+inline KvsObject::iterator KvsObject::insert_position(const std::string& key, bool& exists) {
+    Members& sorted = expose(); /* The returned iterator refers to the members */
+    /* Members appended in key order don't need a search */
+    const bool append = sorted.empty() || (sorted.back().first < key);
+    auto search = append ? sorted.end()
+                         : std::lower_bound(sorted.begin(), sorted.end(), key,
+                                            [](const value_type& member, const std::string& name) { return member.first < name; });
+    exists = !append && (search->first == key);
+    return search;
+}
+
+inline std::pair<KvsObject::iterator, bool> KvsObject::emplace(std::string key, KvsValue value) {
+    bool exists = false;
+    auto search = insert_position(key, exists);
+    if (!exists) {
+        search = members->emplace(search, std::move(key), std::move(value));
+    }
+    return {search, !exists};
+}
+
+inline std::pair<KvsObject::iterator, bool> KvsObject::insert_or_assign(std::string key, KvsValue value) {
+    bool exists = false;
+    auto search = insert_position(key, exists);
+    if (exists) {
+        search->second = std::move(value);
+    }else{
+        search = members->emplace(search, std::move(key), std::move(value));
+    }
+    return {search, !exists};
+}
+
+inline size_t KvsObject::erase(std::string_view key) {
+    const auto search = static_cast<const KvsObject&>(*this).find(key);
+    const bool found = (search != items().end());
+    if (found) {
+        const auto offset = search - items().begin();
+        Members& unshared = detach();
+        (void)unshared.erase(unshared.begin() + offset);
+    }
+    return found ? 1U : 0U;
+}
+
+inline bool KvsObject::operator==(const KvsObject& other) const {
+    return (members == other.members) || (items() == other.items());
+}
+
+inline bool KvsObject::operator!=(const KvsObject& other) const { return !(*this == other); }
+
+/* KvsPackedArray functions */
+template <typename T>
+inline KvsPackedArray<T>::KvsPackedArray(const T* data, size_t size)
+{
+    assign(data, size);
+}
+
+template <typename T>
+inline KvsPackedArray<T>::KvsPackedArray(std::initializer_list<T> init)
+    : KvsPackedArray(init.begin(), init.size())
+{
+}
+
+template <typename T>
+inline KvsPackedArray<T>::KvsPackedArray(const Storage& init)
+    : KvsPackedArray(init.data(), init.size())
+{
+}
+
+template <typename T>
+inline KvsPackedArray<T>::KvsPackedArray(Storage&& init)
+{
+    if (!init.empty()) {
+        elements = std::allocate_shared<Storage>(KvsAllocator<Storage>(), std::move(init));
+    }
+}
+
+template <typename T>
+inline KvsPackedArray<T>::KvsPackedArray(const KvsPackedArray& other)
+    : elements((other.exposed && other.elements) ? std::allocate_shared<Storage>(KvsAllocator<Storage>(), *other.elements)
+                                                 : other.elements)
+{
+}
+
+template <typename T>
+inline KvsPackedArray<T>& KvsPackedArray<T>::operator=(const KvsPackedArray& other) {
+    if (this != &other) {
+        *this = KvsPackedArray(other);
+    }
+    return *this;
+}
+
+template <typename T>
+inline const typename KvsPackedArray<T>::Storage& KvsPackedArray<T>::items() const {
+    static const Storage none;
+    return elements ? *elements : none;
+}
+
+template <typename T>
+inline typename KvsPackedArray<T>::Storage& KvsPackedArray<T>::detach() {
+    if (!elements) {
+        elements = std::allocate_shared<Storage>(KvsAllocator<Storage>());
+    }else if (!kvs_storage_unique(elements)) {
+        elements = std::allocate_shared<Storage>(KvsAllocator<Storage>(), *elements);
+    }
+    return *elements;
+}
+
+template <typename T>
+inline const T* KvsPackedArray<T>::data() const { return items().data(); }
+template <typename T>
+inline T* KvsPackedArray<T>::data() {
+    T* unshared = detach().data();
+    exposed = true;
+    return unshared;
+}
+template <typename T>
+inline size_t KvsPackedArray<T>::size() const { return items().size(); }
+template <typename T>
+inline bool KvsPackedArray<T>::empty() const { return items().empty(); }
+template <typename T>
+inline const T& KvsPackedArray<T>::operator[](size_t idx) const { return items()[idx]; }
+template <typename T>
+inline typename KvsPackedArray<T>::const_iterator KvsPackedArray<T>::begin() const { return items().data(); }
+template <typename T>
+inline typename KvsPackedArray<T>::const_iterator KvsPackedArray<T>::end() const { return items().data() + items().size(); }
+
+template <typename T>
+inline std::vector<T> KvsPackedArray<T>::to_vector() const {
+    return std::vector<T>(begin(), end());
+}
+
+template <typename T>
+inline void KvsPackedArray<T>::assign(const T* data, size_t size) {
+    if (0U == size) {
+        elements.reset();
+    }else{
+        elements = std::allocate_shared<Storage>(KvsAllocator<Storage>(), data, data + size);
+    }
+    exposed = false;
+}
+
+template <typename T>
+inline void KvsPackedArray<T>::resize(size_t size) {
+    if (size != items().size()) {
+        detach().resize(size);
+    }
+}
+
+template <typename T>
+inline void KvsPackedArray<T>::clear() {
+    elements.reset();
+    exposed = false;
+}
+
+template <typename T>
+inline bool KvsPackedArray<T>::operator==(const KvsPackedArray& other) const {
+    return (elements == other.elements) || (items() == other.items());
+}
+
+template <typename T>
+inline bool KvsPackedArray<T>::operator!=(const KvsPackedArray& other) const { return !(*this == other); }
+
+/**
+ * @brief Conversion between KvsValue and C++ types for the typed access (Kvs::get_value_as, typed Kvs::set_value).
+ *
+ * Supported types: int32_t, uint32_t, int64_t, uint64_t, double, bool, std::string and
+ * std::vector<T> / std::unordered_map<std::string, T> of supported types (also nested),
+ * std::vector<uint8_t> is stored as KvsValue::Bytes.
+ * Number vectors are stored as KvsValue::Array and can also be read from the packed arrays, which are stored
+ * with their own type (e.g. KvsValue::ArrayF64, shared without a copy).
+ * `read` returns false, if the stored type doesn't match (no conversion between number types),
+ * `make` moves the value into a new KvsValue. `readable` (get_value_as) and `writable` (typed set_value)
+ * tell which of them a type has, string literals are only writable. Both are false for all other types.
+ */
+template <typename T, typename Enable = void>
+struct KvsValueConverter {
+    static constexpr bool readable = false;
+    static constexpr bool writable = false;
+};
+
+/* Scalars and strings are stored directly in the variant */
+template <typename T>
+struct KvsValueConverter<T, std::enable_if_t<std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t>
+                                           || std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>
+                                           || std::is_same_v<T, double> || std::is_same_v<T, bool>
+                                           || std::is_same_v<T, std::string>>> {
+    static constexpr bool readable = true;
+    static constexpr bool writable = true;
+
+    static bool read(const KvsValue& value, T& out) {
+        const T* stored = std::get_if<T>(&value.getValue());
+        if (nullptr != stored) {
+            out = *stored;
+        }
+        return (nullptr != stored);
+    }
+
+    static KvsValue make(T value) {
+        return KvsValue(std::move(value));
+    }
+};
+
+/* Element types of the packed arrays (KvsValue::ArrayI32 ... KvsValue::ArrayF64) */
+template <typename T>
+constexpr bool kvs_packed_element_v = std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t>
+                                   || std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>
+                                   || std::is_same_v<T, double>;
+
+template <typename T>
+struct KvsValueConverter<KvsPackedArray<T>, std::enable_if_t<kvs_packed_element_v<T>>> {
+    static constexpr bool readable = true;
+    static constexpr bool writable = true;
+
+    static bool read(const KvsValue& value, KvsPackedArray<T>& out) {
+        const KvsPackedArray<T>* stored = std::get_if<KvsPackedArray<T>>(&value.getValue());
+        if (nullptr != stored) {
+            out = *stored;
+        }
+        return (nullptr != stored);
+    }
+
+    static KvsValue make(KvsPackedArray<T> value) {
+        return KvsValue(std::move(value));
+    }
+};
+
+/* Containers are readable and writable, if their elements are */
+template <typename T>
+struct KvsValueConverter<std::vector<T>, std::enable_if_t<KvsValueConverter<T>::readable || KvsValueConverter<T>::writable>> {
+    static constexpr bool readable = KvsValueConverter<T>::readable;
+    static constexpr bool writable = KvsValueConverter<T>::writable;
+
+    static bool read(const KvsValue& value, std::vector<T>& out) {
+        const KvsValue::Array* array = std::get_if<KvsValue::Array>(&value.getValue());
+        bool valid = (nullptr != array);
+        if constexpr (kvs_packed_element_v<T>) {
+            const KvsPackedArray<T>* packed = std::get_if<KvsPackedArray<T>>(&value.getValue());
+            if (nullptr != packed) {
+                out.assign(packed->begin(), packed->end());
+                valid = true;
+            }
+        }
+        if (nullptr != array) {
+            out.clear();
+            out.reserve(array->size());
+            for (size_t idx = 0; valid && (idx < array->size()); ++idx) {
+                T element{};
+                valid = KvsValueConverter<T>::read((*array)[idx], element);
+                out.push_back(std::move(element));
+            }
+        }
+        return valid;
+    }
+
+    static KvsValue make(std::vector<T> values) {
+        KvsValue::Array array;
+        array.reserve(values.size());
+        for (auto&& element : values) {
+            array.push_back(KvsValueConverter<T>::make(std::move(element)));
+        }
+        return KvsValue(std::move(array));
+    }
+};
+
+template <typename T>
+struct KvsValueConverter<std::unordered_map<std::string, T>, std::enable_if_t<KvsValueConverter<T>::readable || KvsValueConverter<T>::writable>> {
+    static constexpr bool readable = KvsValueConverter<T>::readable;
+    static constexpr bool writable = KvsValueConverter<T>::writable;
+
+    static bool read(const KvsValue& value, std::unordered_map<std::string, T>& out) {
+        const KvsValue::Object* object = std::get_if<KvsValue::Object>(&value.getValue());
+        bool valid = (nullptr != object);
+        if (valid) {
+            out.clear();
+            out.reserve(object->size());
+            for (auto it = object->begin(); valid && (it != object->end()); ++it) {
+                T element{};
+                valid = KvsValueConverter<T>::read(it->second, element);
+                out.emplace(it->first, std::move(element));
+            }
+        }
+        return valid;
+    }
+
+    static KvsValue make(std::unordered_map<std::string, T> values) {
+        std::vector<KvsObject::value_type> members;
+        members.reserve(values.size());
+        while (!values.empty()) {
+            auto node = values.extract(values.begin()); /* Moves the key and the value */
+            members.emplace_back(std::move(node.key()), KvsValueConverter<T>::make(std::move(node.mapped())));
+        }
+        return KvsValue(KvsObject(std::move(members)));
+    }
+};
+
+/* Binary data (not an array of numbers) */
+template <>
+struct KvsValueConverter<std::vector<uint8_t>> {
+    static constexpr bool readable = true;
+    static constexpr bool writable = true;
+
+    static bool read(const KvsValue& value, std::vector<uint8_t>& out) {
+        const KvsValue::Bytes* bytes = std::get_if<KvsValue::Bytes>(&value.getValue());
+        if (nullptr != bytes) {
+            out.assign(bytes->begin(), bytes->end());
+        }
+        return (nullptr != bytes);
+    }
+
+    static KvsValue make(std::vector<uint8_t> value) {
+        return KvsValue(KvsBytes(std::move(value)));
+    }
+};
+
+/* String literals can be stored (read them as std::string) */
+template <>
+struct KvsValueConverter<const char*> {
+    static constexpr bool readable = false;
+    static constexpr bool writable = true;
+
+    static KvsValue make(const char* value) {
+        return KvsValue(value);
+    }
+};
+
 } /* namespace score::mw::per::kvs */
 
 #endif /* SCORE_LIB_KVS_KVSVALUE_HPP */
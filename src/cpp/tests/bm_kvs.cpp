@@ -11,17 +11,45 @@
 * SPDX-License-Identifier: Apache-2.0
 ********************************************************************************/
 
+#include <atomic>
 #include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <new>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define private public
 #define final
 #include "kvsbuilder.hpp"
 #undef private
 #undef final
+#include "internal/kvs_binary.hpp"
 #include "internal/kvs_helper.hpp"
 using namespace score::mw::per::kvs;
 
+// Heap allocations (count and bytes) of the benchmark process, counted by the replaced global operator new
+static std::atomic<size_t> heap_allocations{0};
+static std::atomic<size_t> heap_bytes{0};
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1U, std::memory_order_relaxed);
+    heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = std::malloc((0U != size) ? size : 1U);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
 static void BM_get_hash_bytes(benchmark::State& state) {
     // Prepare a test string of configurable size
     std::string data(state.range(0), 'a');
@@ -34,4 +62,597 @@ static void BM_get_hash_bytes(benchmark::State& state) {
 // Register the function as a benchmark with different input sizes
 BENCHMARK(BM_get_hash_bytes)->Range(16, 16<<10);
 
+// KVS data with a configurable number of entries of mixed types
+static KvsMap make_kvs_data(size_t entries) {
+    KvsMap data;
+    for (size_t i = 0; i < entries; ++i) {
+        const std::string key = "key_" + std::to_string(i);
+        switch (i % 4) {
+            case 0: data.emplace(key, KvsValue(static_cast<double>(i))); break;
+            case 1: data.emplace(key, KvsValue(static_cast<int32_t>(i))); break;
+            case 2: data.emplace(key, KvsValue(std::string(32, 'v'))); break;
+            default: data.emplace(key, KvsValue(std::vector<KvsValue>{KvsValue(true), KvsValue(1.0)})); break;
+        }
+    }
+    return data;
+}
+
+static void BM_serialize_json(benchmark::State& state) {
+    Kvs kvs;
+    auto data = make_kvs_data(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.serialize_json_data(data));
+    }
+}
+
+static void BM_serialize_binary(benchmark::State& state) {
+    auto data = make_kvs_data(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(serialize_kvs_binary(data));
+    }
+}
+
+static void BM_parse_json(benchmark::State& state) {
+    Kvs kvs;
+    std::string buf = kvs.serialize_json_data(make_kvs_data(state.range(0))).value();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.parse_json_data(buf));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(buf.size()));
+}
+
+// Previous JSON load path: score::json::Any tree, converted by any_to_kvsvalue
+static void BM_parse_json_any(benchmark::State& state) {
+    Kvs kvs;
+    std::string buf = kvs.serialize_json_data(make_kvs_data(state.range(0))).value();
+    score::json::JsonParser parser;
+    for (auto _ : state) {
+        auto any_res = parser.FromBuffer(buf);
+        KvsMap data;
+        for (const auto& element : any_res.value().As<score::json::Object>().value().get()) {
+            data.emplace(std::string(element.first.GetAsStringView()), any_to_kvsvalue(element.second).value());
+        }
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(buf.size()));
+}
+
+static void BM_parse_binary(benchmark::State& state) {
+    std::string buf = serialize_kvs_binary(make_kvs_data(state.range(0))).value();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(deserialize_kvs_binary(buf));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(buf.size()));
+}
+
+// KVS with 1024 entries for the multi-threaded read benchmarks (blocking locks, so readers never fail)
+static Kvs open_bm_kvs(bool read_mostly) {
+    auto result = KvsBuilder(read_mostly ? 91 : 90)
+                      .dir("./bm_data/")
+                      .lock_policy(KvsLockPolicy::Blocking)
+                      .read_mostly_flag(read_mostly)
+                      .build();
+    Kvs kvs = std::move(result.value());
+    for (const auto& [key, value] : make_kvs_data(1024)) {
+        (void)kvs.set_value(key, value);
+    }
+    return kvs;
+}
+
+static Kvs& bm_kvs(bool read_mostly) {
+    static Kvs shared_lock_kvs = open_bm_kvs(false);
+    static Kvs read_mostly_kvs = open_bm_kvs(true);
+    return read_mostly ? read_mostly_kvs : shared_lock_kvs;
+}
+
+// get_value from 1..N threads while one writer changes a value continuously
+// Arg 0: shared lock, Arg 1: read-mostly mode (lock-free readers)
+static void BM_get_value_concurrent(benchmark::State& state) {
+    Kvs& kvs = bm_kvs(0 != state.range(0));
+    static std::atomic<bool> stop{false};
+    static std::thread writer;
+    if (0 == state.thread_index()) {
+        stop = false;
+        writer = std::thread([&kvs]() {
+            int32_t i = 0;
+            while (!stop) {
+                (void)kvs.set_value("key_1", KvsValue(i++));
+            }
+        });
+    }
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 64; ++i) {
+        keys.push_back("key_" + std::to_string((i * 16) + static_cast<size_t>(state.thread_index())));
+    }
+    size_t idx = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.get_value(keys[idx]));
+        idx = (idx + 1) % keys.size();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+    if (0 == state.thread_index()) {
+        stop = true;
+        writer.join();
+    }
+}
+
+// set_value from 1..N threads on distinct keys
+// Arg: shard count (1: the KVS data is locked as a whole)
+static void BM_set_value_concurrent(benchmark::State& state) {
+    static Kvs kvs = std::move(KvsBuilder(92).dir("./bm_data/").lock_policy(KvsLockPolicy::Blocking).build().value());
+    if (0 == state.thread_index()) {
+        kvs = std::move(KvsBuilder(92)
+                            .dir("./bm_data/")
+                            .lock_policy(KvsLockPolicy::Blocking)
+                            .shard_count(static_cast<size_t>(state.range(0)))
+                            .build()
+                            .value());
+    }
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 64; ++i) {
+        keys.push_back("thread" + std::to_string(state.thread_index()) + "_" + std::to_string(i));
+    }
+    size_t idx = 0;
+    int32_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.set_value(keys[idx], KvsValue(value++)));
+        idx = (idx + 1) % keys.size();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+// Latency of a persisted change for the writing thread
+// Arg 0: set_value and flush, Arg 1: set_value with background flush (worker coalesces the changes)
+static void BM_set_value_persist(benchmark::State& state) {
+    const bool background = (0 != state.range(0));
+    auto result = KvsBuilder(93)
+                      .dir("./bm_data/")
+                      .flush_policy(background ? KvsFlushPolicy::Background : KvsFlushPolicy::Manual)
+                      .flush_delay(std::chrono::milliseconds(10))
+                      .build();
+    Kvs kvs = std::move(result.value());
+    for (const auto& [key, value] : make_kvs_data(256)) {
+        (void)kvs.set_value(key, value);
+    }
+    int32_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.set_value("key_1", KvsValue(i++)));
+        if (!background) {
+            benchmark::DoNotOptimize(kvs.flush());
+        }
+    }
+}
+
+// set_value while another thread flushes a KVS of the given size continuously
+// The KVS lock is only held to capture the data, so the writer latency should not grow with the size
+static void BM_set_value_during_flush(benchmark::State& state) {
+    auto result = KvsBuilder(94).dir("./bm_data/").lock_policy(KvsLockPolicy::Blocking).build();
+    Kvs kvs = std::move(result.value());
+    for (const auto& [key, value] : make_kvs_data(static_cast<size_t>(state.range(0)))) {
+        (void)kvs.set_value(key, value);
+    }
+    std::atomic<bool> stop{false};
+    std::thread flusher([&kvs, &stop]() {
+        while (!stop) {
+            (void)kvs.flush();
+        }
+    });
+    int32_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.set_value("key_1", KvsValue(i++)));
+    }
+    stop = true;
+    flusher.join();
+}
+
+// Update of a group of 16 keys with the write-ahead log
+// Arg 0: one set_value per key, Arg 1: one committed batch (one lock acquisition and WAL record)
+static void BM_commit_group(benchmark::State& state) {
+    const bool batched = (0 != state.range(0));
+    auto result = KvsBuilder(95).dir("./bm_data/").wal_flag(true).wal_compaction_threshold(SIZE_MAX).build();
+    Kvs kvs = std::move(result.value());
+    std::vector<std::string> keys;
+    for (size_t idx = 0; idx < 16U; idx++) {
+        keys.push_back("calibration_" + std::to_string(idx));
+    }
+    int32_t i = 0;
+    for (auto _ : state) {
+        if (batched) {
+            KvsWriteBatch batch;
+            for (const auto& key : keys) {
+                batch.set_value(key, KvsValue(i));
+            }
+            benchmark::DoNotOptimize(kvs.commit(batch));
+        }else{
+            for (const auto& key : keys) {
+                benchmark::DoNotOptimize(kvs.set_value(key, KvsValue(i)));
+            }
+        }
+        i++;
+    }
+}
+
+// Startup read of 200 keys
+// Arg 0: one get_value per key, Arg 1: get_values with one lock and a reused output container
+static void BM_get_values(benchmark::State& state) {
+    const bool multi = (0 != state.range(0));
+    auto result = KvsBuilder(96).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    const auto data = make_kvs_data(200);
+    for (const auto& [key, value] : data) {
+        (void)kvs.set_value(key, value);
+    }
+    std::vector<std::string_view> keys;
+    for (const auto& [key, _] : data) {
+        keys.push_back(key);
+    }
+    std::vector<std::optional<KvsValue>> values;
+    for (auto _ : state) {
+        if (multi) {
+            benchmark::DoNotOptimize(kvs.get_values(keys, values));
+        }else{
+            for (const auto& key : keys) {
+                benchmark::DoNotOptimize(kvs.get_value(key));
+            }
+        }
+    }
+}
+
+// Startup write of 200 keys
+// Arg 0: one set_value per key, Arg 1: set_values with one lock
+static void BM_set_values(benchmark::State& state) {
+    const bool multi = (0 != state.range(0));
+    auto result = KvsBuilder(97).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    std::vector<std::string> keys;
+    for (size_t idx = 0; idx < 200U; idx++) {
+        keys.push_back("key_" + std::to_string(idx));
+    }
+    int32_t i = 0;
+    for (auto _ : state) {
+        if (multi) {
+            std::vector<std::pair<std::string_view, KvsValue>> entries;
+            entries.reserve(keys.size());
+            for (const auto& key : keys) {
+                entries.emplace_back(key, KvsValue(i));
+            }
+            benchmark::DoNotOptimize(kvs.set_values(entries));
+        }else{
+            for (const auto& key : keys) {
+                benchmark::DoNotOptimize(kvs.set_value(key, KvsValue(i)));
+            }
+        }
+        i++;
+    }
+}
+
+// Heap allocations and latency of a steady-state lookup of a key longer than the small string buffer
+// Arg 0: std::string_view key, Arg 1: prepared KvsKey; Arg 0/1 + 2: sharded KVS
+static void BM_get_value_allocations(benchmark::State& state) {
+    const bool prepared = (0 != (state.range(0) & 1));
+    const bool sharded = (0 != (state.range(0) & 2));
+    auto result = KvsBuilder(98).dir("./bm_data/").shard_count(sharded ? 16U : 1U).build();
+    Kvs kvs = std::move(result.value());
+    const std::string name = "calibration/engine/injection_offset";
+    const KvsKey key(name);
+    (void)kvs.set_value(name, KvsValue(1.0));
+    (void)kvs.get_value(name); /* Warm-up of the reused lookup key */
+    const size_t before = heap_allocations.load();
+    for (auto _ : state) {
+        if (prepared) {
+            benchmark::DoNotOptimize(kvs.get_value(key));
+        }else{
+            benchmark::DoNotOptimize(kvs.get_value(std::string_view(name)));
+        }
+    }
+    state.counters["allocs/op"] = static_cast<double>(heap_allocations.load() - before) / static_cast<double>(state.iterations());
+}
+
+// Read of an array value with the given number of elements
+// Arg 0: get_value (deep copy), Arg 1: visit_value (no copy)
+static void BM_read_large_value(benchmark::State& state) {
+    const bool visit = (0 != state.range(1));
+    auto result = KvsBuilder(99).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    std::vector<KvsValue> table;
+    for (int64_t idx = 0; idx < state.range(0); idx++) {
+        table.emplace_back(static_cast<double>(idx));
+    }
+    (void)kvs.set_value("table", KvsValue(table));
+    const KvsKey key("table");
+    size_t elements = 0;
+    for (auto _ : state) {
+        if (visit) {
+            benchmark::DoNotOptimize(kvs.visit_value(key, [&elements](const KvsValue& value) {
+                elements += std::get<KvsValue::Array>(value.getValue()).size();
+            }));
+        }else{
+            auto value = kvs.get_value(key);
+            elements += std::get<KvsValue::Array>(value.value().getValue()).size();
+        }
+    }
+    benchmark::DoNotOptimize(elements);
+}
+
+static void BM_get_value_as(benchmark::State& state) {
+    const bool typed = (0 != state.range(0));
+    auto result = KvsBuilder(99).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    (void)kvs.set_value("counter", static_cast<uint64_t>(1));
+    const KvsKey key("counter");
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        if (typed) {
+            sum += kvs.get_value_as<uint64_t>(key).value();
+        }else{
+            sum += std::get<uint64_t>(kvs.get_value(key).value().getValue());
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+// Nested value: array of records (object with a number, a string and a small array)
+static KvsValue make_nested_value(size_t records) {
+    std::vector<KvsValue> array;
+    array.reserve(records);
+    for (size_t i = 0; i < records; ++i) {
+        std::unordered_map<std::string, KvsValue> record{
+            {"id", KvsValue(static_cast<uint64_t>(i))},
+            {"name", KvsValue("record")},
+            {"values", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(2.0), KvsValue(3.0), KvsValue(4.0)})}};
+        array.emplace_back(record);
+    }
+    return KvsValue(array);
+}
+
+static size_t count_scalars(const KvsValue& value) {
+    size_t count = 0;
+    if (value.getType() == KvsValue::Type::Array) {
+        for (const auto& elem : std::get<KvsValue::Array>(value.getValue())) {
+            count += count_scalars(elem);
+        }
+    }else if (value.getType() == KvsValue::Type::Object) {
+        for (const auto& [key, elem] : std::get<KvsValue::Object>(value.getValue())) {
+            count += count_scalars(elem);
+        }
+    }else{
+        count = 1U;
+    }
+    return count;
+}
+
+static void BM_kvsvalue_construct(benchmark::State& state) {
+    const size_t allocs = heap_allocations.load();
+    const size_t bytes = heap_bytes.load();
+    for (auto _ : state) {
+        KvsValue value = make_nested_value(state.range(0));
+        benchmark::DoNotOptimize(value);
+    }
+    const double records = static_cast<double>(state.iterations()) * static_cast<double>(state.range(0));
+    state.counters["allocs/record"] = static_cast<double>(heap_allocations.load() - allocs) / records;
+    state.counters["bytes/record"] = static_cast<double>(heap_bytes.load() - bytes) / records;
+}
+
+static void BM_kvsvalue_copy(benchmark::State& state) {
+    const KvsValue value = make_nested_value(state.range(0));
+    const size_t allocs = heap_allocations.load();
+    for (auto _ : state) {
+        KvsValue copy(value);
+        benchmark::DoNotOptimize(copy);
+    }
+    const double records = static_cast<double>(state.iterations()) * static_cast<double>(state.range(0));
+    state.counters["allocs/record"] = static_cast<double>(heap_allocations.load() - allocs) / records;
+}
+
+static void BM_kvsvalue_traverse(benchmark::State& state) {
+    const KvsValue value = make_nested_value(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(count_scalars(value));
+    }
+}
+
+static void BM_get_nested_value(benchmark::State& state) {
+    auto result = KvsBuilder(99).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    (void)kvs.set_value("nested", make_nested_value(state.range(0)));
+    const KvsKey key("nested");
+    for (auto _ : state) {
+        auto value = kvs.get_value(key);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+static void BM_set_nested_value(benchmark::State& state) {
+    auto result = KvsBuilder(99).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    /* Alternate between two values, so every set changes the KVS */
+    const KvsValue values[2] = {make_nested_value(state.range(0)), KvsValue(std::vector<KvsValue>{KvsValue(0.0)})};
+    const KvsKey key("nested");
+    size_t idx = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kvs.set_value(key, values[idx]));
+        idx ^= 1U;
+    }
+}
+
+// Heap allocations of storing a freshly built array under a new key (64 characters)
+// Arg 0: copied value, Arg 1: moved value, Arg 2: owned key and moved value
+static void BM_set_value_move(benchmark::State& state) {
+    auto result = KvsBuilder(101).dir("./bm_data/").build();
+    Kvs kvs = std::move(result.value());
+    size_t allocations = 0;
+    for (auto _ : state) {
+        std::string name(64U, 'k');
+        KvsValue value(std::vector<KvsValue>(256U, KvsValue(1.0)));
+        const size_t before = heap_allocations.load();
+        if (0 == state.range(0)) {
+            benchmark::DoNotOptimize(kvs.set_value(name, value));
+        }else if (1 == state.range(0)) {
+            benchmark::DoNotOptimize(kvs.set_value(name, std::move(value)));
+        }else{
+            benchmark::DoNotOptimize(kvs.set_value(KvsKey(std::move(name)), std::move(value)));
+        }
+        allocations += heap_allocations.load() - before;
+        (void)kvs.remove_key(std::string_view(std::string(64U, 'k')));
+    }
+    state.counters["allocs/op"] = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+}
+
+// Heap allocations and latency of opening a KVS file with the given number of entries
+// Arg 1: 0 heap allocations, 1 load arena
+static void BM_open_allocations(benchmark::State& state) {
+    const bool arena = (0 != state.range(1));
+    {
+        auto result = KvsBuilder(100).dir("./bm_data/").build();
+        Kvs kvs = std::move(result.value());
+        (void)kvs.reset();
+        for (const auto& [key, value] : make_kvs_data(static_cast<size_t>(state.range(0)))) {
+            (void)kvs.set_value(key, value);
+        }
+        (void)kvs.set_value("nested", make_nested_value(state.range(0)));
+        (void)kvs.flush();
+    }
+    const size_t before = heap_allocations.load();
+    for (auto _ : state) {
+        auto result = KvsBuilder(100).dir("./bm_data/").need_kvs_flag(true).load_arena_flag(arena).build();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["allocs/op"] = static_cast<double>(heap_allocations.load() - before) / static_cast<double>(state.iterations());
+}
+
+// Serialized size and latency of a binary blob stored as Bytes and as an array of u32 values
+// Arg 1: 0 array, 1 bytes; Arg 2: 0 JSON, 1 binary format
+static void BM_serialize_blob(benchmark::State& state) {
+    std::vector<uint8_t> blob(static_cast<size_t>(state.range(0)));
+    for (size_t idx = 0; idx < blob.size(); ++idx) {
+        blob[idx] = static_cast<uint8_t>(idx * 13U);
+    }
+    KvsMap data;
+    if (0 != state.range(1)) {
+        data.emplace("blob", KvsValue(KvsValue::Bytes(blob)));
+    }else{
+        std::vector<KvsValue> array;
+        for (const uint8_t byte : blob) {
+            array.emplace_back(static_cast<uint32_t>(byte));
+        }
+        data.emplace("blob", KvsValue(array));
+    }
+    Kvs kvs;
+    const bool binary = (0 != state.range(2));
+    size_t size = 0;
+    for (auto _ : state) {
+        if (binary) {
+            auto buf = serialize_kvs_binary(data);
+            size = buf.value().size();
+            benchmark::DoNotOptimize(buf);
+        }else{
+            auto buf = kvs.serialize_json_data(data);
+            size = buf.value().size();
+            benchmark::DoNotOptimize(buf);
+        }
+    }
+    state.counters["bytes"] = static_cast<double>(size);
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(blob.size()));
+}
+
+// Table of doubles stored as KvsValue::Array and as KvsValue::ArrayF64
+static KvsMap make_table_data(const std::vector<double>& table, bool packed) {
+    KvsMap data;
+    if (packed) {
+        data.emplace("table", KvsValue(KvsValue::ArrayF64(table)));
+    }else{
+        KvsValue::Array array;
+        array.reserve(table.size());
+        for (const double number : table) {
+            array.emplace_back(number);
+        }
+        data.emplace("table", KvsValue(std::move(array)));
+    }
+    return data;
+}
+
+// Memory and serialization of a table of doubles
+// Arg 1: 0 array, 1 packed array; Arg 2: 0 JSON write, 1 JSON read, 2 binary write, 3 binary read
+static void BM_number_table(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const bool packed = (0 != state.range(1));
+    std::vector<double> table(count);
+    for (size_t idx = 0; idx < count; ++idx) {
+        table[idx] = static_cast<double>(idx) * 0.37;
+    }
+    const size_t heap_before = heap_bytes.load();
+    KvsMap data = make_table_data(table, packed);
+    state.counters["heap bytes/elem"] = static_cast<double>(heap_bytes.load() - heap_before) / static_cast<double>(count);
+
+    Kvs kvs;
+    const std::string json = kvs.serialize_json_data(data).value();
+    const std::string binary = serialize_kvs_binary(data).value();
+    for (auto _ : state) {
+        switch (state.range(2)) {
+            case 0: benchmark::DoNotOptimize(kvs.serialize_json_data(data)); break;
+            case 1: benchmark::DoNotOptimize(kvs.parse_json_data(json)); break;
+            case 2: benchmark::DoNotOptimize(serialize_kvs_binary(data)); break;
+            default: benchmark::DoNotOptimize(deserialize_kvs_binary(binary)); break;
+        }
+    }
+    state.counters["file bytes"] = static_cast<double>((state.range(2) < 2) ? json.size() : binary.size());
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(count));
+}
+
+// Compare both storage formats for different KVS sizes
+BENCHMARK(BM_serialize_json)->Range(16, 4<<10);
+BENCHMARK(BM_serialize_binary)->Range(16, 4<<10);
+BENCHMARK(BM_parse_json)->Range(16, 4<<10);
+BENCHMARK(BM_parse_json_any)->Range(16, 4<<10);
+BENCHMARK(BM_parse_binary)->Range(16, 4<<10);
+
+// Read scalability with a concurrent writer
+BENCHMARK(BM_get_value_concurrent)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// Write scalability with a sharded KVS
+BENCHMARK(BM_set_value_concurrent)->Arg(1)->Arg(16)->ThreadRange(1, 8)->UseRealTime();
+
+// Writer latency with synchronous and background flush
+BENCHMARK(BM_set_value_persist)->Arg(0)->Arg(1);
+
+// Writer stall during flush for different KVS sizes
+BENCHMARK(BM_set_value_during_flush)->Range(256, 16<<10)->UseRealTime();
+
+// Group update with single changes and with a write batch
+BENCHMARK(BM_commit_group)->Arg(0)->Arg(1);
+
+// Reading and writing many keys with single-key calls and with the multi-key functions
+BENCHMARK(BM_get_values)->Arg(0)->Arg(1);
+BENCHMARK(BM_set_values)->Arg(0)->Arg(1);
+
+// Allocations per lookup with std::string_view and prepared keys
+BENCHMARK(BM_get_value_allocations)->DenseRange(0, 3);
+
+// Large value read with copy and with visitor
+BENCHMARK(BM_read_large_value)->Ranges({{16, 4<<10}, {0, 1}});
+
+// Scalar read with get_value and with get_value_as
+BENCHMARK(BM_get_value_as)->Arg(0)->Arg(1);
+
+// Construction, copy and traversal of nested values
+BENCHMARK(BM_kvsvalue_construct)->Range(16, 4<<10);
+BENCHMARK(BM_kvsvalue_copy)->Range(16, 4<<10);
+BENCHMARK(BM_kvsvalue_traverse)->Range(16, 4<<10);
+
+// Reading and writing nested values of the KVS
+BENCHMARK(BM_get_nested_value)->Range(16, 4<<10);
+BENCHMARK(BM_set_nested_value)->Range(16, 4<<10);
+
+// Storing a value with copied and moved value and key
+BENCHMARK(BM_set_value_move)->DenseRange(0, 2);
+
+// Opening a KVS with and without the load arena
+BENCHMARK(BM_open_allocations)->Ranges({{16, 4<<10}, {0, 1}});
+
+// Binary blob as Bytes value and as array of u32 values in both storage formats
+BENCHMARK(BM_serialize_blob)->Ranges({{64, 64<<10}, {0, 1}, {0, 1}});
+
+// Table of doubles as array of values and as packed array
+BENCHMARK(BM_number_table)->ArgsProduct({{1<<10, 16<<10}, {0, 1}, {0, 1, 2, 3}});
+
 BENCHMARK_MAIN();
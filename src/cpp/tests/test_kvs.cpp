@@ -77,21 +77,9 @@ TEST(kvs_TEST, parse_json_data_sucess) {
     auto kvs = Kvs::open(InstanceId(instance_id), OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
 
-    auto mock_parser = std::make_unique<score::json::IJsonParserMock>();
-    score::json::Object obj;
-    score::json::Object inner_obj;
-    inner_obj.emplace("t", score::json::Any(std::string("i32")));
-    inner_obj.emplace("v", score::json::Any(42));
-    obj.emplace("kvs", score::json::Any(std::move(inner_obj)));
-    score::json::Any any_obj(std::move(obj));
-
-    EXPECT_CALL(*mock_parser, FromBuffer(::testing::_))
-        .WillOnce(::testing::Return(score::Result<score::json::Any>(std::move(any_obj))));
-
-    kvs->parser = std::move(mock_parser);
-
-    auto result = kvs->parse_json_data("data_not_used_in_mocking");
-    EXPECT_TRUE(result);
+    auto result = kvs->parse_json_data(R"({"kvs":{"t":"i32","v":42}})");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().at("kvs"), KvsValue(int32_t(42)));
 
     cleanup_environment();
 }
@@ -105,50 +93,23 @@ TEST(kvs_TEST, parse_json_data_failure) {
     auto kvs = Kvs::open(InstanceId(instance_id), OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
 
-    auto mock_parser = std::make_unique<score::json::IJsonParserMock>();
-    EXPECT_CALL(*mock_parser, FromBuffer(::testing::_))
-        .WillOnce(::testing::Return(score::Result<score::json::Any>(score::MakeUnexpected(score::json::Error::kInvalidFilePath))));
-
-    kvs->parser = std::move(mock_parser);
-
-    auto result = kvs->parse_json_data("data_not_used_in_mocking");
+    auto result = kvs->parse_json_data("{ invalid json }");
     EXPECT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), ErrorCode::JsonParserError);
 
 
     /* No Object returned Failure */
 
-    mock_parser = std::make_unique<score::json::IJsonParserMock>();
-    score::json::Any JsonParserReturnValue(42.0);
-
-    EXPECT_CALL(*mock_parser, FromBuffer(::testing::_))
-        .WillOnce(::testing::Return(score::Result<score::json::Any>(std::move(JsonParserReturnValue))));
-
-    kvs->parser = std::move(mock_parser);
-
-    result = kvs->parse_json_data("data_not_used_in_mocking");
+    result = kvs->parse_json_data("42.0");
     EXPECT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), ErrorCode::JsonParserError);
 
 
-    /* any_to_kvsvalue error */
-
-    mock_parser = std::make_unique<score::json::IJsonParserMock>();
-    score::json::Object obj;
-    score::json::Object inner_obj;
-    inner_obj.emplace("t", score::json::Any(std::string("invalid")));
-    inner_obj.emplace("v", score::json::Any(42));
-    obj.emplace("kvs", score::json::Any(std::move(inner_obj)));
-    score::json::Any any_obj(std::move(obj));
-
-    EXPECT_CALL(*mock_parser, FromBuffer(::testing::_))
-        .WillOnce(::testing::Return(score::Result<score::json::Any>(std::move(any_obj))));
+    /* Invalid type tag */
 
-    kvs->parser = std::move(mock_parser);
-
-    result = kvs->parse_json_data("data_not_used_in_mocking");
+    result = kvs->parse_json_data(R"({"kvs":{"t":"invalid","v":42}})");
     EXPECT_FALSE(result.has_value());
-    EXPECT_EQ(result.error(), ErrorCode::InvalidValueType); //error is passed from any_to_kvsvalue
+    EXPECT_EQ(result.error(), ErrorCode::InvalidValueType);
 
     cleanup_environment();
 }
@@ -187,14 +148,6 @@ TEST(kvs_open_json, open_json_json_invalid) {
 
     Kvs kvs = Kvs(); /* Create Kvs instance without any data (this constructor is normally private) */
 
-    /* Make JSON Parser Fail */
-    auto mock_parser = std::make_unique<score::json::IJsonParserMock>();
-    EXPECT_CALL(*mock_parser, FromBuffer(::testing::_))
-        .WillRepeatedly([](auto) {
-            return score::Result<score::json::Any>(score::MakeUnexpected(score::json::Error::kInvalidFilePath));
-        });
-    kvs.parser = std::move(mock_parser);
-
     auto result = kvs.open_json(score::filesystem::Path(kvs_prefix), OpenJsonNeedFile::Required);
     ASSERT_FALSE(result);
     EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::JsonParserError); /* Errorcode passed by parse json function*/
@@ -264,7 +217,7 @@ TEST(kvs_reset, reset_failure){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     auto reset_result = result.value().reset();
     EXPECT_FALSE(reset_result);
     EXPECT_EQ(static_cast<ErrorCode>(*reset_result.error()), ErrorCode::MutexLockFailed);
@@ -305,7 +258,7 @@ TEST(kvs_get_all_keys, get_all_keys_failure){
     /* Mutex locked */
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
 
     auto get_all_keys_result = result.value().get_all_keys();
     EXPECT_FALSE(get_all_keys_result);
@@ -344,7 +297,7 @@ TEST(kvs_key_exists, key_exists_failure){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     auto exists_result = result.value().key_exists("kvs");
     EXPECT_FALSE(exists_result);
     EXPECT_EQ(static_cast<ErrorCode>(*exists_result.error()), ErrorCode::MutexLockFailed);
@@ -371,6 +324,7 @@ TEST(kvs_get_value, get_value_success){
     /* Check if default value is returned when no written key exists */
     result.value().kvs.clear();
     ASSERT_TRUE(result.value().kvs.empty()); // Make sure kvs is empty and it uses the default value
+    result.value().default_image = KvsDefaultsImage(); /* Use the default values map instead of the defaults image */
     int32_t default_value(42);
     result.value().default_values.insert_or_assign(
         "kvs",
@@ -399,7 +353,7 @@ TEST(kvs_get_value, get_value_failure){
     /* Mutex locked */
     result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     get_value_result = result.value().get_value("kvs");
     EXPECT_FALSE(get_value_result);
     EXPECT_EQ(static_cast<ErrorCode>(*get_value_result.error()), ErrorCode::MutexLockFailed);
@@ -415,6 +369,7 @@ TEST(kvs_get_default_value, get_default_value_success){
     ASSERT_TRUE(result);
 
     /* Check Data existing */
+    result.value().default_image = KvsDefaultsImage(); /* Use the default values map instead of the defaults image */
     int32_t default_value(42);
     result.value().default_values.insert_or_assign(
         "kvs",
@@ -452,6 +407,7 @@ TEST(kvs_reset_key, reset_key_success){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
     ASSERT_TRUE(result.value().kvs.count("kvs")); /* Check Data existing */
+    result.value().default_image = KvsDefaultsImage(); /* Use the default values map instead of the defaults image */
 
     result.value().default_values.insert_or_assign( /* Create default Value for "kvs"-key */
         "kvs",
@@ -497,7 +453,7 @@ TEST(kvs_reset_key, reset_key_failure){
     /* Mutex locked */
     result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     reset_key_result = result.value().reset_key("kvs");
     EXPECT_FALSE(reset_key_result);
     EXPECT_EQ(static_cast<ErrorCode>(*reset_key_result.error()), ErrorCode::MutexLockFailed);
@@ -561,7 +517,7 @@ TEST(kvs_set_value, set_value_failure){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     auto set_value_result = result.value().set_value("new_key", KvsValue(3.0));
     EXPECT_FALSE(set_value_result);
     EXPECT_EQ(static_cast<ErrorCode>(*set_value_result.error()), ErrorCode::MutexLockFailed);
@@ -601,7 +557,7 @@ TEST(kvs_remove_key, remove_key_failure){
     /* Mutex locked */
     result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
     ASSERT_TRUE(result);
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     remove_key_result = result.value().remove_key("kvs");
     EXPECT_FALSE(remove_key_result);
     EXPECT_EQ(static_cast<ErrorCode>(*remove_key_result.error()), ErrorCode::MutexLockFailed);
@@ -609,25 +565,522 @@ TEST(kvs_remove_key, remove_key_failure){
     cleanup_environment();
 }
 
+TEST(kvs_commit, commit_success){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    KvsWriteBatch batch;
+    batch.set_value("key1", KvsValue(1.0))
+         .set_value("key2", KvsValue(2.0))
+         .remove_key("kvs")
+         .set_value("key1", KvsValue(10.0)) /* Later changes of a key win */
+         .remove_key("key2");
+    EXPECT_EQ(batch.size(), 5U);
+
+    const uint64_t generation = kvs.current_generation();
+    ASSERT_TRUE(kvs.commit(batch));
+    EXPECT_EQ(kvs.current_generation(), generation + 1U);
+    EXPECT_EQ(kvs.kvs.size(), 1U);
+    EXPECT_TRUE(kvs.get_value("key1").value() == KvsValue(10.0));
+    EXPECT_FALSE(kvs.key_exists("key2").value());
+    EXPECT_FALSE(kvs.key_exists("kvs").value());
+
+    /* Batch without effective change: KVS stays unmodified */
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0U);
+    ASSERT_TRUE(kvs.commit(batch));
+    batch.set_value("key1", KvsValue(10.0));
+    ASSERT_TRUE(kvs.commit(batch));
+    EXPECT_EQ(kvs.current_generation(), generation + 1U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_commit, commit_failure){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Removing a missing key fails the whole batch */
+    KvsWriteBatch batch;
+    batch.set_value("key1", KvsValue(1.0)).remove_key("kvs").remove_key("kvs");
+    auto commit_result = kvs.commit(batch);
+    ASSERT_FALSE(commit_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*commit_result.error()), ErrorCode::KeyNotFound);
+    EXPECT_FALSE(kvs.key_exists("key1").value());
+    EXPECT_TRUE(kvs.key_exists("kvs").value());
+    EXPECT_EQ(kvs.current_generation(), 0U);
+
+    /* A key set earlier in the batch can be removed */
+    batch.clear();
+    batch.set_value("key1", KvsValue(1.0)).remove_key("key1");
+    EXPECT_TRUE(kvs.commit(batch));
+    EXPECT_FALSE(kvs.key_exists("key1").value());
+
+    /* Mutex locked */
+    std::unique_lock<std::shared_timed_mutex> lock(kvs.kvs_mutex);
+    commit_result = kvs.commit(batch);
+    EXPECT_FALSE(commit_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*commit_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_commit, commit_atomic_visibility){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.lock_policy = KvsLockPolicy::Blocking;
+    options.read_mostly = true;
+    options.shard_count = 4U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* The keys of a group always hold the same value for lock-free readers and flush */
+    std::atomic<size_t> failures{0};
+    std::thread writer([&kvs, &failures]() {
+        for (int32_t i = 0; i < 200; i++) {
+            KvsWriteBatch batch;
+            for (int32_t key = 0; key < 8; key++) {
+                batch.set_value("group" + std::to_string(key), KvsValue(i));
+            }
+            failures += kvs.commit(batch) ? 0U : 1U;
+        }
+    });
+    for (size_t i = 0; i < 200U; i++) {
+        {
+            /* One read-mostly version */
+            KvsRcuMap::ReadGuard version(*kvs.rcu_map);
+            const KvsValue* first = version->find("group0");
+            for (int32_t key = 1; (nullptr != first) && (key < 8); key++) {
+                const KvsValue* value = version->find("group" + std::to_string(key));
+                failures += ((nullptr != value) && (*value == *first)) ? 0U : 1U;
+            }
+        }
+        if (0U == (i % 20U)) {
+            failures += kvs.flush() ? 0U : 1U;
+            /* The flushed version holds a complete group */
+            auto reopen = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+            if (!reopen) {
+                failures++;
+                continue;
+            }
+            auto first = reopen.value().get_value("group0");
+            for (int32_t key = 1; first && (key < 8); key++) {
+                auto value = reopen.value().get_value("group" + std::to_string(key));
+                failures += (value && (value.value() == first.value())) ? 0U : 1U;
+            }
+        }
+    }
+    writer.join();
+    EXPECT_EQ(failures.load(), 0U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_visit_value, visit_value_success){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* The stored value is visited, not a copy */
+    ASSERT_TRUE(kvs.set_value("array", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(2.0)})));
+    const KvsValue* visited = nullptr;
+    ASSERT_TRUE(kvs.visit_value("array", [&visited](const KvsValue& value) { visited = &value; }));
+    EXPECT_EQ(visited, &kvs.kvs.at("array"));
+
+    /* Default value */
+    size_t calls = 0;
+    ASSERT_TRUE(kvs.visit_value(KvsKey("default"), [&calls](const KvsValue& value) {
+        EXPECT_TRUE(value == KvsValue(static_cast<int32_t>(5)));
+        calls++;
+    }));
+    EXPECT_EQ(calls, 1U);
+
+    /* Read-mostly mode */
+    KvsOptions options;
+    options.read_mostly = true;
+    auto read_mostly = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+    ASSERT_TRUE(read_mostly);
+    ASSERT_TRUE(read_mostly.value().visit_value("kvs", [&calls](const KvsValue& value) {
+        EXPECT_TRUE(value == KvsValue(static_cast<int32_t>(2)));
+        calls++;
+    }));
+    EXPECT_EQ(calls, 2U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_visit_value, visit_value_failure){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    /* Neither written nor default value: visitor not called */
+    size_t calls = 0;
+    auto visit_result = result.value().visit_value("missing", [&calls](const KvsValue&) { calls++; });
+    EXPECT_FALSE(visit_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*visit_result.error()), ErrorCode::KeyNotFound);
+
+    /* Mutex locked */
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    visit_result = result.value().visit_value("kvs", [&calls](const KvsValue&) { calls++; });
+    EXPECT_FALSE(visit_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*visit_result.error()), ErrorCode::MutexLockFailed);
+    EXPECT_EQ(calls, 0U);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed_value, typed_value_success){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Scalars */
+    ASSERT_TRUE(kvs.set_value("i32", static_cast<int32_t>(-3)));
+    ASSERT_TRUE(kvs.set_value("u32", static_cast<uint32_t>(3)));
+    ASSERT_TRUE(kvs.set_value("i64", static_cast<int64_t>(-4)));
+    ASSERT_TRUE(kvs.set_value("u64", static_cast<uint64_t>(4)));
+    ASSERT_TRUE(kvs.set_value("f64", 1.5));
+    ASSERT_TRUE(kvs.set_value("bool", true));
+    ASSERT_TRUE(kvs.set_value("text", "literal"));
+    EXPECT_TRUE(kvs.get_value("i32").value() == KvsValue(static_cast<int32_t>(-3)));
+    EXPECT_EQ(kvs.get_value_as<int32_t>("i32").value(), -3);
+    EXPECT_EQ(kvs.get_value_as<uint32_t>("u32").value(), 3U);
+    EXPECT_EQ(kvs.get_value_as<int64_t>("i64").value(), -4);
+    EXPECT_EQ(kvs.get_value_as<uint64_t>("u64").value(), 4U);
+    EXPECT_EQ(kvs.get_value_as<double>("f64").value(), 1.5);
+    EXPECT_TRUE(kvs.get_value_as<bool>("bool").value());
+    EXPECT_EQ(kvs.get_value_as<std::string>(KvsKey("text")).value(), "literal");
+
+    /* Strings and containers are moved into the KVS */
+    std::string text(64U, 'x');
+    const char* text_data = text.data();
+    ASSERT_TRUE(kvs.set_value(KvsKey("moved"), std::move(text)));
+    EXPECT_EQ(std::get<std::string>(kvs.kvs.at("moved").getValue()).data(), text_data);
+
+    std::vector<std::string> names{"a", "b"};
+    ASSERT_TRUE(kvs.set_value("names", std::move(names)));
+    EXPECT_EQ(kvs.get_value_as<std::vector<std::string>>("names").value(), (std::vector<std::string>{"a", "b"}));
+
+    std::unordered_map<std::string, std::vector<double>> nested{{"x", {1.0, 2.0}}, {"y", {}}};
+    ASSERT_TRUE(kvs.set_value("nested", nested));
+    EXPECT_EQ((kvs.get_value_as<std::unordered_map<std::string, std::vector<double>>>("nested").value()), nested);
+
+    /* Default value */
+    EXPECT_EQ(kvs.get_value_as<int32_t>("default").value(), 5);
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed_value, typed_value_failure){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Numbers are not converted */
+    auto typed_result = kvs.get_value_as<int64_t>("kvs");
+    EXPECT_FALSE(typed_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*typed_result.error()), ErrorCode::InvalidValueType);
+
+    /* Containers with an element of another type */
+    ASSERT_TRUE(kvs.set_value("mixed", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(true)})));
+    auto vector_result = kvs.get_value_as<std::vector<double>>("mixed");
+    EXPECT_FALSE(vector_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*vector_result.error()), ErrorCode::InvalidValueType);
+
+    /* Missing key */
+    typed_result = kvs.get_value_as<int64_t>("missing");
+    EXPECT_FALSE(typed_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*typed_result.error()), ErrorCode::KeyNotFound);
+
+    /* Mutex locked */
+    std::unique_lock<std::shared_timed_mutex> lock(kvs.kvs_mutex);
+    auto locked_result = kvs.get_value_as<int32_t>("kvs");
+    EXPECT_FALSE(locked_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*locked_result.error()), ErrorCode::MutexLockFailed);
+    auto set_result = kvs.set_value("kvs", static_cast<int32_t>(1));
+    EXPECT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_typed_value, bytes_and_packed_storage_formats){
+
+    prepare_environment();
+    std::vector<uint8_t> blob(1000U);
+    for (size_t idx = 0; idx < blob.size(); ++idx) {
+        blob[idx] = static_cast<uint8_t>(idx * 13U);
+    }
+    KvsOptions options;
+    {
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("blob", blob));
+        ASSERT_TRUE(result.value().set_value("empty", std::vector<uint8_t>{}));
+        ASSERT_TRUE(result.value().set_value("table", KvsValue::ArrayF64{0.25, -1.5}));
+        ASSERT_TRUE(result.value().set_value("counts", KvsValue::ArrayU32{1U, 2U, 3U}));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    /* Written as JSON, read as JSON, written as binary and read again */
+    int32_t generation = 0;
+    for (const KvsStorageFormat format : {KvsStorageFormat::Json, KvsStorageFormat::Binary, KvsStorageFormat::Json}) {
+        options.storage_format = format;
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        EXPECT_EQ(kvs.get_value("blob").value().getType(), KvsValue::Type::Bytes);
+        EXPECT_EQ(kvs.get_value_as<std::vector<uint8_t>>("blob").value(), blob);
+        EXPECT_TRUE(kvs.get_value_as<std::vector<uint8_t>>("empty").value().empty());
+        EXPECT_EQ(kvs.get_value_as<KvsValue::ArrayF64>("table").value(), (KvsValue::ArrayF64{0.25, -1.5}));
+        EXPECT_EQ(kvs.get_value_as<std::vector<uint32_t>>("counts").value(), (std::vector<uint32_t>{1U, 2U, 3U}));
+        ASSERT_TRUE(kvs.set_value("generation", ++generation));
+        ASSERT_TRUE(kvs.flush());
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_move_value, move_value_allocations){
+
+    prepare_environment();
+    CountingResource resource; /* Outlives the KVS using it */
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* The KVS data is allocated from the counting resource, without a rehash while counting */
+    KvsMap counted{KvsMap::allocator_type(&resource)};
+    counted.reserve(16U);
+    counted.insert(kvs.kvs.begin(), kvs.kvs.end());
+    kvs.kvs = std::move(counted);
+    resource.allocations = 0U;
+
+    /* Owned key and moved value: only the map node is allocated, key and elements are moved */
+    std::string name(64U, 'k');
+    const char* name_data = name.data();
+    KvsValue value(std::vector<KvsValue>(1000U, KvsValue(1.0)));
+    const KvsValue* elements = &std::get<KvsValue::Array>(value.getValue())[0];
+    ASSERT_TRUE(kvs.set_value(KvsKey(std::move(name)), std::move(value)));
+    EXPECT_EQ(resource.allocations, 1U);
+    auto stored = kvs.kvs.find(std::string(64U, 'k'));
+    ASSERT_NE(stored, kvs.kvs.end());
+    EXPECT_EQ(stored->first.data(), name_data);
+    EXPECT_EQ(&std::get<KvsValue::Array>(stored->second.getValue())[0], elements);
+
+    /* Existing key: the value is replaced without an allocation */
+    ASSERT_TRUE(kvs.set_value(KvsKey(std::string(64U, 'k')), KvsValue(2.0)));
+    ASSERT_TRUE(kvs.set_value(std::string(64U, 'k'), KvsValue(3.0)));
+    EXPECT_EQ(resource.allocations, 1U);
+    EXPECT_EQ(kvs.get_value_as<double>(std::string(64U, 'k')).value(), 3.0);
+
+    /* emplace_value: constructed from the arguments and moved into the KVS */
+    KvsValue::Array array(std::vector<KvsValue>{KvsValue("a"), KvsValue("b")});
+    const KvsValue* array_elements = &array[0];
+    ASSERT_TRUE(kvs.emplace_value("array", std::move(array)));
+    ASSERT_TRUE(kvs.emplace_value(KvsKey("text"), "literal"));
+    ASSERT_TRUE(kvs.emplace_value(KvsKey(std::string("number")), static_cast<int32_t>(7)));
+    EXPECT_EQ(resource.allocations, 4U);
+    EXPECT_EQ(&std::get<KvsValue::Array>(kvs.kvs.at("array").getValue())[0], array_elements);
+    EXPECT_EQ(kvs.get_value_as<std::string>("text").value(), "literal");
+    EXPECT_EQ(kvs.get_value_as<int32_t>("number").value(), 7);
+    EXPECT_TRUE(kvs.emplace_value("unchanged", static_cast<int32_t>(7)));
+    EXPECT_TRUE(kvs.set_value(KvsKey(std::string("typed")), std::vector<double>{1.0}));
+    EXPECT_EQ(kvs.get_value_as<std::vector<double>>("typed").value(), std::vector<double>{1.0});
+
+    /* Write batch: the moved value is stored without copying the elements */
+    KvsValue batch_value(std::vector<KvsValue>(10U, KvsValue(true)));
+    const KvsValue* batch_elements = &std::get<KvsValue::Array>(batch_value.getValue())[0];
+    KvsWriteBatch batch;
+    batch.set_value("batch", std::move(batch_value));
+    ASSERT_TRUE(kvs.commit(batch));
+    EXPECT_EQ(&std::get<KvsValue::Array>(kvs.kvs.at("batch").getValue())[0], batch_elements);
+
+    cleanup_environment();
+}
+
+TEST(kvs_get_values, get_values_success){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Written value, default value and missing key */
+    std::vector<std::optional<KvsValue>> values(5U, KvsValue(1.0)); /* Existing elements are overwritten */
+    ASSERT_TRUE(kvs.get_values({"kvs", "default", "missing"}, values));
+    ASSERT_EQ(values.size(), 3U);
+    EXPECT_TRUE(values[0].value() == KvsValue(static_cast<int32_t>(2)));
+    EXPECT_TRUE(values[1].value() == KvsValue(static_cast<int32_t>(5)));
+    EXPECT_FALSE(values[2]);
+
+    /* Sharded and read-mostly mode */
+    for (bool read_mostly : {false, true}) {
+        KvsOptions options;
+        options.read_mostly = read_mostly;
+        options.shard_count = 4U;
+        auto sharded = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(sharded);
+        ASSERT_TRUE(sharded.value().set_value("key1", KvsValue(1.0)));
+        ASSERT_TRUE(sharded.value().get_values({"key1", "kvs", "default", "missing"}, values));
+        ASSERT_EQ(values.size(), 4U);
+        EXPECT_TRUE(values[0].value() == KvsValue(1.0));
+        EXPECT_TRUE(values[1].value() == KvsValue(static_cast<int32_t>(2)));
+        EXPECT_TRUE(values[2].value() == KvsValue(static_cast<int32_t>(5)));
+        EXPECT_FALSE(values[3]);
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_get_values, get_values_failure_mutex){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    std::vector<std::optional<KvsValue>> values;
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    auto get_values_result = result.value().get_values({"kvs"}, values);
+    EXPECT_FALSE(get_values_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*get_values_result.error()), ErrorCode::MutexLockFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_set_values, set_values_success){
+
+    prepare_environment();
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    const uint64_t generation = kvs.current_generation();
+    ASSERT_TRUE(kvs.set_values({{"key1", KvsValue(1.0)}, {"key2", KvsValue(2.0)}, {"key1", KvsValue(3.0)}}));
+    EXPECT_EQ(kvs.current_generation(), generation + 1U);
+    EXPECT_TRUE(kvs.get_value("key1").value() == KvsValue(3.0));
+    EXPECT_TRUE(kvs.get_value("key2").value() == KvsValue(2.0));
+
+    /* Mutex locked: no value is changed */
+    std::unique_lock<std::shared_timed_mutex> lock(kvs.kvs_mutex);
+    auto set_values_result = kvs.set_values({{"key1", KvsValue(4.0)}});
+    EXPECT_FALSE(set_values_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_values_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+    EXPECT_TRUE(kvs.get_value("key1").value() == KvsValue(3.0));
+
+    cleanup_environment();
+}
+
+TEST(kvs_key, key_functions){
+
+    prepare_environment();
+
+    /* Default, sharded and read-mostly mode */
+    for (size_t mode = 0; mode < 3U; mode++) {
+        KvsOptions options;
+        options.shard_count = (1U == mode) ? 4U : 1U;
+        options.read_mostly = (2U == mode);
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+
+        const KvsKey key("a_key_longer_than_the_small_string_buffer");
+        const KvsKey default_key("default");
+        EXPECT_EQ(key.hash(), std::hash<std::string_view>{}("a_key_longer_than_the_small_string_buffer"));
+        EXPECT_FALSE(kvs.key_exists(key).value());
+        ASSERT_TRUE(kvs.set_value(key, KvsValue(1.0)));
+        EXPECT_TRUE(kvs.key_exists(key).value());
+        EXPECT_TRUE(kvs.get_value(key).value() == KvsValue(1.0));
+        EXPECT_TRUE(kvs.get_value(key.name()).value() == KvsValue(1.0)); /* Same key as std::string_view */
+        EXPECT_TRUE(kvs.remove_key(key));
+        EXPECT_EQ(static_cast<ErrorCode>(*kvs.remove_key(key).error()), ErrorCode::KeyNotFound);
+
+        EXPECT_TRUE(kvs.has_default_value(default_key).value());
+        EXPECT_FALSE(kvs.has_default_value(key).value());
+        EXPECT_TRUE(kvs.get_default_value(default_key).value() == KvsValue(static_cast<int32_t>(5)));
+        ASSERT_TRUE(kvs.set_value(default_key, KvsValue(6.0)));
+        ASSERT_TRUE(kvs.reset_key(default_key));
+        EXPECT_TRUE(kvs.get_value(default_key).value() == KvsValue(static_cast<int32_t>(5)));
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_key, key_assign_reuse){
+
+    /* The functions taking several std::string_view keys reuse one KvsKey on their stack */
+    KvsKey key;
+    key.assign("a_key_longer_than_the_small_string_buffer");
+    const char* storage = key.name().data();
+    key.assign("key");
+    EXPECT_EQ(key.name(), "key");
+    EXPECT_EQ(key.hash(), std::hash<std::string_view>{}("key"));
+    EXPECT_EQ(key.name().data(), storage); /* No new allocation for a shorter key */
+}
+
+TEST(kvs_key, string_view_keys_of_several_instances){
+
+    prepare_environment();
+
+    /* The std::string_view functions don't share a key between instances or nested calls */
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    auto result_other = Kvs::open(InstanceId(1), OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result_other);
+    ASSERT_TRUE(result.value().set_value("outer", KvsValue(1.0)));
+    ASSERT_TRUE(result_other.value().set_value("inner", KvsValue(2.0)));
+    bool visited = false;
+    ASSERT_TRUE(result.value().visit_value("outer", [&](const KvsValue& value) {
+        EXPECT_TRUE(result_other.value().key_exists("inner").value());
+        EXPECT_EQ(std::get<double>(value.getValue()), 1.0);
+        visited = true;
+    }));
+    EXPECT_TRUE(visited);
+    EXPECT_TRUE(result.value().key_exists("outer").value());
+    EXPECT_FALSE(result.value().key_exists("inner").value());
+
+    cleanup_environment();
+}
+
 TEST(kvs_write_json_data, write_json_data_success){
 
     prepare_environment();
-    /* Test writing valid JSON data, also checks get_hash_bytes_adler32 and get_hash_bytes*/
-    const char* json_test_data = R"({
-        "booltest": {
-            "t": "bool",
-            "v": 1
-        },
-    })";
+    /* Test writing valid JSON data, also checks get_hash_bytes_adler32*/
+    const std::string json_test_data = R"({"booltest":{"t":"bool","v":true}})";
+    KvsMap test_data;
+    test_data.emplace("booltest", KvsValue(true));
     system(("rm -rf " + kvs_prefix + ".json").c_str());
     system(("rm -rf " + kvs_prefix + ".hash").c_str());
 
     auto kvs = Kvs::open(InstanceId(instance_id), OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
 
-    kvs->filename_prefix = score::filesystem::Path(filename_prefix); /* Set the filename prefix to the test prefix */
-    auto result = kvs->write_json_data(json_test_data);
-    EXPECT_TRUE(result);
+    auto result = kvs->write_json_data(test_data, kvs_prefix + ".json");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value(), adler32(json_test_data));
+    auto hash_result = kvs->write_hash_data(result.value(), kvs_prefix + ".hash");
+    EXPECT_TRUE(hash_result);
     EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".json"));
     EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".hash"));
 
@@ -670,14 +1123,13 @@ TEST(kvs_write_json_data, write_json_data_filesystem_failure){
         .WillOnce(::testing::Return(score::ResultBlank(score::MakeUnexpected(score::filesystem::ErrorCode::kCouldNotCreateDirectory))));
     kvs.value().filesystem = std::make_unique<score::filesystem::Filesystem>(std::move(mock_filesystem));
 
-    auto result = kvs->write_json_data(kvs_json);
+    auto result = kvs->write_json_data(kvs->kvs, kvs_prefix + ".json");
     EXPECT_FALSE(result);
     EXPECT_EQ(result.error(), ErrorCode::PhysicalStorageFailure);
 
 
     /* Test if path argument is missing parent path (will only occur if semantic errors will be done in flush() )*/
-    kvs->filename_prefix = score::filesystem::Path("no_parent_path"); /* Set the filename prefix to the test prefix */
-    result = kvs->write_json_data(kvs_json);
+    result = kvs->write_json_data(kvs->kvs, score::filesystem::Path("no_parent_path.json"));
     EXPECT_FALSE(result);
     EXPECT_EQ(result.error(), ErrorCode::PhysicalStorageFailure);
 
@@ -697,18 +1149,16 @@ TEST(kvs_write_json_data, write_json_data_permissions_failure){
     out_hash << "data";
     out_hash.close();
     std::filesystem::permissions(kvs_prefix + ".hash", std::filesystem::perms::owner_read, std::filesystem::perm_options::replace);
-    kvs->filename_prefix = score::filesystem::Path(filename_prefix); /* Reset the filename prefix to the test prefix */
-    auto result = kvs->write_json_data(kvs_json);
-    EXPECT_FALSE(result);
-    EXPECT_EQ(result.error(), ErrorCode::PhysicalStorageFailure);
+    auto hash_result = kvs->write_hash_data(adler32(kvs_json), kvs_prefix + ".hash");
+    EXPECT_FALSE(hash_result);
+    EXPECT_EQ(hash_result.error(), ErrorCode::PhysicalStorageFailure);
 
     /* Test writing to a non-writable kvs file */
     std::ofstream out_json(kvs_prefix + ".json");
     out_json << "data";
     out_json.close();
     std::filesystem::permissions(kvs_prefix + ".json", std::filesystem::perms::owner_read, std::filesystem::perm_options::replace);
-    kvs->filename_prefix = score::filesystem::Path(filename_prefix); /* Reset the filename prefix to the test prefix */
-    result = kvs->write_json_data(kvs_json);
+    auto result = kvs->write_json_data(kvs->kvs, kvs_prefix + ".json");
     EXPECT_FALSE(result);
     EXPECT_EQ(result.error(), ErrorCode::PhysicalStorageFailure);
 
@@ -716,118 +1166,116 @@ TEST(kvs_write_json_data, write_json_data_permissions_failure){
 
 }
 
-TEST(kvs_snapshot_rotate, snapshot_rotate_success){
+TEST(kvs_snapshot_scan, snapshot_scan_success){
 
     prepare_environment();
 
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
+    ASSERT_EQ(result.value().snapshot_files.size(), 1U); /* Legacy KVS file _0 */
+    EXPECT_EQ(result.value().snapshot_generation, 0U);
 
-    /* Create empty Test-Snapshot Files */
+    /* Create generation files, legacy snapshots and files which are no KVS files */
     for (size_t i = 1; i < KVS_MAX_SNAPSHOTS; i++) {
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".hash") << "{}";
-        EXPECT_EQ(result.value().snapshot_count().value(), i);
     }
-    ASSERT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".json"));
-    ASSERT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".hash"));
-
-    /* Rotate Snapshots */
-    auto rotate_result = result.value().snapshot_rotate();
-    ASSERT_TRUE(rotate_result);
-
-    /* Check if the snapshot ids are rotated and no ID 0 exists */
-    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".json"));
-    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".hash"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(0) + ".json"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(0) + ".hash"));
+    std::ofstream(filename_prefix + "_g5.json") << "{}";
+    std::ofstream(filename_prefix + "_g5.hash") << "{}";
+    std::ofstream(filename_prefix + "_g12.bin") << "bin";
+    std::ofstream(filename_prefix + "_g.json") << "{}";
+    std::ofstream(filename_prefix + "_x1.json") << "{}";
+    std::ofstream(filename_prefix + "_g7.tmp") << "{}";
+    std::ofstream(filename_prefix + "0_g9.json") << "{}"; /* KVS instance 10 */
+
+    /* Generation files newest first, followed by the legacy files */
+    ASSERT_TRUE(result.value().snapshot_scan());
+    const auto& files = result.value().snapshot_files;
+    ASSERT_EQ(files.size(), 2U + KVS_MAX_SNAPSHOTS);
+    EXPECT_EQ(files[0].prefix.Native(), filename_prefix + "_g12");
+    EXPECT_TRUE(files[0].binary);
+    EXPECT_EQ(files[1].prefix.Native(), filename_prefix + "_g5");
+    EXPECT_FALSE(files[1].binary);
+    for (size_t i = 0; i < KVS_MAX_SNAPSHOTS; i++) {
+        EXPECT_EQ(files[2U + i].prefix.Native(), filename_prefix + "_" + std::to_string(i));
+        EXPECT_EQ(files[2U + i].generation, 0U);
+    }
+    EXPECT_EQ(result.value().snapshot_generation, 12U);
+    EXPECT_EQ(result.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS);
 
     cleanup_environment();
 }
 
-TEST(kvs_snapshot_rotate, snapshot_rotate_max_snapshots){
+TEST(kvs_snapshot_scan, snapshot_scan_legacy_gap){
 
     prepare_environment();
 
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    /* Create empty Test-Snapshot Files */
-    for (size_t i = 1; i < KVS_MAX_SNAPSHOTS; i++) {
-        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
-        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".hash") << "{}";
-        EXPECT_EQ(result.value().snapshot_count().value(), i);
-    }
-    ASSERT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".json"));
-    ASSERT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".hash"));
-
-    /* Check if no ID higher than KVS_MAX_SNAPSHOTS exists */
-    auto rotate_result = result.value().snapshot_rotate();
-    ASSERT_TRUE(rotate_result);
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS + 1) + ".json"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS + 1) + ".hash"));
+    /* Legacy snapshots are only used up to the first missing ID */
+    std::ofstream(filename_prefix + "_1.json") << "{}";
+    std::ofstream(filename_prefix + "_3.json") << "{}";
+    ASSERT_TRUE(result.value().snapshot_scan());
+    ASSERT_EQ(result.value().snapshot_files.size(), 2U);
+    EXPECT_EQ(result.value().snapshot_count().value(), 1U);
 
     cleanup_environment();
 }
 
-TEST(kvs_snapshot_rotate, snapshot_rotate_failure_renaming_json){
+TEST(kvs_snapshot_prune, snapshot_prune_max_snapshots){
 
     prepare_environment();
 
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    /* Create empty Test-Snapshot Files */
-    for (size_t i = 1; i < KVS_MAX_SNAPSHOTS; i++) {
-        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
-        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".hash") << "{}";
-        EXPECT_EQ(result.value().snapshot_count().value(), i);
+    /* Every flush adds one generation, the oldest files exceeding the maximum count are removed */
+    for (size_t i = 1; i <= KVS_MAX_SNAPSHOTS + 2U; i++) {
+        ASSERT_TRUE(result.value().set_value("counter", KvsValue(static_cast<int32_t>(i))));
+        ASSERT_TRUE(result.value().flush());
+        EXPECT_EQ(result.value().snapshot_count().value(), std::min<size_t>(i, KVS_MAX_SNAPSHOTS));
+        EXPECT_EQ(result.value().get_kvs_filename(SnapshotId(0)).value().Native(), filename_prefix + "_g" + std::to_string(i) + ".json");
     }
-
-    /* Snapshot (JSON) Renaming failed (Create directorys instead of json files to trigger rename error)*/
-    std::filesystem::create_directory(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".json");
-    auto rotate_result = result.value().snapshot_rotate();
-    EXPECT_FALSE(rotate_result);
-    EXPECT_EQ(static_cast<ErrorCode>(*rotate_result.error()), ErrorCode::PhysicalStorageFailure);
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".json"));
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".hash"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.hash"));
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g2.json"));
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g2.hash"));
+
+    /* The same files are found after reopening */
+    auto reopened = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(reopened);
+    EXPECT_EQ(reopened.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS);
+    EXPECT_EQ(reopened.value().snapshot_generation, KVS_MAX_SNAPSHOTS + 2U);
+    EXPECT_TRUE(reopened.value().get_value("counter").value() == KvsValue(static_cast<int32_t>(KVS_MAX_SNAPSHOTS + 2U)));
 
     cleanup_environment();
 }
 
-TEST(kvs_snapshot_rotate, snapshot_rotate_failure_renaming_hash){
+TEST(kvs_snapshot_prune, snapshot_prune_failure_remove){
 
     prepare_environment();
 
-    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
-    ASSERT_TRUE(result);
-
-    /* Create empty Test-Snapshot Files */
+    /* Oldest snapshot can't be removed (non-empty directory instead of a file) */
     for (size_t i = 1; i < KVS_MAX_SNAPSHOTS; i++) {
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
-        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".hash") << "{}";
-        EXPECT_EQ(result.value().snapshot_count().value(), i);
     }
-
-    /* Hash Renaming failed (Create directorys instead of json files to trigger rename error)*/
-    std::filesystem::create_directory(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".hash");
-    auto rotate_result = result.value().snapshot_rotate();
-    EXPECT_FALSE(rotate_result);
-    EXPECT_EQ(static_cast<ErrorCode>(*rotate_result.error()), ErrorCode::PhysicalStorageFailure);
-
-    cleanup_environment();
-}
-
-TEST(kvs_snapshot_rotate, snapshot_rotate_failure_mutex){
-
-    prepare_environment();
+    const std::string oldest = filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS) + ".json";
+    std::filesystem::create_directory(oldest);
+    std::ofstream(oldest + "/file") << "{}";
 
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
+    ASSERT_EQ(result.value().snapshot_files.size(), KVS_MAX_SNAPSHOTS + 1U);
 
-    /* Mutex locked */
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
-    auto rotate_result = result.value().snapshot_rotate();
-    EXPECT_FALSE(rotate_result);
-    EXPECT_EQ(static_cast<ErrorCode>(*rotate_result.error()), ErrorCode::MutexLockFailed);
+    /* The flush succeeds anyway, the snapshot is no longer used */
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(oldest));
+    EXPECT_EQ(result.value().snapshot_files.size(), KVS_MAX_SNAPSHOTS + 1U);
+    EXPECT_EQ(result.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS);
 
     cleanup_environment();
 }
@@ -849,15 +1297,15 @@ TEST(kvs_flush, flush_success_data){
     ASSERT_TRUE(flush_result);
 
     /* Check if files were created correctly */
-    EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".json"));
-    EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".hash"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.json"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.hash"));
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.hash"));
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".json"));
+    EXPECT_EQ(result.value().snapshot_count().value(), 0U);
 
     cleanup_environment();
 }
 
-TEST(kvs_flush, flush_success_snapshot_rotate){
+TEST(kvs_flush, flush_success_new_generation){
 
     prepare_environment();
 
@@ -867,16 +1315,94 @@ TEST(kvs_flush, flush_success_snapshot_rotate){
 
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.json"));
-    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_1.hash"));
+    EXPECT_EQ(result.value().snapshot_count().value(), 0U);
 
     result.value().flush(); /* Initial Flush -> SnapshotID 0 */
 
-    /* Check if snapshot_rotate was triggered on second flush --> one snapshot should be available afterwards */
+    /* Second flush writes a new generation, the previous KVS file becomes snapshot 1 */
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0))); /* Unmodified KVS would not be flushed */
     auto flush_result = result.value().flush();
     ASSERT_TRUE(flush_result);
-    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_1.json"));
-    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_1.hash"));
+    EXPECT_EQ(result.value().snapshot_count().value(), 1U);
+    EXPECT_EQ(result.value().get_kvs_filename(SnapshotId(0)).value().Native(), filename_prefix + "_g2.json");
+    EXPECT_EQ(result.value().get_hash_filename(SnapshotId(0)).value().Native(), filename_prefix + "_g2.hash");
+    EXPECT_EQ(result.value().get_kvs_filename(SnapshotId(1)).value().Native(), filename_prefix + "_g1.json");
+    EXPECT_EQ(result.value().get_hash_filename(SnapshotId(1)).value().Native(), filename_prefix + "_g1.hash");
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush, flush_skip_unmodified){
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    /* Opened KVS file is unmodified -> no new generation */
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    auto stats = result.value().flush_statistics();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats.value().written, 0U);
+    EXPECT_EQ(stats.value().skipped, 1U);
+
+    /* Setting the current value doesn't modify the KVS */
+    ASSERT_TRUE(result.value().set_value("kvs", KvsValue(static_cast<int32_t>(2))));
+    ASSERT_TRUE(result.value().reset_key("default")); /* Not set, only default value */
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+
+    /* Modified KVS is written once */
+    ASSERT_TRUE(result.value().set_value("kvs", KvsValue(static_cast<int32_t>(3))));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g2.json"));
+    stats = result.value().flush_statistics();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats.value().written, 1U);
+    EXPECT_EQ(stats.value().skipped, 3U);
+
+    /* Every modifying call marks the KVS dirty */
+    ASSERT_TRUE(result.value().remove_key("kvs"));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().set_value("default", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().reset_key("default"));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().reset());
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().reset()); /* Already empty */
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    ASSERT_TRUE(result.value().flush());
+    stats = result.value().flush_statistics();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats.value().written, 7U);
+    EXPECT_EQ(stats.value().skipped, 3U);
+
+    /* Mutex locked */
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.value().flush_statistics().error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush, flush_new_kvs_dirty){
+
+    prepare_environment();
+    system(("rm -rf " + kvs_prefix + ".json").c_str());
+    system(("rm -rf " + kvs_prefix + ".hash").c_str());
+
+    /* No KVS file exists -> first flush creates it */
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_EQ(result.value().flush_statistics().value().written, 1U);
 
     cleanup_environment();
 }
@@ -888,7 +1414,7 @@ TEST(kvs_flush, flush_failure_mutex){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     auto flush_result = result.value().flush();
     EXPECT_FALSE(flush_result);
     EXPECT_EQ(static_cast<ErrorCode>(*flush_result.error()), ErrorCode::MutexLockFailed);
@@ -896,7 +1422,370 @@ TEST(kvs_flush, flush_failure_mutex){
     cleanup_environment();
 }
 
-TEST(kvs_flush, flush_failure_rotate_snapshots){
+TEST(kvs_lock_policy, lock_policy_shared_readers){
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    /* Readers share the KVS with another reader (e.g. a running flush) */
+    std::shared_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    EXPECT_TRUE(result.value().get_value("kvs"));
+    EXPECT_TRUE(result.value().key_exists("kvs"));
+    EXPECT_TRUE(result.value().get_all_keys());
+    EXPECT_TRUE(result.value().flush_statistics());
+    EXPECT_TRUE(result.value().flush()); /* Unmodified */
+
+    /* Writers need exclusive access */
+    auto set_result = result.value().set_value("key1", KvsValue(1.0));
+    ASSERT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_lock_policy, lock_policy_timed){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.lock_policy = KvsLockPolicy::Timed;
+    options.lock_timeout = std::chrono::milliseconds(1);
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+
+    /* Lock is not released within the timeout */
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    auto get_result = result.value().get_value("kvs");
+    ASSERT_FALSE(get_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*get_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+    EXPECT_TRUE(result.value().get_value("kvs"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_lock_policy, lock_policy_blocking){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.lock_policy = KvsLockPolicy::Blocking;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Readers and writers wait for each other instead of failing */
+    std::atomic<size_t> failures{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4U; t++) {
+        threads.emplace_back([&kvs, &failures, t]() {
+            for (int32_t i = 0; i < 200; i++) {
+                if (0U == t) {
+                    failures += kvs.set_value("counter", KvsValue(i)) ? 0U : 1U;
+                    failures += ((0 == (i % 50)) && !kvs.flush()) ? 1U : 0U;
+                }else{
+                    failures += kvs.get_value("kvs") ? 0U : 1U;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0U);
+    EXPECT_TRUE(kvs.get_value("counter").value() == KvsValue(static_cast<int32_t>(199)));
+
+    cleanup_environment();
+}
+
+TEST(kvs_sharded, sharded_set_get_remove){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.shard_count = 4U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* KVS file data is distributed over the shards */
+    ASSERT_EQ(kvs.shards.size(), 4U);
+    EXPECT_TRUE(kvs.kvs.empty());
+    EXPECT_TRUE(kvs.get_value("kvs").value() == KvsValue(static_cast<int32_t>(2)));
+    EXPECT_TRUE(kvs.key_exists("kvs").value());
+
+    for (int32_t i = 0; i < 32; i++) {
+        EXPECT_TRUE(kvs.set_value("key" + std::to_string(i), KvsValue(i)));
+    }
+    EXPECT_EQ(kvs.get_all_keys().value().size(), 33U);
+    for (int32_t i = 0; i < 32; i++) {
+        const std::string key = "key" + std::to_string(i);
+        EXPECT_EQ(kvs.shards[kvs.shard_index(key)]->data.count(key), 1U);
+        EXPECT_TRUE(kvs.get_value(key).value() == KvsValue(i));
+    }
+    EXPECT_TRUE(kvs.remove_key("key0"));
+    EXPECT_FALSE(kvs.key_exists("key0").value());
+    auto remove_result = kvs.remove_key("key0");
+    ASSERT_FALSE(remove_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*remove_result.error()), ErrorCode::KeyNotFound);
+
+    EXPECT_TRUE(kvs.reset());
+    EXPECT_TRUE(kvs.get_all_keys().value().empty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_sharded, sharded_shard_lock){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.shard_count = 2U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Find keys in both shards */
+    std::string key_locked;
+    std::string key_free;
+    for (size_t i = 0; key_locked.empty() || key_free.empty(); i++) {
+        const std::string key = "key" + std::to_string(i);
+        (0U == kvs.shard_index(key) ? key_locked : key_free) = key;
+    }
+
+    /* Writers of other shards are not blocked */
+    std::unique_lock<std::shared_timed_mutex> lock(kvs.shards[0]->mutex);
+    EXPECT_TRUE(kvs.set_value(key_free, KvsValue(1.0)));
+    EXPECT_TRUE(kvs.get_value(key_free));
+    auto set_result = kvs.set_value(key_locked, KvsValue(1.0));
+    ASSERT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::MutexLockFailed);
+
+    /* Functions on the complete data need all shards */
+    auto keys_result = kvs.get_all_keys();
+    ASSERT_FALSE(keys_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*keys_result.error()), ErrorCode::MutexLockFailed);
+    lock.unlock();
+    EXPECT_TRUE(kvs.set_value(key_locked, KvsValue(1.0)));
+
+    /* The exclusive KVS lock blocks all shards */
+    std::unique_lock<std::shared_timed_mutex> lock_kvs(kvs.kvs_mutex);
+    set_result = kvs.set_value(key_free, KvsValue(2.0));
+    ASSERT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::MutexLockFailed);
+    lock_kvs.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_sharded, sharded_parallel_writers){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.shard_count = 8U;
+    options.lock_policy = KvsLockPolicy::Blocking;
+    options.wal_enabled = true;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    std::atomic<size_t> failures{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4U; t++) {
+        threads.emplace_back([&kvs, &failures, t]() {
+            for (int32_t i = 0; i < 100; i++) {
+                failures += kvs.set_value("t" + std::to_string(t) + "_" + std::to_string(i), KvsValue(i)) ? 0U : 1U;
+                failures += ((0U == t) && (0 == (i % 25)) && !kvs.flush()) ? 1U : 0U;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0U);
+    EXPECT_EQ(kvs.get_all_keys().value().size(), 401U);
+
+    /* Flushed data and WAL records are read back completely (without sharding) */
+    ASSERT_TRUE(kvs.flush());
+    auto reopen = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(reopen);
+    EXPECT_EQ(reopen.value().kvs.size(), 401U);
+    EXPECT_TRUE(reopen.value().get_value("t3_99").value() == KvsValue(static_cast<int32_t>(99)));
+
+    cleanup_environment();
+}
+
+TEST(kvs_sharded, sharded_snapshot_restore){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.shard_count = 3U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    ASSERT_TRUE(kvs.set_value("restored", KvsValue(true)));
+    ASSERT_TRUE(kvs.flush());
+    ASSERT_TRUE(kvs.remove_key("restored"));
+    ASSERT_TRUE(kvs.set_value("dropped", KvsValue(true)));
+    ASSERT_TRUE(kvs.flush());
+
+    ASSERT_TRUE(kvs.snapshot_restore(1));
+    EXPECT_TRUE(kvs.key_exists("restored").value());
+    EXPECT_FALSE(kvs.key_exists("dropped").value());
+    EXPECT_TRUE(kvs.get_value("kvs").value() == KvsValue(static_cast<int32_t>(2)));
+    EXPECT_EQ(kvs.shards[kvs.shard_index("restored")]->data.count("restored"), 1U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, flush_async_success){
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    ASSERT_TRUE(kvs.set_value("key1", KvsValue(1.0)));
+    const uint64_t generation = kvs.current_generation();
+    auto durable_result = kvs.wait_durable(generation, std::chrono::milliseconds(0));
+    ASSERT_FALSE(durable_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*durable_result.error()), ErrorCode::ResourceBusy);
+
+    /* Manual policy: only the requested flush is done by the worker */
+    std::future<score::ResultBlank> flushed = kvs.flush_async();
+    EXPECT_TRUE(flushed.get());
+    EXPECT_TRUE(kvs.wait_durable(generation, std::chrono::milliseconds(0)));
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_EQ(kvs.flush_statistics().value().written, 1U);
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, idle_worker_does_not_flush){
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    ASSERT_TRUE(kvs.set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(kvs.flush_async().get());
+    const KvsFlushStatistics before = kvs.flush_statistics().value();
+
+    /* Without a request or deadline the worker waits and doesn't flush */
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const KvsFlushStatistics after = kvs.flush_statistics().value();
+    EXPECT_EQ(after.written, before.written);
+    EXPECT_EQ(after.skipped, before.skipped);
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, background_flush_delay){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.flush_policy = KvsFlushPolicy::Background;
+    options.flush_delay = std::chrono::milliseconds(20);
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* A burst of changes is coalesced into one flush */
+    for (int32_t i = 0; i < 10; i++) {
+        ASSERT_TRUE(kvs.set_value("key" + std::to_string(i), KvsValue(i)));
+    }
+    EXPECT_TRUE(kvs.wait_durable(kvs.current_generation(), std::chrono::milliseconds(5000)));
+    EXPECT_EQ(kvs.flush_statistics().value().written, 1U);
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, background_flush_change_count){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.flush_policy = KvsFlushPolicy::Background;
+    options.flush_delay = std::chrono::milliseconds(3600000);
+    options.flush_change_count = 3U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    ASSERT_TRUE(kvs.set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(kvs.set_value("key2", KvsValue(2.0)));
+    auto durable_result = kvs.wait_durable(kvs.current_generation(), std::chrono::milliseconds(20));
+    ASSERT_FALSE(durable_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*durable_result.error()), ErrorCode::ResourceBusy);
+
+    ASSERT_TRUE(kvs.set_value("key3", KvsValue(3.0)));
+    EXPECT_TRUE(kvs.wait_durable(kvs.current_generation(), std::chrono::milliseconds(5000)));
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, background_flush_on_close){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.flush_policy = KvsFlushPolicy::Background;
+    options.flush_delay = std::chrono::milliseconds(3600000);
+    {
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().worker_thread.joinable());
+    }
+
+    /* Pending changes are flushed when the KVS is closed */
+    auto reopen = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(reopen);
+    EXPECT_TRUE(reopen.value().get_value("key1").value() == KvsValue(1.0));
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush_worker, wait_durable_wal){
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.wal_enabled = true;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.value().wait_durable(result.value().current_generation(), std::chrono::milliseconds(0)));
+
+    /* Changes are persisted by syncing the write-ahead log */
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    EXPECT_TRUE(result.value().wait_durable(result.value().current_generation(), std::chrono::milliseconds(0)));
+
+    /* A generation not reached yet is only durable after a flush containing it, the timeout applies */
+    auto future_result = result.value().wait_durable(result.value().current_generation() + 1U, std::chrono::milliseconds(20));
+    ASSERT_FALSE(future_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*future_result.error()), ErrorCode::ResourceBusy);
+
+    /* Sync failure: the WAL was removed */
+    std::filesystem::remove(filename_prefix + "_0.wal");
+    auto durable_result = result.value().wait_durable(result.value().current_generation(), std::chrono::milliseconds(0));
+    ASSERT_FALSE(durable_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*durable_result.error()), ErrorCode::PhysicalStorageFailure);
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush, flush_failure_read_only_dir){
 
     prepare_environment();
     /* Test Folder for permission handling */
@@ -922,7 +1811,7 @@ TEST(kvs_flush, flush_failure_kvsvalue_invalid){
     ASSERT_TRUE(result);
 
     BrokenKvsValue invalid;
-    result.value().kvs.insert({"invalid_key", invalid});
+    ASSERT_TRUE(result.value().set_value("invalid_key", invalid));
 
     auto flush_result_invalid = result.value().flush();
     EXPECT_FALSE(flush_result_invalid);
@@ -931,21 +1820,64 @@ TEST(kvs_flush, flush_failure_kvsvalue_invalid){
     cleanup_environment();
 }
 
-TEST(kvs_flush, flush_failure_json_writer){
+TEST(kvs_flush, flush_json_writer_unused){
 
     prepare_environment();
 
     auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
 
-    auto mock_writer = std::make_unique<score::json::IJsonWriterMock>(); /* Force error in writer.ToBuffer */
-    EXPECT_CALL(*mock_writer, ToBuffer(::testing::A<const score::json::Object&>()))
-        .WillOnce(::testing::Return(score::Result<std::string>(score::MakeUnexpected(score::json::Error::kUnknownError))));
+    /* KVS data is streamed to the file, the JSON writer is not involved */
+    auto mock_writer = std::make_unique<score::json::IJsonWriterMock>();
+    EXPECT_CALL(*mock_writer, ToBuffer(::testing::A<const score::json::Object&>())).Times(0);
 
     kvs->writer = std::move(mock_writer);
+    ASSERT_TRUE(kvs.value().set_value("key1", KvsValue(1.0)));
     auto result = kvs.value().flush();
-    EXPECT_FALSE(result);
-    EXPECT_EQ(result.error(), ErrorCode::JsonGeneratorError);
+    EXPECT_TRUE(result);
+
+    auto reopened = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(reopened);
+    EXPECT_TRUE(reopened.value().kvs.count("key1"));
+    EXPECT_TRUE(reopened.value().kvs.count("kvs"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_flush, flush_failure_keeps_current_file){
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+
+    /* Serialization fails before a new generation is written */
+    BrokenKvsValue invalid;
+    ASSERT_TRUE(result.value().set_value("invalid_key", invalid));
+    EXPECT_FALSE(result.value().flush());
+    EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".json"));
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".tmp"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+
+    /* Staged file can't be written */
+    ASSERT_TRUE(result.value().remove_key("invalid_key"));
+    std::filesystem::create_directory(kvs_prefix + ".tmp");
+    auto flush_result = result.value().flush();
+    ASSERT_FALSE(flush_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*flush_result.error()), ErrorCode::PhysicalStorageFailure);
+    EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".json"));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    std::filesystem::remove(kvs_prefix + ".tmp");
+
+    /* Hash file can't be written -> the KVS file of the new generation is not published */
+    std::filesystem::create_directories(filename_prefix + "_g1.hash/dir");
+    flush_result = result.value().flush();
+    ASSERT_FALSE(flush_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*flush_result.error()), ErrorCode::PhysicalStorageFailure);
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.json"));
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".tmp"));
+    EXPECT_EQ(result.value().snapshot_count().value(), 0U);
+    EXPECT_EQ(result.value().get_kvs_filename(SnapshotId(0)).value().Native(), kvs_prefix + ".json");
 
     cleanup_environment();
 }
@@ -960,12 +1892,14 @@ TEST(kvs_snapshot_count, snapshot_count_success){
     /* Create empty Test-Snapshot Files */
     for (size_t i = 1; i <= KVS_MAX_SNAPSHOTS; i++) {
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
+        ASSERT_TRUE(result.value().snapshot_scan());
         auto count = result.value().snapshot_count();
         EXPECT_TRUE(count);
         EXPECT_EQ(count.value(), i);
     }
     /* Test maximum capacity */
     std::ofstream(filename_prefix + "_" + std::to_string(KVS_MAX_SNAPSHOTS + 1) + ".json") << "{}";
+    ASSERT_TRUE(result.value().snapshot_scan());
     auto count = result.value().snapshot_count();
     EXPECT_TRUE(count);
     EXPECT_EQ(count.value(), KVS_MAX_SNAPSHOTS);
@@ -978,6 +1912,8 @@ TEST(kvs_snapshot_count, snapshot_count_invalid){
 
     auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
+    std::ofstream(filename_prefix + "_1.json") << "{}";
+    ASSERT_TRUE(kvs.value().snapshot_scan());
 
     /* Mock Filesystem */
     score::filesystem::Filesystem mock_filesystem = score::filesystem::CreateMockFileSystem();
@@ -1026,6 +1962,7 @@ TEST(kvs_snapshot_restore, snapshot_restore_success){
     std::ofstream hash_out(filename_prefix + "_1.hash", std::ios::binary);
     hash_out.write(reinterpret_cast<const char*>(hash_bytes.data()), hash_bytes.size());
     hash_out.close();
+    ASSERT_TRUE(result.value().snapshot_scan());
 
     auto restore_result = result.value().snapshot_restore(1);
     EXPECT_TRUE(restore_result);
@@ -1065,6 +2002,7 @@ TEST(kvs_snapshot_restore, snapshot_restore_failure_open_json){
     /* Create empty Test-Snapshot Files */
     std::ofstream(filename_prefix + "_1.json") << "{}"; /* Empty JSON */
     std::ofstream(filename_prefix + "_1.hash") << "invalid_hash"; /* Invalid Hash -> Trigger open_json error */
+    ASSERT_TRUE(result.value().snapshot_scan());
 
     auto restore_result = result.value().snapshot_restore(1);
     EXPECT_FALSE(restore_result);
@@ -1080,7 +2018,7 @@ TEST(kvs_snapshot_restore, snapshot_restore_failure_mutex){
     auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(result);
 
-    std::unique_lock<std::mutex> lock(result.value().kvs_mutex);
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
     auto restore_result = result.value().snapshot_restore(1);
     EXPECT_FALSE(restore_result);
     EXPECT_EQ(static_cast<ErrorCode>(*restore_result.error()), ErrorCode::MutexLockFailed);
@@ -1094,6 +2032,8 @@ TEST(kvs_snapshot_restore, snapshot_restore_failure_snapshot_count){
 
     auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
     ASSERT_TRUE(kvs);
+    std::ofstream(filename_prefix + "_1.json") << "{}";
+    ASSERT_TRUE(kvs.value().snapshot_scan());
 
     /* Mock Filesystem */
     score::filesystem::Filesystem mock_filesystem = score::filesystem::CreateMockFileSystem();
@@ -1120,6 +2060,44 @@ TEST(kvs_snapshot_max_count, snapshot_max_count){
     cleanup_environment();
 }
 
+TEST(kvs_snapshot_max_count, snapshot_max_count_configured){
+
+    prepare_environment();
+
+    /* Deeper history than the default */
+    KvsOptions options;
+    options.snapshot_max_count = KVS_MAX_SNAPSHOTS + 2U;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().snapshot_max_count(), KVS_MAX_SNAPSHOTS + 2U);
+    for (size_t i = 1; i <= KVS_MAX_SNAPSHOTS + 3U; i++) {
+        ASSERT_TRUE(result.value().set_value("counter", KvsValue(static_cast<int32_t>(i))));
+        ASSERT_TRUE(result.value().flush());
+    }
+    EXPECT_EQ(result.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS + 2U);
+    ASSERT_TRUE(result.value().snapshot_restore(KVS_MAX_SNAPSHOTS + 2U));
+    EXPECT_TRUE(result.value().get_value("counter").value() == KvsValue(static_cast<int32_t>(1)));
+
+    /* No history: each flush replaces the KVS file */
+    options.snapshot_max_count = 0U;
+    result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().snapshot_max_count(), 0U);
+    EXPECT_EQ(result.value().snapshot_count().value(), 0U);
+    for (size_t i = 1; i <= 2U; i++) {
+        ASSERT_TRUE(result.value().set_value("counter", KvsValue(static_cast<int32_t>(i))));
+        ASSERT_TRUE(result.value().flush());
+        EXPECT_EQ(result.value().snapshot_files.size(), 1U);
+        EXPECT_EQ(result.value().snapshot_count().value(), 0U);
+    }
+    EXPECT_FALSE(std::filesystem::exists(kvs_prefix + ".json"));
+    auto restore_result = result.value().snapshot_restore(1);
+    ASSERT_FALSE(restore_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*restore_result.error()), ErrorCode::InvalidSnapshotId);
+
+    cleanup_environment();
+}
+
 TEST(kvs_get_filename, get_kvs_filename_success){
 
     prepare_environment();
@@ -1131,6 +2109,7 @@ TEST(kvs_get_filename, get_kvs_filename_success){
     for (size_t i = 0; i < KVS_MAX_SNAPSHOTS; i++) {
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
     }
+    ASSERT_TRUE(result.value().snapshot_scan());
 
     for(int i = 0; i< KVS_MAX_SNAPSHOTS; i++) {
         auto filename = result.value().get_kvs_filename(SnapshotId(i));
@@ -1162,7 +2141,7 @@ TEST(kvs_get_filename, get_kvs_filename_failure){
         .WillOnce(::testing::Return(score::Result<bool>(score::MakeUnexpected(score::filesystem::ErrorCode::kCouldNotRetrieveStatus))));
     kvs.value().filesystem = std::make_unique<score::filesystem::Filesystem>(std::move(mock_filesystem));
 
-    result = kvs.value().get_kvs_filename(SnapshotId(1));
+    result = kvs.value().get_kvs_filename(SnapshotId(0));
     EXPECT_FALSE(result);
 
     cleanup_environment();
@@ -1177,8 +2156,10 @@ TEST(kvs_get_filename, get_hashname_success){
 
     /* Generate Testfiles */
     for (size_t i = 0; i < KVS_MAX_SNAPSHOTS; i++) {
+        std::ofstream(filename_prefix + "_" + std::to_string(i) + ".json") << "{}";
         std::ofstream(filename_prefix + "_" + std::to_string(i) + ".hash") << "{}";
     }
+    ASSERT_TRUE(result.value().snapshot_scan());
 
     for(int i = 0; i< KVS_MAX_SNAPSHOTS; i++) {
         auto hashname = result.value().get_hash_filename(SnapshotId(i));
@@ -1211,7 +2192,7 @@ TEST(kvs_get_filename, get_hashname_failure){
         .WillOnce(::testing::Return(score::Result<bool>(score::MakeUnexpected(score::filesystem::ErrorCode::kCouldNotRetrieveStatus))));
     kvs.value().filesystem = std::make_unique<score::filesystem::Filesystem>(std::move(mock_filesystem));
 
-    result = kvs.value().get_hash_filename(SnapshotId(1));
+    result = kvs.value().get_hash_filename(SnapshotId(0));
     EXPECT_FALSE(result);
 
     cleanup_environment();
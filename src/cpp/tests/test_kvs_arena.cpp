@@ -0,0 +1,125 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+#include <cstdint>
+#include "test_kvs_general.hpp"
+
+TEST(kvs_arena, allocator_resource) {
+    CountingResource resource;
+    {
+        KvsMap data{KvsMap::allocator_type(&resource)};
+        KvsValue::Array::Elements elements{KvsAllocator<KvsValue>(&resource)};
+        elements.push_back(KvsValue(1.0));
+        (void)data.emplace("array", KvsValue(KvsValue::Array(std::move(elements))));
+        EXPECT_EQ(data.get_allocator().resource(), &resource);
+        EXPECT_EQ(resource.allocations, 4U); /* Buckets, map node, shared array and its elements */
+        const size_t allocations = resource.allocations;
+
+        /* Moved maps keep the allocator, node handles move between them */
+        KvsMap moved = std::move(data);
+        EXPECT_EQ(moved.get_allocator().resource(), &resource);
+        KvsMap other{KvsMap::allocator_type(&resource)};
+        other.insert(moved.extract("array"));
+        EXPECT_EQ(resource.deallocations, 0U);
+
+        /* Copies and default maps use operator new */
+        KvsMap copy = other;
+        KvsMap heap;
+        heap.emplace("heap", KvsValue(2.0));
+        KvsValue::Array array = std::get<KvsValue::Array>(copy.at("array").getValue());
+        array.push_back(KvsValue(3.0));
+        EXPECT_EQ(copy.get_allocator().resource(), nullptr);
+        EXPECT_EQ(resource.allocations, allocations + 1U); /* Bucket array of other */
+        EXPECT_TRUE(KvsMap::allocator_type() != other.get_allocator());
+
+        /* Memory returns to its resource, also from a copy of the shared array */
+        copy.clear();
+        other.clear();
+        EXPECT_EQ(resource.deallocations, 3U); /* Map node, shared array and its elements */
+        EXPECT_EQ(std::get<double>(array[0].getValue()), 1.0);
+    }
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST(kvs_arena, arena_chunks) {
+    KvsArena* arena = KvsArena::create(0U); /* Minimum chunk size */
+    std::optional<KvsMap> data;
+    data.emplace(KvsMap::allocator_type(arena));
+    for (int32_t i = 0; i < 1000; i++) {
+        (void)data->emplace("key" + std::to_string(i), KvsValue(i));
+    }
+    /* Larger than a chunk */
+    KvsValue::Array::Elements elements(1000U, KvsValue(1.0), KvsAllocator<KvsValue>(arena));
+    (void)data->emplace("large", KvsValue(KvsValue::Array(std::move(elements))));
+    const auto& large = std::get<KvsValue::Array>(data->at("large").getValue());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&large[0]) % alignof(KvsValue), 0U);
+    EXPECT_GT(arena->chunk_count(), 1U);
+    EXPECT_GE(arena->used(), 1000U * sizeof(KvsMap::value_type));
+    const size_t chunks = arena->chunk_count();
+    const size_t used = arena->used();
+
+    /* Released by the owner, the data keeps the arena alive, new entries use operator new */
+    arena->release();
+    EXPECT_EQ(std::get<int32_t>(data->at("key999").getValue()), 999);
+    EXPECT_EQ(std::get<KvsValue::Array>(data->at("large").getValue()).size(), 1000U);
+    std::thread writer([&data]() {
+        for (int32_t i = 1000; i < 2000; i++) {
+            (void)data->emplace("key" + std::to_string(i), KvsValue(i));
+        }
+        (void)data->erase("key0");
+        (void)data->erase("key1999");
+    });
+    writer.join();
+    EXPECT_EQ(arena->chunk_count(), chunks);
+    EXPECT_EQ(arena->used(), used);
+    EXPECT_EQ(data->size(), 1999U);
+    data.reset(); /* The last allocator deletes the arena */
+}
+
+TEST(kvs_arena, kvs_load_arena) {
+
+    prepare_environment();
+    KvsOptions options;
+    options.load_arena = true;
+    {
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("array", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue("two")})));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    for (const KvsStorageFormat format : {KvsStorageFormat::Json, KvsStorageFormat::Binary}) {
+        options.storage_format = format;
+        auto result = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir), options);
+        ASSERT_TRUE(result);
+        Kvs& kvs = result.value();
+        EXPECT_TRUE(kvs.get_value("kvs").value() == KvsValue(static_cast<int32_t>(2)));
+        EXPECT_TRUE(kvs.get_value("default").value() == KvsValue(static_cast<int32_t>(5)));
+        KvsValue array = kvs.get_value("array").value();
+        EXPECT_TRUE(array == KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue("two")}));
+
+        /* Changes after loading, the shared value stays valid after the loaded data is released */
+        ASSERT_TRUE(kvs.set_value("new", KvsValue(3.0)));
+        ASSERT_TRUE(kvs.remove_key("kvs"));
+        ASSERT_TRUE(kvs.reset());
+        EXPECT_FALSE(kvs.key_exists("array").value());
+        EXPECT_EQ(std::get<std::string>(std::get<KvsValue::Array>(array.getValue())[1].getValue()), "two");
+
+        /* Written in the selected format for the next loop */
+        ASSERT_TRUE(kvs.set_value("kvs", KvsValue(static_cast<int32_t>(2))));
+        ASSERT_TRUE(kvs.set_value("array", array));
+        ASSERT_TRUE(kvs.flush());
+    }
+
+    cleanup_environment();
+}
@@ -0,0 +1,326 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+#include <cmath>
+#include "test_kvs_general.hpp"
+
+const std::string bin_file = kvs_prefix + ".bin";
+
+/* Helper to open the test KVS with binary storage format */
+static score::Result<Kvs> open_binary_kvs() {
+    KvsOptions options;
+    options.storage_format = KvsStorageFormat::Binary;
+    return Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+}
+
+/* Data with all supported types */
+static KvsMap binary_test_data() {
+    KvsMap data;
+    data.emplace("i32", KvsValue(static_cast<int32_t>(-42)));
+    data.emplace("u32", KvsValue(static_cast<uint32_t>(0xFFFFFFFFU)));
+    data.emplace("i64", KvsValue(static_cast<int64_t>(-1234567890123)));
+    data.emplace("u64", KvsValue(static_cast<uint64_t>(0xFFFFFFFFFFFFFFFFU)));
+    data.emplace("f64", KvsValue(3.14159));
+    data.emplace("bool", KvsValue(true));
+    data.emplace("str", KvsValue(std::string("value")));
+    data.emplace("null", KvsValue(nullptr));
+    data.emplace("arr", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(std::string("two"))}));
+    std::unordered_map<std::string, KvsValue> inner;
+    inner.emplace("inner", KvsValue(false));
+    data.emplace("obj", KvsValue(inner));
+    data.emplace("bin", KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0xFFU, 0x22U})));
+    data.emplace("arr_i32", KvsValue(KvsValue::ArrayI32{-1, 0x01020304}));
+    data.emplace("arr_u32", KvsValue(KvsValue::ArrayU32{0xFFFFFFFFU}));
+    data.emplace("arr_i64", KvsValue(KvsValue::ArrayI64{-1234567890123, 1}));
+    data.emplace("arr_u64", KvsValue(KvsValue::ArrayU64{0x0102030405060708U}));
+    data.emplace("arr_f64", KvsValue(KvsValue::ArrayF64{3.14159, -0.0, 1e-300}));
+    data.emplace("arr_empty", KvsValue(KvsValue::ArrayF64{}));
+    return data;
+}
+
+TEST(kvs_binary, serialize_deserialize_roundtrip) {
+
+    auto data = binary_test_data();
+    auto serialize_res = serialize_kvs_binary(data);
+    ASSERT_TRUE(serialize_res);
+    EXPECT_EQ(serialize_res.value().substr(0, 4), "KVSB");
+    EXPECT_EQ(static_cast<uint8_t>(serialize_res.value()[4]), KVS_BINARY_VERSION);
+
+    auto deserialize_res = deserialize_kvs_binary(serialize_res.value());
+    ASSERT_TRUE(deserialize_res);
+    auto& result = deserialize_res.value();
+    ASSERT_EQ(result.size(), data.size());
+    EXPECT_EQ(std::get<int32_t>(result.at("i32").getValue()), -42);
+    EXPECT_EQ(std::get<uint32_t>(result.at("u32").getValue()), 0xFFFFFFFFU);
+    EXPECT_EQ(std::get<int64_t>(result.at("i64").getValue()), -1234567890123);
+    EXPECT_EQ(std::get<uint64_t>(result.at("u64").getValue()), 0xFFFFFFFFFFFFFFFFU);
+    EXPECT_DOUBLE_EQ(std::get<double>(result.at("f64").getValue()), 3.14159);
+    EXPECT_EQ(std::get<bool>(result.at("bool").getValue()), true);
+    EXPECT_EQ(std::get<std::string>(result.at("str").getValue()), "value");
+    EXPECT_EQ(result.at("null").getType(), KvsValue::Type::Null);
+    const auto& arr = std::get<KvsValue::Array>(result.at("arr").getValue());
+    ASSERT_EQ(arr.size(), 2U);
+    EXPECT_EQ(std::get<double>(arr[0].getValue()), 1.0);
+    EXPECT_EQ(std::get<std::string>(arr[1].getValue()), "two");
+    const auto& obj = std::get<KvsValue::Object>(result.at("obj").getValue());
+    ASSERT_EQ(obj.size(), 1U);
+    EXPECT_EQ(std::get<bool>(obj.at("inner").getValue()), false);
+    /* Parsed arrays and objects are shared by copies */
+    EXPECT_EQ(KvsValue::Array(arr).elements.get(), arr.elements.get());
+    EXPECT_EQ(KvsValue::Object(obj).members.get(), obj.members.get());
+    EXPECT_EQ(std::get<KvsValue::Bytes>(result.at("bin").getValue()).to_vector(), (std::vector<uint8_t>{0x00U, 0xFFU, 0x22U}));
+    for (const char* key : {"arr_i32", "arr_u32", "arr_i64", "arr_u64", "arr_f64", "arr_empty"}) {
+        EXPECT_EQ(result.at(key), data.at(key)) << key;
+    }
+    EXPECT_TRUE(std::signbit(std::get<KvsValue::ArrayF64>(result.at("arr_f64").getValue())[1]));
+
+    /* Empty data */
+    auto empty_res = serialize_kvs_binary({});
+    ASSERT_TRUE(empty_res);
+    auto empty_data = deserialize_kvs_binary(empty_res.value());
+    ASSERT_TRUE(empty_data);
+    EXPECT_TRUE(empty_data.value().empty());
+}
+
+TEST(kvs_binary, serialize_invalid_value) {
+
+    KvsMap data;
+    BrokenKvsValue invalid;
+    data.emplace("invalid", invalid);
+    auto result = serialize_kvs_binary(data);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::InvalidValueType);
+}
+
+TEST(kvs_binary, deserialize_failure) {
+
+    auto serialize_res = serialize_kvs_binary(binary_test_data());
+    ASSERT_TRUE(serialize_res);
+    const std::string valid = serialize_res.value();
+
+    /* Too short */
+    auto result = deserialize_kvs_binary("KVSB");
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* Invalid magic */
+    std::string invalid = valid;
+    invalid[0] = 'X';
+    result = deserialize_kvs_binary(invalid);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* Unsupported version */
+    invalid = valid;
+    invalid[4] = static_cast<char>(KVS_BINARY_VERSION + 1U);
+    result = deserialize_kvs_binary(invalid);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* Checksum mismatch */
+    invalid = valid;
+    invalid[valid.size() / 2] ^= 0x01;
+    result = deserialize_kvs_binary(invalid);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* Valid checksum, but truncated content (entry count too high) */
+    std::string content = valid.substr(0, 5);
+    content += std::string("\x00\x00\x00\x01", 4);
+    std::array<uint8_t, 4> hash = get_hash_bytes(content);
+    content.append(reinterpret_cast<const char*>(hash.data()), hash.size());
+    result = deserialize_kvs_binary(content);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::SerializationFailed);
+
+    /* Valid checksum, but the byte count of a binary value exceeds the content */
+    content = valid.substr(0, 5);
+    content += std::string("\x00\x00\x00\x01\x00\x00\x00\x01k\x0A\x00\x00\x00\x05" "abc", 17);
+    hash = get_hash_bytes(content);
+    content.append(reinterpret_cast<const char*>(hash.data()), hash.size());
+    result = deserialize_kvs_binary(content);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::SerializationFailed);
+
+    /* Valid checksum, but the element count of a packed array exceeds the content (2 doubles, 15 bytes) */
+    content = valid.substr(0, 5);
+    content += std::string("\x00\x00\x00\x01\x00\x00\x00\x01k\x0F\x00\x00\x00\x02", 14);
+    content += std::string(15U, '\x01');
+    hash = get_hash_bytes(content);
+    content.append(reinterpret_cast<const char*>(hash.data()), hash.size());
+    result = deserialize_kvs_binary(content);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::SerializationFailed);
+
+    /* Nesting depth limit: arrays nested KVS_JSON_MAX_DEPTH times are rejected, one less is accepted */
+    for (const size_t nesting : {KVS_JSON_MAX_DEPTH - 1U, KVS_JSON_MAX_DEPTH}) {
+        std::string nested;
+        for (size_t i = 0; i < nesting; ++i) {
+            nested += std::string("\x08\x00\x00\x00\x01", 5);
+        }
+        nested += '\x07';
+        size_t pos = 0;
+        KvsValue value(nullptr);
+        EXPECT_EQ(decode_kvs_binary_value(nested, pos, value), nesting < KVS_JSON_MAX_DEPTH);
+
+        content = valid.substr(0, 5);
+        content += std::string("\x00\x00\x00\x01\x00\x00\x00\x01k", 9) + nested;
+        hash = get_hash_bytes(content);
+        content.append(reinterpret_cast<const char*>(hash.data()), hash.size());
+        result = deserialize_kvs_binary(content);
+        EXPECT_EQ(static_cast<bool>(result), nesting < KVS_JSON_MAX_DEPTH);
+    }
+}
+
+TEST(kvs_binary, flush_and_open_binary) {
+
+    prepare_environment();
+
+    {
+        auto result = open_binary_kvs();
+        ASSERT_TRUE(result);
+        /* Existing JSON data is read as fallback */
+        EXPECT_TRUE(result.value().kvs.count("kvs"));
+        ASSERT_TRUE(result.value().set_value("key1", KvsValue(std::string("value1"))));
+        ASSERT_TRUE(result.value().flush());
+    }
+
+    /* Binary file is the current KVS, the JSON file becomes a snapshot */
+    const std::string gen_bin_file = filename_prefix + "_g1.bin";
+    EXPECT_TRUE(std::filesystem::exists(gen_bin_file));
+    EXPECT_FALSE(std::filesystem::exists(filename_prefix + "_g1.hash"));
+    EXPECT_TRUE(std::filesystem::exists(kvs_prefix + ".json"));
+
+    auto result = open_binary_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.value().kvs.count("kvs"));
+    auto value = result.value().get_value("key1");
+    ASSERT_TRUE(value);
+    EXPECT_EQ(std::get<std::string>(value.value().getValue()), "value1");
+
+    /* JSON format reads the binary file, if no JSON file exists */
+    auto result_json = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(result_json);
+    EXPECT_TRUE(result_json.value().kvs.count("key1"));
+
+    /* Filenames and snapshots */
+    auto filename = result.value().get_kvs_filename(0);
+    ASSERT_TRUE(filename);
+    EXPECT_EQ(filename.value().CStr(), gen_bin_file);
+    filename = result.value().get_kvs_filename(1);
+    ASSERT_TRUE(filename);
+    EXPECT_EQ(filename.value().CStr(), kvs_prefix + ".json");
+    EXPECT_EQ(result.value().snapshot_count().value(), 1U);
+
+    /* Restore JSON snapshot with binary format */
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_FALSE(result.value().kvs.count("key1"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_binary, snapshot_scan_mixed_formats) {
+
+    prepare_environment();
+
+    auto result = open_binary_kvs();
+    ASSERT_TRUE(result);
+
+    /* Both formats of a generation exist -> the configured format is used */
+    std::ofstream(filename_prefix + "_g2.json") << "{}";
+    std::ofstream(filename_prefix + "_g2.bin") << "bin";
+    ASSERT_TRUE(result.value().snapshot_scan());
+    EXPECT_EQ(result.value().get_kvs_filename(0).value().CStr(), filename_prefix + "_g2.bin");
+    auto result_json = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_FALSE(result_json); /* Invalid JSON data of generation 2 (no hash file) */
+    std::filesystem::remove(filename_prefix + "_g2.json");
+
+    /* Binary snapshots are counted */
+    std::ofstream(filename_prefix + "_1.bin") << "bin";
+    std::ofstream(filename_prefix + "_2.bin") << "bin";
+    ASSERT_TRUE(result.value().snapshot_scan());
+    EXPECT_EQ(result.value().snapshot_count().value(), KVS_MAX_SNAPSHOTS);
+    EXPECT_EQ(result.value().get_kvs_filename(KVS_MAX_SNAPSHOTS).value().CStr(), filename_prefix + "_2.bin");
+
+    cleanup_environment();
+}
+
+TEST(kvs_binary, snapshot_restore_scanned_format) {
+
+    prepare_environment();
+
+    auto result = open_binary_kvs();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(2.0)));
+    ASSERT_TRUE(result.value().flush());
+
+    /* Generation 1 was scanned as binary, the format switch and a JSON file of generation 1 don't change it */
+    std::ofstream(filename_prefix + "_g1.json") << "{}";
+    ASSERT_TRUE(result.value().snapshot_scan());
+    result.value().options.storage_format = KvsStorageFormat::Json;
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    auto value = result.value().get_value("key1");
+    ASSERT_TRUE(value);
+    EXPECT_EQ(std::get<double>(value.value().getValue()), 1.0);
+
+    cleanup_environment();
+}
+
+TEST(kvs_binary, open_binary_failure) {
+
+    prepare_environment();
+
+    /* Corrupted binary file */
+    std::ofstream(bin_file, std::ios::binary) << "KVSB invalid";
+    auto result = open_binary_kvs();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    /* File not readable */
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    auto open_res = kvs.value().open_binary(filename_prefix + "_5");
+    ASSERT_FALSE(open_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*open_res.error()), ErrorCode::KvsFileReadError);
+
+    cleanup_environment();
+}
+
+TEST(kvs_binary, write_binary_data_failure) {
+
+    prepare_environment();
+
+    auto result = open_binary_kvs();
+    ASSERT_TRUE(result);
+
+    /* Binary path is a directory and can't be written */
+    std::filesystem::create_directory(bin_file);
+    auto write_res = result.value().write_binary_data("data", bin_file);
+    ASSERT_FALSE(write_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*write_res.error()), ErrorCode::PhysicalStorageFailure);
+
+    /* Directory can't be created */
+    score::filesystem::Filesystem mock_filesystem = score::filesystem::CreateMockFileSystem();
+    auto standard_mock = std::dynamic_pointer_cast<score::filesystem::StandardFilesystemMock>(mock_filesystem.standard);
+    ASSERT_NE(standard_mock, nullptr);
+    EXPECT_CALL(*standard_mock, CreateDirectories(::testing::_))
+        .WillOnce(::testing::Return(score::ResultBlank(score::MakeUnexpected(score::filesystem::ErrorCode::kCouldNotCreateDirectory))));
+    result.value().filesystem = std::make_unique<score::filesystem::Filesystem>(std::move(mock_filesystem));
+    write_res = result.value().write_binary_data("data", bin_file);
+    ASSERT_FALSE(write_res);
+    EXPECT_EQ(static_cast<ErrorCode>(*write_res.error()), ErrorCode::PhysicalStorageFailure);
+
+    cleanup_environment();
+}
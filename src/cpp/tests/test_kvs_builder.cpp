@@ -29,6 +29,33 @@ TEST(kvs_kvsbuilder, kvsbuilder_build) {
     EXPECT_EQ(builder.need_kvs, true);
     builder.dir("./kvsbuilder/");
     EXPECT_EQ(builder.directory, "./kvsbuilder/");
+    EXPECT_EQ(builder.options.wal_enabled, false);
+    builder.wal_flag(true);
+    EXPECT_EQ(builder.options.wal_enabled, true);
+    EXPECT_EQ(builder.options.wal_compaction_threshold, KVS_WAL_COMPACTION_THRESHOLD);
+    builder.wal_compaction_threshold(1024U);
+    EXPECT_EQ(builder.options.wal_compaction_threshold, 1024U);
+    EXPECT_EQ(builder.options.storage_format, KvsStorageFormat::Json);
+    builder.storage_format(KvsStorageFormat::Binary);
+    EXPECT_EQ(builder.options.storage_format, KvsStorageFormat::Binary);
+    EXPECT_EQ(builder.options.snapshot_max_count, KVS_MAX_SNAPSHOTS);
+    builder.snapshot_max_count(0U);
+    EXPECT_EQ(builder.options.snapshot_max_count, 0U);
+    EXPECT_EQ(builder.options.lock_policy, KvsLockPolicy::Try);
+    EXPECT_EQ(builder.options.lock_timeout, std::chrono::milliseconds(KVS_LOCK_TIMEOUT_MS));
+    builder.lock_policy(KvsLockPolicy::Timed).lock_timeout(std::chrono::milliseconds(5));
+    EXPECT_EQ(builder.options.lock_policy, KvsLockPolicy::Timed);
+    EXPECT_EQ(builder.options.lock_timeout, std::chrono::milliseconds(5));
+    EXPECT_EQ(builder.options.shard_count, 1U);
+    builder.shard_count(4U);
+    EXPECT_EQ(builder.options.shard_count, 4U);
+    EXPECT_EQ(builder.options.flush_policy, KvsFlushPolicy::Manual);
+    EXPECT_EQ(builder.options.flush_delay, std::chrono::milliseconds(KVS_FLUSH_DELAY_MS));
+    EXPECT_EQ(builder.options.flush_change_count, 0U);
+    builder.flush_policy(KvsFlushPolicy::Background).flush_delay(std::chrono::milliseconds(5)).flush_change_count(8U);
+    EXPECT_EQ(builder.options.flush_policy, KvsFlushPolicy::Background);
+    EXPECT_EQ(builder.options.flush_delay, std::chrono::milliseconds(5));
+    EXPECT_EQ(builder.options.flush_change_count, 8U);
 
     /* Test the KvsBuilder build method */
     /* We want to check, if OpenNeedDefaults::Required and OpenNeedKvs::Required is passed correctly
@@ -44,6 +71,10 @@ TEST(kvs_kvsbuilder, kvsbuilder_build) {
     result_build = builder.build();
     EXPECT_TRUE(result_build);
     EXPECT_EQ(result_build.value().filename_prefix.CStr(), "./kvsbuilder/kvs_"+std::to_string(instance_id.id));
+    EXPECT_EQ(result_build.value().options.wal_enabled, true);
+    EXPECT_EQ(result_build.value().options.wal_compaction_threshold, 1024U);
+    EXPECT_EQ(result_build.value().options.storage_format, KvsStorageFormat::Binary);
+    EXPECT_EQ(result_build.value().snapshot_max_count(), 0U);
 }
 
 TEST(kvs_kvsbuilder, kvsbuilder_directory_check) {
@@ -0,0 +1,150 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+
+#include <algorithm>
+#include <atomic>
+#include "test_kvs_general.hpp"
+
+TEST(kvs_capture, capture_overlay) {
+    KvsCapture capture;
+    KvsCapture::Data data{{"a", KvsValue(1.0)}, {"b", KvsValue(2.0)}, {"c", KvsValue(3.0)}};
+
+    capture.begin(data);
+    EXPECT_TRUE(capture.active());
+    EXPECT_TRUE(data.empty());
+    EXPECT_EQ(capture.captured().size(), 3U);
+
+    /* Changes go to the overlay, the captured data is unchanged */
+    capture.set(data, "a", KvsValue(10.0));
+    capture.set(data, "d", KvsValue(4.0));
+    EXPECT_TRUE(capture.erase(data, "b"));
+    EXPECT_FALSE(capture.erase(data, "b"));
+    EXPECT_FALSE(capture.erase(data, "x"));
+    EXPECT_EQ(std::get<double>(capture.find(data, "a")->getValue()), 10.0);
+    EXPECT_EQ(std::get<double>(capture.find(data, "c")->getValue()), 3.0);
+    EXPECT_EQ(capture.find(data, "b"), nullptr);
+    EXPECT_EQ(std::get<double>(capture.captured().at("a").getValue()), 1.0);
+    EXPECT_EQ(capture.captured().count("b"), 1U);
+    EXPECT_EQ(capture.captured().count("d"), 0U);
+
+    std::vector<std::string> keys = capture.keys(data);
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys, (std::vector<std::string>{"a", "c", "d"}));
+    EXPECT_EQ(capture.copy(data).size(), 3U);
+    EXPECT_FALSE(capture.empty(data));
+
+    /* A key removed during the capture can be set again */
+    capture.set(data, "b", KvsValue(20.0));
+    EXPECT_EQ(std::get<double>(capture.find(data, "b")->getValue()), 20.0);
+
+    capture.end(data);
+    EXPECT_FALSE(capture.active());
+    EXPECT_EQ(data.size(), 4U);
+    EXPECT_EQ(std::get<double>(data.at("a").getValue()), 10.0);
+    EXPECT_EQ(std::get<double>(data.at("b").getValue()), 20.0);
+    EXPECT_EQ(std::get<double>(data.at("c").getValue()), 3.0);
+    EXPECT_EQ(std::get<double>(data.at("d").getValue()), 4.0);
+}
+
+TEST(kvs_capture, capture_assign) {
+    KvsCapture capture;
+    KvsCapture::Data data{{"a", KvsValue(1.0)}, {"b", KvsValue(2.0)}};
+
+    capture.begin(data);
+    capture.assign(data, KvsCapture::Data{});
+    EXPECT_TRUE(capture.empty(data));
+    EXPECT_EQ(capture.find(data, "a"), nullptr);
+    EXPECT_TRUE(capture.keys(data).empty());
+    EXPECT_EQ(capture.captured().size(), 2U);
+
+    capture.assign(data, KvsCapture::Data{{"c", KvsValue(3.0)}});
+    capture.end(data);
+    EXPECT_EQ(data.size(), 1U);
+    EXPECT_EQ(data.count("c"), 1U);
+
+    /* Without a capture only the data map is used */
+    EXPECT_TRUE(capture.erase(data, "c"));
+    EXPECT_TRUE(capture.empty(data));
+    capture.end(data); /* No capture: no effect */
+    EXPECT_TRUE(data.empty());
+}
+
+TEST(kvs_capture, kvs_changes_during_capture) {
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+    ASSERT_TRUE(kvs.set_value("key1", KvsValue(1.0)));
+
+    /* Flush state between capture and serialization end */
+    kvs.capture_begin();
+    EXPECT_TRUE(kvs.kvs.empty());
+    EXPECT_TRUE(kvs.set_value("key2", KvsValue(2.0)));
+    EXPECT_TRUE(kvs.remove_key("key1"));
+    EXPECT_FALSE(kvs.key_exists("key1").value());
+    EXPECT_TRUE(kvs.get_value("kvs").value() == KvsValue(static_cast<int32_t>(2)));
+    EXPECT_EQ(kvs.get_all_keys().value().size(), 2U);
+    EXPECT_EQ(kvs.kvs_capture.captured().size(), 2U);
+    EXPECT_EQ(kvs.kvs_capture.captured().count("key1"), 1U);
+    kvs.capture_end();
+
+    EXPECT_EQ(kvs.kvs.size(), 2U);
+    EXPECT_EQ(kvs.kvs.count("key1"), 0U);
+    EXPECT_EQ(kvs.kvs.count("key2"), 1U);
+
+    /* Reset during a capture */
+    kvs.capture_begin();
+    EXPECT_TRUE(kvs.reset());
+    EXPECT_TRUE(kvs.get_all_keys().value().empty());
+    kvs.capture_end();
+    EXPECT_TRUE(kvs.kvs.empty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_capture, flush_concurrent_writer) {
+
+    prepare_environment();
+
+    KvsOptions options;
+    options.lock_policy = KvsLockPolicy::Blocking;
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+    ASSERT_TRUE(result);
+    Kvs& kvs = result.value();
+
+    /* Writers change the KVS while the flushes serialize their captures */
+    std::atomic<size_t> failures{0};
+    std::thread writer([&kvs, &failures]() {
+        for (int32_t i = 0; i < 300; i++) {
+            failures += kvs.set_value("key" + std::to_string(i % 50), KvsValue(i)) ? 0U : 1U;
+            failures += ((0 == (i % 7)) && !kvs.remove_key("key" + std::to_string(i % 50))) ? 1U : 0U;
+        }
+    });
+    for (size_t i = 0; i < 20U; i++) {
+        failures += kvs.flush() ? 0U : 1U;
+    }
+    writer.join();
+    EXPECT_EQ(failures.load(), 0U);
+    EXPECT_FALSE(kvs.kvs_capture.active());
+    ASSERT_TRUE(kvs.flush());
+
+    /* The last flush contains the final state */
+    auto reopen = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(reopen);
+    EXPECT_EQ(reopen.value().kvs, kvs.kvs);
+
+    cleanup_environment();
+}
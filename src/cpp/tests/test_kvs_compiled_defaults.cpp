@@ -0,0 +1,97 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+
+#include <limits>
+#include "test_kvs_general.hpp"
+#include "kvs_test_defaults.hpp" /* Generated from test_kvs_compiled_defaults.json */
+
+TEST(kvs_compiled_defaults, find_all_types) {
+    EXPECT_EQ(kvs_test_defaults.size(), 15U);
+
+    const std::vector<std::pair<std::string, KvsValue>> expected = {
+        {"i32", KvsValue(static_cast<int32_t>(-5))},
+        {"u32", KvsValue(std::numeric_limits<uint32_t>::max())},
+        {"i64", KvsValue(std::numeric_limits<int64_t>::min())},
+        {"u64", KvsValue(std::numeric_limits<uint64_t>::max())},
+        {"f64", KvsValue(0.1)},
+        {"bool", KvsValue(true)},
+        {"str", KvsValue("text \"quoted\" ?? \xC3\xA4")},
+        {"null", KvsValue(nullptr)},
+        {"bin", KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0x01U, 0xFFU, 0x3FU}))},
+        {"arr", KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(std::vector<KvsValue>{})})},
+        {"arr_f64", KvsValue(KvsValue::ArrayF64{0.5, -2.0, 1000.0})},
+        {"arr_u64", KvsValue(KvsValue::ArrayU64{std::numeric_limits<uint64_t>::max(), 0U})},
+        {"obj", KvsValue(std::unordered_map<std::string, KvsValue>{{"inner", KvsValue(false)}})},
+        {"", KvsValue("empty key")},
+        {"default", KvsValue(static_cast<int32_t>(7))},
+    };
+    for (const auto& [key, value] : expected) {
+        const KvsCompiledValue* compiled = kvs_test_defaults.find(key);
+        ASSERT_NE(compiled, nullptr) << key;
+        EXPECT_EQ(compiled->to_kvsvalue(), value) << key;
+    }
+
+    EXPECT_EQ(kvs_test_defaults.find("missing"), nullptr);
+    EXPECT_EQ(kvs_test_defaults.find("i3"), nullptr);
+}
+
+TEST(kvs_compiled_defaults, find_empty_table) {
+    constexpr KvsCompiledDefaults empty{nullptr, 0U, nullptr, 0U, 0U};
+    static_assert(nullptr == empty.find("key"), "lookup in the constexpr table");
+    EXPECT_EQ(empty.find(""), nullptr);
+}
+
+TEST(kvs_compiled_defaults, kvs_uses_compiled_defaults) {
+    prepare_environment();
+
+    /* Defaults files are not read (invalid JSON) */
+    std::ofstream default_json_file(default_prefix + ".json");
+    default_json_file << "{ invalid json }";
+    default_json_file.close();
+
+    auto kvs = KvsBuilder(instance_id)
+                   .need_defaults_flag(true)
+                   .dir(std::string(data_dir))
+                   .compiled_defaults(kvs_test_defaults)
+                   .build();
+    ASSERT_TRUE(kvs);
+    EXPECT_FALSE(kvs.value().default_image.is_mapped());
+    EXPECT_TRUE(kvs.value().default_values.empty());
+
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue(static_cast<int32_t>(7)));
+    EXPECT_EQ(kvs.value().get_default_value("missing").error(), ErrorCode::KeyNotFound);
+    EXPECT_TRUE(kvs.value().has_default_value("str").value());
+    EXPECT_FALSE(kvs.value().has_default_value("kvs").value());
+
+    /* Written value shadows the default, reset_key restores it */
+    EXPECT_EQ(kvs.value().get_value("u32").value(), KvsValue(std::numeric_limits<uint32_t>::max()));
+    ASSERT_TRUE(kvs.value().set_value("u32", KvsValue(static_cast<uint32_t>(1))));
+    EXPECT_EQ(kvs.value().get_value("u32").value(), KvsValue(static_cast<uint32_t>(1)));
+    ASSERT_TRUE(kvs.value().reset_key("u32"));
+    EXPECT_EQ(kvs.value().get_value("u32").value(), KvsValue(std::numeric_limits<uint32_t>::max()));
+    EXPECT_EQ(static_cast<ErrorCode>(*kvs.value().reset_key("kvs").error()), ErrorCode::KeyDefaultNotFound);
+
+    /* No defaults files needed */
+    std::filesystem::remove(default_prefix + ".json");
+    std::filesystem::remove(default_prefix + ".hash");
+    kvs = KvsBuilder(instance_id)
+              .need_defaults_flag(true)
+              .dir(std::string(data_dir))
+              .compiled_defaults(kvs_test_defaults)
+              .build();
+    ASSERT_TRUE(kvs);
+    EXPECT_FALSE(std::filesystem::exists(default_prefix + ".img"));
+
+    cleanup_environment();
+}
@@ -0,0 +1,202 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+
+#include <limits>
+#include "test_kvs_general.hpp"
+
+const std::string image_file = default_prefix + ".img";
+
+/* Helper to write a defaults image file */
+static void write_image(const std::string& data) {
+    std::ofstream out(image_file, std::ios::binary);
+    out.write(data.data(), data.size());
+}
+
+/* Helper to write the defaults JSON file with its hash file */
+static void write_defaults(const std::string& json) {
+    std::ofstream json_file(default_prefix + ".json");
+    json_file << json;
+    json_file.close();
+    const uint32_t hash = adler32(json);
+    std::ofstream hash_file(default_prefix + ".hash", std::ios::binary);
+    hash_file.put((hash >> 24) & 0xFF);
+    hash_file.put((hash >> 16) & 0xFF);
+    hash_file.put((hash >> 8)  & 0xFF);
+    hash_file.put(hash & 0xFF);
+}
+
+TEST(kvs_defaults_image, map_file_lookup) {
+    prepare_environment();
+
+    KvsMap data;
+    data.emplace("b", KvsValue(std::numeric_limits<int64_t>::min()));
+    data.emplace("a", KvsValue("text"));
+    data.emplace("c", KvsValue(std::vector<KvsValue>{KvsValue(1.5), KvsValue(nullptr)}));
+    data.emplace("", KvsValue(false));
+    auto image_data = serialize_defaults_image(data, 0x12345678U);
+    ASSERT_TRUE(image_data);
+    write_image(image_data.value());
+
+    auto image = KvsDefaultsImage::map_file(image_file);
+    ASSERT_TRUE(image);
+    EXPECT_TRUE(image.value().is_mapped());
+    EXPECT_EQ(image.value().source_hash(), 0x12345678U);
+    EXPECT_EQ(image.value().size(), data.size());
+    for (const auto& [key, value] : data) {
+        EXPECT_TRUE(image.value().contains(key));
+        auto get_res = image.value().get(key);
+        ASSERT_TRUE(get_res);
+        EXPECT_EQ(get_res.value(), value);
+    }
+    EXPECT_FALSE(image.value().contains("d"));
+    EXPECT_EQ(image.value().get("aa").error(), ErrorCode::KeyNotFound);
+
+    /* Move transfers the mapping */
+    KvsDefaultsImage moved = std::move(image.value());
+    EXPECT_TRUE(moved.is_mapped());
+    EXPECT_FALSE(image.value().is_mapped());
+    EXPECT_FALSE(image.value().contains("a"));
+
+    /* Empty image */
+    image_data = serialize_defaults_image({}, 0U);
+    ASSERT_TRUE(image_data);
+    write_image(image_data.value());
+    image = KvsDefaultsImage::map_file(image_file);
+    ASSERT_TRUE(image);
+    EXPECT_EQ(image.value().size(), 0U);
+    EXPECT_FALSE(image.value().contains(""));
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, map_file_invalid) {
+    prepare_environment();
+
+    /* File not existing */
+    auto image = KvsDefaultsImage::map_file(image_file);
+    ASSERT_FALSE(image);
+    EXPECT_EQ(image.error(), ErrorCode::KvsFileReadError);
+
+    KvsMap data;
+    data.emplace("key", KvsValue(42.0));
+    const std::string image_data = serialize_defaults_image(data, 0U).value();
+
+    /* Corrupted byte, wrong magic, truncated file and empty file */
+    std::string corrupted = image_data;
+    corrupted[corrupted.size() - 6U] ^= 0x01;
+    std::string wrong_magic = image_data;
+    wrong_magic[0] = 'X';
+    for (const auto& invalid : {corrupted, wrong_magic, image_data.substr(0, image_data.size() - 1U), std::string()}) {
+        write_image(invalid);
+        image = KvsDefaultsImage::map_file(image_file);
+        ASSERT_FALSE(image);
+        EXPECT_EQ(image.error(), ErrorCode::ValidationFailed);
+    }
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, open_generates_image) {
+    prepare_environment();
+
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_TRUE(std::filesystem::exists(image_file));
+    EXPECT_TRUE(kvs.value().default_image.is_mapped());
+    EXPECT_TRUE(kvs.value().default_values.empty()); /* Served from the mapping */
+    EXPECT_EQ(kvs.value().default_image.source_hash(), adler32(default_json));
+
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue(static_cast<int32_t>(5)));
+    EXPECT_EQ(kvs.value().get_value("default").value(), KvsValue(static_cast<int32_t>(5)));
+    EXPECT_TRUE(kvs.value().has_default_value("default").value());
+    EXPECT_FALSE(kvs.value().has_default_value("kvs").value());
+    EXPECT_TRUE(kvs.value().reset_key("default"));
+    EXPECT_EQ(static_cast<ErrorCode>(*kvs.value().reset_key("kvs").error()), ErrorCode::KeyDefaultNotFound);
+
+    /* The image is used by the next open without parsing the JSON (JSON content is not checked anymore) */
+    std::ofstream json_file(default_prefix + ".json");
+    json_file << "{ invalid json }";
+    json_file.close();
+    kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue(static_cast<int32_t>(5)));
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, open_regenerates_outdated_image) {
+    prepare_environment();
+
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+
+    /* New defaults JSON (and hash) */
+    const std::string new_default_json = R"({"default":{"t":"str","v":"new"}})";
+    write_defaults(new_default_json);
+    kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_EQ(kvs.value().default_image.source_hash(), adler32(new_default_json));
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue("new"));
+
+    /* Corrupted image is regenerated as well */
+    std::string image_data(std::filesystem::file_size(image_file), '\0');
+    std::ifstream(image_file, std::ios::binary).read(image_data.data(), image_data.size());
+    image_data[image_data.size() - 6U] ^= 0x01;
+    write_image(image_data);
+    kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_TRUE(kvs.value().default_image.is_mapped());
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue("new"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, open_image_without_json) {
+    prepare_environment();
+
+    KvsMap data;
+    data.emplace("default", KvsValue(true));
+    write_image(serialize_defaults_image(data, 0U).value());
+    std::filesystem::remove(default_prefix + ".json");
+    std::filesystem::remove(default_prefix + ".hash");
+
+    /* Deployed image */
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue(true));
+
+    /* Invalid image */
+    write_image("invalid");
+    kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_FALSE(kvs);
+    EXPECT_EQ(static_cast<ErrorCode>(*kvs.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_defaults_image, open_read_only_directory) {
+    prepare_environment();
+
+    /* Image can't be written, the parsed default values are used */
+    std::filesystem::permissions(data_dir, std::filesystem::perms::owner_read | std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::replace);
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Required, OpenNeedKvs::Required, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+    EXPECT_FALSE(kvs.value().default_image.is_mapped());
+    EXPECT_EQ(kvs.value().get_default_value("default").value(), KvsValue(static_cast<int32_t>(5)));
+
+    std::filesystem::permissions(data_dir, std::filesystem::perms::owner_all, std::filesystem::perm_options::replace);
+    EXPECT_FALSE(std::filesystem::exists(image_file));
+    cleanup_environment();
+}
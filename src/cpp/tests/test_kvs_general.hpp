@@ -21,7 +21,9 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <memory_resource>
 #include <string>
+#include <thread>
 #include <unistd.h>
 
 /* Change Private Members and final to public to allow access to member variables (kvs and kvsbuilder) and derive from kvsvalue in unittests*/
@@ -30,7 +32,13 @@
 #include "kvsbuilder.hpp"
 #undef private
 #undef final
+#include "internal/kvs_binary.hpp"
+#include "internal/kvs_capture.hpp"
 #include "internal/kvs_helper.hpp"
+#include "internal/kvs_json_parser.hpp"
+#include "internal/kvs_json_stream.hpp"
+#include "internal/kvs_rcu.hpp"
+#include "internal/kvs_wal.hpp"
 #include "score/json/i_json_parser_mock.h"
 #include "score/json/i_json_writer_mock.h"
 #include "score/filesystem/filesystem_mock.h"
@@ -82,3 +90,30 @@ public:
 };
 
 ////////////////////////////////////////////////////////////////////////////////
+/* Memory resource counting the allocations of the KVS data (see KvsAllocator) */
+////////////////////////////////////////////////////////////////////////////////
+
+/* On the stack: the owner's reference is never released, the allocators using it must be destroyed first */
+class CountingResource final : public KvsResource {
+public:
+    CountingResource() = default;
+    ~CountingResource() override = default;
+
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        deallocations++;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,21 @@ TEST(kvs_calculate_hash_adler32, calculate_hash_adler32) {
 
 }
 
+TEST(kvs_calculate_hash_adler32, update_hash_adler32_incremental) {
+    std::string test_data(20000, 'a');
+    for (size_t i = 0; i < test_data.size(); ++i) {
+        test_data[i] = static_cast<char>(i * 31U);
+    }
+    /* Checksum over chunks equals the checksum over the whole data */
+    uint32_t hash = 1U;
+    for (size_t pos = 0; pos < test_data.size(); pos += 777U) {
+        const size_t chunk = std::min<size_t>(777U, test_data.size() - pos);
+        hash = update_hash_adler32(hash, test_data.data() + pos, chunk);
+    }
+    EXPECT_EQ(hash, calculate_hash_adler32(test_data));
+    EXPECT_EQ(update_hash_adler32(1U, "", 0U), 1U);
+}
+
 TEST(kvs_calculate_hash_adler32, calculate_hash_adler32_large_data) {
     // Create Teststring with more than 5552 characters to ensure that the hash is calculated correctly
     std::string large_data(6000, 'A');
@@ -147,6 +162,51 @@ TEST(kvs_any_to_kvsvalue, any_to_kvsvalue_string) {
     EXPECT_EQ(result.value().getType(), KvsValue::Type::String);
 }
 
+TEST(kvs_any_to_kvsvalue, any_to_kvsvalue_bytes) {
+    score::json::Object obj;
+    obj.emplace("t", score::json::Any(std::string("bin")));
+    obj.emplace("v", score::json::Any(std::string("AAH/")));
+    score::json::Any any_obj(std::move(obj));
+    auto result = any_to_kvsvalue(any_obj);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value(), KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0x01U, 0xFFU})));
+
+    score::json::Object invalid;
+    invalid.emplace("t", score::json::Any(std::string("bin")));
+    invalid.emplace("v", score::json::Any(std::string("AAH")));
+    score::json::Any any_invalid(std::move(invalid));
+    EXPECT_FALSE(any_to_kvsvalue(any_invalid));
+}
+
+TEST(kvs_any_to_kvsvalue, any_to_kvsvalue_packed_array) {
+    score::json::List list;
+    list.push_back(score::json::Any(1.5));
+    list.push_back(score::json::Any(-2.0));
+    score::json::Object obj;
+    obj.emplace("t", score::json::Any(std::string("arr_f64")));
+    obj.emplace("v", score::json::Any(std::move(list)));
+    score::json::Any any_obj(std::move(obj));
+    auto result = any_to_kvsvalue(any_obj);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value(), KvsValue(KvsValue::ArrayF64{1.5, -2.0}));
+
+    /* Element of another type */
+    score::json::List invalid_list;
+    invalid_list.push_back(score::json::Any(std::string("1")));
+    score::json::Object invalid;
+    invalid.emplace("t", score::json::Any(std::string("arr_i32")));
+    invalid.emplace("v", score::json::Any(std::move(invalid_list)));
+    score::json::Any any_invalid(std::move(invalid));
+    EXPECT_FALSE(any_to_kvsvalue(any_invalid));
+
+    /* Unknown element type */
+    score::json::Object unknown;
+    unknown.emplace("t", score::json::Any(std::string("arr_x32")));
+    unknown.emplace("v", score::json::Any(score::json::List{}));
+    score::json::Any any_unknown(std::move(unknown));
+    EXPECT_FALSE(any_to_kvsvalue(any_unknown));
+}
+
 TEST(kvs_any_to_kvsvalue, any_to_kvsvalue_null) {
     score::json::Object obj;
     obj.emplace("t", score::json::Any(std::string("null")));
@@ -479,11 +539,36 @@ TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_string) {
     EXPECT_EQ(obj.at("v").As<std::string>().value().get(), "test");
 }
 
+TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_bytes) {
+    KvsValue bytes_val(KvsValue::Bytes(std::vector<uint8_t>{0x66U, 0x6FU, 0x6FU, 0x62U}));
+    auto result = kvsvalue_to_any(bytes_val);
+    ASSERT_TRUE(result);
+    const auto& obj = result.value().As<score::json::Object>().value().get();
+    EXPECT_EQ(obj.at("t").As<std::string>().value().get(), "bin");
+    EXPECT_EQ(obj.at("v").As<std::string>().value().get(), "Zm9vYg==");
+}
+
+TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_packed_array) {
+    auto result = kvsvalue_to_any(KvsValue(KvsValue::ArrayI64{-1, 5}));
+    ASSERT_TRUE(result);
+    const auto& obj = result.value().As<score::json::Object>().value().get();
+    EXPECT_EQ(obj.at("t").As<std::string>().value().get(), "arr_i64");
+    const auto& list = obj.at("v").As<score::json::List>().value().get();
+    ASSERT_EQ(list.size(), 2U);
+    EXPECT_EQ(list[0].As<int64_t>().value(), -1);
+    EXPECT_EQ(list[1].As<int64_t>().value(), 5);
+
+    /* Converted back */
+    auto back = any_to_kvsvalue(result.value());
+    ASSERT_TRUE(back);
+    EXPECT_EQ(back.value(), KvsValue(KvsValue::ArrayI64{-1, 5}));
+}
+
 TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_array) {
     KvsValue::Array array;
-    array.push_back(std::make_shared<KvsValue>(true));
-    array.push_back(std::make_shared<KvsValue>(1.1));
-    array.push_back(std::make_shared<KvsValue>(std::string("test")));
+    array.emplace_back(true);
+    array.emplace_back(1.1);
+    array.emplace_back(std::string("test"));
     KvsValue array_val(array);
     auto result = kvsvalue_to_any(array_val);
     ASSERT_TRUE(result);
@@ -507,8 +592,8 @@ TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_array) {
 
 TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_object) {
     KvsValue::Object obj;
-    obj.emplace("flag", std::make_shared<KvsValue>(true)); // Boolean
-    obj.emplace("count", std::make_shared<KvsValue>(42.0)); // F64
+    obj.emplace("flag", KvsValue(true)); // Boolean
+    obj.emplace("count", KvsValue(42.0)); // F64
     KvsValue obj_val(obj);
 
     auto result = kvsvalue_to_any(obj_val);
@@ -537,18 +622,311 @@ TEST(kvs_kvsvalue_to_any, kvsvalue_to_any_invalid) {
 
     /* Invalid values in array and object */
     KvsValue::Array array;
-    array.push_back(std::make_shared<KvsValue>(42.0));
-    array.push_back(std::make_shared<KvsValue>(invalid));
+    array.emplace_back(42.0);
+    array.emplace_back(invalid);
     KvsValue array_invalid(array);
     result = kvsvalue_to_any(array_invalid);
     EXPECT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), ErrorCode::InvalidValueType);
 
     KvsValue::Object obj;
-    obj.emplace("valid", std::make_shared<KvsValue>(42.0));
-    obj.emplace("invalid", std::make_shared<KvsValue>(invalid));
+    obj.emplace("valid", KvsValue(42.0));
+    obj.emplace("invalid", KvsValue(invalid));
     KvsValue obj_invalid(obj);
     result = kvsvalue_to_any(obj_invalid);
     EXPECT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), ErrorCode::InvalidValueType);
 }
+
+TEST(kvs_kvsvalue, kvsvalue_equality) {
+    /* Scalars */
+    EXPECT_EQ(KvsValue(1.0), KvsValue(1.0));
+    EXPECT_NE(KvsValue(1.0), KvsValue(2.0));
+    EXPECT_NE(KvsValue(static_cast<int32_t>(1)), KvsValue(static_cast<uint32_t>(1))); /* Different types */
+    EXPECT_EQ(KvsValue(std::string("a")), KvsValue("a"));
+    EXPECT_EQ(KvsValue(nullptr), KvsValue(nullptr));
+
+    /* Arrays and objects are compared deeply */
+    KvsValue array1(std::vector<KvsValue>{KvsValue(1.0), KvsValue(true)});
+    KvsValue array2(std::vector<KvsValue>{KvsValue(1.0), KvsValue(true)});
+    KvsValue array3(std::vector<KvsValue>{KvsValue(1.0)});
+    EXPECT_EQ(array1, array2);
+    EXPECT_NE(array1, array3);
+
+    std::unordered_map<std::string, KvsValue> map1{{"a", array1}, {"b", KvsValue(false)}};
+    std::unordered_map<std::string, KvsValue> map2{{"a", array2}, {"b", KvsValue(false)}};
+    std::unordered_map<std::string, KvsValue> map3{{"a", array3}, {"b", KvsValue(false)}};
+    std::unordered_map<std::string, KvsValue> map4{{"a", array1}, {"c", KvsValue(false)}};
+    EXPECT_EQ(KvsValue(map1), KvsValue(map2));
+    EXPECT_NE(KvsValue(map1), KvsValue(map3));
+    EXPECT_NE(KvsValue(map1), KvsValue(map4));
+}
+
+TEST(kvs_kvsvalue, kvsvalue_deprecated_shared_ptr_containers) {
+    /* Ignore the deprecation warning of the former Array and Object types for GCC and CLANG */
+    #if defined(__clang__)
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    #elif defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    #endif
+    std::vector<std::shared_ptr<KvsValue>> array{std::make_shared<KvsValue>(1.0), nullptr};
+    std::unordered_map<std::string, std::shared_ptr<KvsValue>> object{
+        {"a", std::make_shared<KvsValue>(KvsValue(array))}, {"b", nullptr}};
+    KvsValue array_value(array);
+    KvsValue object_value(object);
+    #if defined(__clang__)
+    #pragma clang diagnostic pop
+    #elif defined(__GNUC__)
+    #pragma GCC diagnostic pop
+    #endif
+
+    /* The elements are copied, nullptr elements become Null values */
+    KvsValue expected_array(std::vector<KvsValue>{KvsValue(1.0), KvsValue(nullptr)});
+    EXPECT_EQ(array_value, expected_array);
+    *array[0] = KvsValue(2.0);
+    EXPECT_EQ(array_value, expected_array);
+    EXPECT_EQ(object_value, KvsValue(std::unordered_map<std::string, KvsValue>{
+        {"a", expected_array}, {"b", KvsValue(nullptr)}}));
+}
+
+TEST(kvs_kvsvalue, kvsobject_functions) {
+    /* Members are sorted by key, the last member of duplicate keys is used */
+    KvsValue::Object obj(std::vector<KvsValue::Object::value_type>{
+        {"b", KvsValue(1.0)}, {"a", KvsValue(2.0)}, {"b", KvsValue(3.0)}});
+    ASSERT_EQ(obj.size(), 2U);
+    EXPECT_EQ(obj.begin()->first, "a");
+    EXPECT_EQ(std::get<double>(obj.at("b").getValue()), 3.0);
+    EXPECT_THROW(obj.at("x"), std::out_of_range);
+
+    /* emplace keeps, insert_or_assign replaces an existing value */
+    EXPECT_FALSE(obj.emplace("a", KvsValue(4.0)).second);
+    EXPECT_EQ(std::get<double>(obj.at("a").getValue()), 2.0);
+    EXPECT_FALSE(obj.insert_or_assign("a", KvsValue(4.0)).second);
+    EXPECT_EQ(std::get<double>(obj.at("a").getValue()), 4.0);
+    EXPECT_TRUE(obj.emplace("c", KvsValue(5.0)).second);  /* Appended */
+    EXPECT_TRUE(obj.emplace("0", KvsValue(6.0)).second);  /* Inserted at the front */
+    std::vector<std::string> keys;
+    for (const auto& [key, value] : obj) {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"0", "a", "b", "c"}));
+
+    EXPECT_EQ(obj.count("b"), 1U);
+    EXPECT_EQ(obj.erase("b"), 1U);
+    EXPECT_EQ(obj.erase("b"), 0U);
+    EXPECT_EQ(obj.count("b"), 0U);
+    EXPECT_EQ(obj.find("b"), obj.end());
+
+    /* Copies are independent */
+    KvsValue value(obj);
+    KvsValue copy(value);
+    EXPECT_EQ(copy, value);
+    obj.clear();
+    EXPECT_TRUE(obj.empty());
+    EXPECT_EQ(std::get<KvsValue::Object>(copy.getValue()).size(), 3U);
+
+    /* Objects with the same members are equal independent of the insertion order */
+    EXPECT_EQ(KvsValue(KvsValue::Object{{"x", KvsValue(1.0)}, {"y", KvsValue(2.0)}}),
+              KvsValue(KvsValue::Object{{"y", KvsValue(2.0)}, {"x", KvsValue(1.0)}}));
+}
+
+TEST(kvs_kvsvalue, kvsvalue_copy_on_write) {
+    KvsValue::Array inner{KvsValue(1.0), KvsValue(2.0)};
+    KvsValue::Array outer{KvsValue(inner), KvsValue("text")};
+    KvsValue value(outer);
+
+    /* Copies share the elements */
+    KvsValue copy(value);
+    const auto& value_array = std::get<KvsValue::Array>(value.getValue());
+    const auto& copy_array = std::get<KvsValue::Array>(copy.getValue());
+    EXPECT_EQ(value_array.elements.get(), copy_array.elements.get());
+    EXPECT_EQ(copy, value);
+
+    /* A change copies the changed array only, nested arrays stay shared */
+    KvsValue::Array changed = copy_array;
+    changed.push_back(KvsValue(3.0));
+    EXPECT_NE(changed.elements.get(), copy_array.elements.get());
+    EXPECT_EQ(std::get<KvsValue::Array>(changed[0].getValue()).elements.get(),
+              std::get<KvsValue::Array>(value_array[0].getValue()).elements.get());
+    EXPECT_EQ(value_array.size(), 2U);
+    EXPECT_EQ(changed.size(), 3U);
+    EXPECT_NE(KvsValue(changed), value);
+
+    /* An unshared array is changed in place */
+    const auto* elements = changed.elements.get();
+    changed[2] = KvsValue(4.0);
+    EXPECT_EQ(changed.elements.get(), elements);
+
+    /* Objects */
+    KvsValue::Object object{{"a", KvsValue(1.0)}};
+    KvsValue object_value(object);
+    EXPECT_EQ(std::get<KvsValue::Object>(object_value.getValue()).members.get(), object.members.get());
+    EXPECT_FALSE(object.insert_or_assign("a", KvsValue(2.0)).second);
+    EXPECT_EQ(std::get<double>(std::get<KvsValue::Object>(object_value.getValue()).at("a").getValue()), 1.0);
+    EXPECT_EQ(std::get<double>(object.at("a").getValue()), 2.0);
+
+    /* A failed lookup doesn't copy the members */
+    const KvsValue::Object& stored = std::get<KvsValue::Object>(object_value.getValue());
+    KvsValue::Object shared = stored;
+    EXPECT_THROW(shared.at("x"), std::out_of_range);
+    EXPECT_EQ(shared.members.get(), stored.members.get());
+    EXPECT_EQ(shared.erase("x"), 0U);
+    EXPECT_EQ(shared.members.get(), stored.members.get());
+}
+
+TEST(kvs_kvsvalue, copy_on_write_mutable_references) {
+    /* A reference taken before a copy changes only its own array */
+    KvsValue::Array array{KvsValue(1.0), KvsValue(2.0)};
+    KvsValue& first = array[0];
+    KvsValue::Array copy = array;
+    EXPECT_NE(copy.elements.get(), array.elements.get());
+    first = KvsValue(5.0);
+    EXPECT_EQ(std::get<double>(std::as_const(copy)[0].getValue()), 1.0);
+    EXPECT_EQ(std::get<double>(std::as_const(array)[0].getValue()), 5.0);
+
+    /* The copy didn't hand out references and shares again, clear() ends the exposure */
+    KvsValue::Array second = copy;
+    EXPECT_EQ(second.elements.get(), copy.elements.get());
+    array.clear();
+    array.push_back(KvsValue(3.0));
+    KvsValue::Array third;
+    third = array;
+    EXPECT_EQ(third.elements.get(), array.elements.get());
+
+    /* Objects: iterators returned by find and insert_or_assign */
+    KvsValue::Object object{{"a", KvsValue(1.0)}};
+    auto member = object.insert_or_assign("b", KvsValue(2.0)).first;
+    KvsValue::Object object_copy = object;
+    member->second = KvsValue(6.0);
+    EXPECT_EQ(std::get<double>(std::as_const(object_copy).at("b").getValue()), 2.0);
+    EXPECT_EQ(std::get<double>(std::as_const(object).at("b").getValue()), 6.0);
+
+    /* Packed arrays: pointer returned by data() */
+    KvsValue::ArrayF64 packed{1.0, 2.0};
+    double* packed_data = packed.data();
+    KvsValue::ArrayF64 packed_copy = packed;
+    packed_data[0] = 7.0;
+    EXPECT_EQ(packed_copy[0], 1.0);
+    EXPECT_EQ(packed[0], 7.0);
+}
+
+TEST(kvs_kvsvalue, kvsbytes_functions) {
+    const std::vector<uint8_t> raw{0x01U, 0x02U, 0x03U};
+    KvsValue::Bytes bytes(raw.data(), raw.size());
+    EXPECT_EQ(bytes.size(), 3U);
+    EXPECT_FALSE(bytes.empty());
+    EXPECT_EQ(bytes.to_vector(), raw);
+    EXPECT_EQ(bytes, KvsValue::Bytes(raw));
+    EXPECT_NE(bytes, KvsValue::Bytes());
+    EXPECT_TRUE(KvsValue::Bytes().empty());
+    EXPECT_EQ(KvsValue(bytes).getType(), KvsValue::Type::Bytes);
+    EXPECT_NE(KvsValue(bytes), KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(2.0), KvsValue(3.0)}));
+
+    /* Copies share the bytes, data() of a non-const copy unshares them */
+    KvsValue::Bytes copy = bytes;
+    EXPECT_EQ(static_cast<const KvsValue::Bytes&>(copy).data(), static_cast<const KvsValue::Bytes&>(bytes).data());
+    copy.data()[0] = 0x10U;
+    EXPECT_EQ(bytes.to_vector(), raw);
+    EXPECT_EQ(copy.to_vector(), (std::vector<uint8_t>{0x10U, 0x02U, 0x03U}));
+
+    copy.resize(5U);
+    EXPECT_EQ(copy.to_vector(), (std::vector<uint8_t>{0x10U, 0x02U, 0x03U, 0x00U, 0x00U}));
+    copy.assign(raw.data(), 1U);
+    EXPECT_EQ(copy.to_vector(), std::vector<uint8_t>{0x01U});
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+
+    /* Typed access */
+    std::vector<uint8_t> out;
+    EXPECT_TRUE(KvsValueConverter<std::vector<uint8_t>>::read(KvsValueConverter<std::vector<uint8_t>>::make(raw), out));
+    EXPECT_EQ(out, raw);
+    EXPECT_FALSE(KvsValueConverter<std::vector<uint8_t>>::read(KvsValue(1.0), out));
+
+    /* A moved vector is taken over without a copy */
+    std::vector<uint8_t> blob(64U, 0x5AU);
+    const uint8_t* blob_data = blob.data();
+    const KvsValue moved = KvsValueConverter<std::vector<uint8_t>>::make(std::move(blob));
+    EXPECT_EQ(std::get<KvsValue::Bytes>(moved.getValue()).data(), blob_data);
+
+    /* String literals are only writable (get_value_as<const char*> doesn't compile) */
+    static_assert(KvsValueConverter<const char*>::writable && !KvsValueConverter<const char*>::readable);
+    static_assert(!KvsValueConverter<std::vector<const char*>>::readable);
+    static_assert(KvsValueConverter<std::vector<std::string>>::readable);
+}
+
+TEST(kvs_kvsvalue, kvspackedarray_functions) {
+    const std::vector<double> raw{0.5, 1.5, 2.5};
+    KvsValue::ArrayF64 array(raw);
+    EXPECT_EQ(array.size(), 3U);
+    EXPECT_EQ(array[1], 1.5);
+    EXPECT_EQ(array.to_vector(), raw);
+    EXPECT_EQ(array, (KvsValue::ArrayF64{0.5, 1.5, 2.5}));
+    EXPECT_EQ(std::vector<double>(array.begin(), array.end()), raw);
+    EXPECT_EQ(KvsValue(array).getType(), KvsValue::Type::ArrayF64);
+    EXPECT_EQ(KvsValue(KvsValue::ArrayI32{1}).getType(), KvsValue::Type::ArrayI32);
+    EXPECT_EQ(KvsValue(KvsValue::ArrayU32{1U}).getType(), KvsValue::Type::ArrayU32);
+    EXPECT_EQ(KvsValue(KvsValue::ArrayI64{1}).getType(), KvsValue::Type::ArrayI64);
+    EXPECT_EQ(KvsValue(KvsValue::ArrayU64{1U}).getType(), KvsValue::Type::ArrayU64);
+
+    /* Packed and generic arrays of the same numbers are different values */
+    EXPECT_NE(KvsValue(array), KvsValue(std::vector<KvsValue>{KvsValue(0.5), KvsValue(1.5), KvsValue(2.5)}));
+
+    /* Copies share the elements */
+    KvsValue::ArrayF64 copy = array;
+    EXPECT_EQ(static_cast<const KvsValue::ArrayF64&>(copy).data(), static_cast<const KvsValue::ArrayF64&>(array).data());
+    copy.data()[0] = 9.0;
+    EXPECT_EQ(array[0], 0.5);
+    EXPECT_EQ(copy[0], 9.0);
+
+    /* Takes over the storage without a copy */
+    KvsValue::ArrayF64::Storage storage{1.0, 2.0};
+    const double* storage_data = storage.data();
+    KvsValue::ArrayF64 adopted(std::move(storage));
+    EXPECT_EQ(static_cast<const KvsValue::ArrayF64&>(adopted).data(), storage_data);
+
+    /* Typed access: the packed array itself (shared) and number vectors */
+    KvsValue value(array);
+    KvsValue::ArrayF64 shared;
+    EXPECT_TRUE(KvsValueConverter<KvsValue::ArrayF64>::read(value, shared));
+    EXPECT_EQ(static_cast<const KvsValue::ArrayF64&>(shared).data(), static_cast<const KvsValue::ArrayF64&>(array).data());
+    std::vector<double> out;
+    EXPECT_TRUE(KvsValueConverter<std::vector<double>>::read(value, out));
+    EXPECT_EQ(out, raw);
+    std::vector<int32_t> wrong_type;
+    EXPECT_FALSE(KvsValueConverter<std::vector<int32_t>>::read(value, wrong_type));
+    KvsValue::ArrayI32 wrong_array;
+    EXPECT_FALSE(KvsValueConverter<KvsValue::ArrayI32>::read(value, wrong_array));
+    EXPECT_TRUE(KvsValueConverter<std::vector<double>>::read(KvsValue(std::vector<KvsValue>{KvsValue(4.0)}), out));
+    EXPECT_EQ(out, std::vector<double>{4.0});
+}
+
+TEST(kvs_base64, base64_encode_decode) {
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+    };
+    for (const auto& [plain, encoded] : vectors) {
+        std::string out = "prefix";
+        encode_base64(out, reinterpret_cast<const uint8_t*>(plain.data()), plain.size());
+        EXPECT_EQ(out, "prefix" + encoded);
+        KvsBytes decoded;
+        ASSERT_TRUE(decode_base64(encoded, decoded)) << encoded;
+        EXPECT_EQ(std::string(decoded.begin(), decoded.end()), plain);
+    }
+
+    /* All byte values */
+    std::vector<uint8_t> all(256U);
+    for (size_t idx = 0; idx < all.size(); ++idx) {
+        all[idx] = static_cast<uint8_t>(idx);
+    }
+    std::string encoded;
+    encode_base64(encoded, all.data(), all.size());
+    KvsBytes decoded;
+    ASSERT_TRUE(decode_base64(encoded, decoded));
+    EXPECT_EQ(decoded.to_vector(), all);
+
+    for (const std::string invalid : {"Zg", "Zg=", "Z===", "====", "Zm9v\n", "Zm=v", "Zg==Zm8=", "Zm 8"}) {
+        EXPECT_FALSE(decode_base64(invalid, decoded)) << invalid;
+    }
+}
@@ -0,0 +1,167 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+
+#include <limits>
+#include "test_kvs_general.hpp"
+
+/* Helper to parse a single {"t":..,"v":..} value */
+static score::Result<KvsValue> parse_single(const std::string& typed_value) {
+    score::Result<KvsValue> result = score::MakeUnexpected(ErrorCode::UnmappedError);
+    auto parse_res = parse_kvs_json("{\"k\":" + typed_value + "}");
+    if (parse_res) {
+        result = parse_res.value().at("k");
+    }else{
+        result = score::MakeUnexpected(static_cast<ErrorCode>(*parse_res.error()));
+    }
+    return result;
+}
+
+TEST(kvs_json_parser, parse_kvs_json_types) {
+    EXPECT_EQ(parse_single(R"({"t":"i32","v":-5})").value(), KvsValue(static_cast<int32_t>(-5)));
+    EXPECT_EQ(parse_single(R"({"t":"u32","v":5})").value(), KvsValue(static_cast<uint32_t>(5)));
+    EXPECT_EQ(parse_single(R"({"t":"i64","v":-9223372036854775808})").value(), KvsValue(std::numeric_limits<int64_t>::min()));
+    EXPECT_EQ(parse_single(R"({"t":"u64","v":18446744073709551615})").value(), KvsValue(std::numeric_limits<uint64_t>::max()));
+    EXPECT_EQ(parse_single(R"({"t":"f64","v":1.5e2})").value(), KvsValue(150.0));
+    EXPECT_EQ(parse_single(R"({"t":"bool","v":true})").value(), KvsValue(true));
+    EXPECT_EQ(parse_single(R"({"t":"bool","v":false})").value(), KvsValue(false));
+    EXPECT_EQ(parse_single(R"({"t":"str","v":"text"})").value(), KvsValue("text"));
+    EXPECT_EQ(parse_single(R"({"t":"null","v":null})").value(), KvsValue(nullptr));
+    EXPECT_EQ(parse_single(R"({"t":"arr","v":[{"t":"f64","v":1.0},{"t":"bool","v":false}]})").value(),
+              KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(false)}));
+    std::unordered_map<std::string, KvsValue> inner;
+    inner.emplace("x", KvsValue(nullptr));
+    EXPECT_EQ(parse_single(R"({"t":"obj","v":{"x":{"t":"null","v":null}}})").value(), KvsValue(inner));
+    EXPECT_EQ(parse_single(R"({"t":"bin","v":"AAH/Pw=="})").value(), KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0x01U, 0xFFU, 0x3FU})));
+    EXPECT_EQ(parse_single(R"({"t":"bin","v":"AAH\/Pw=="})").value(), KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0x01U, 0xFFU, 0x3FU})));
+    EXPECT_EQ(parse_single(R"({"t":"bin","v":""})").value(), KvsValue(KvsValue::Bytes()));
+    EXPECT_EQ(parse_single(R"({"t":"arr_i32","v":[-2147483648, 7]})").value(), KvsValue(KvsValue::ArrayI32{std::numeric_limits<int32_t>::min(), 7}));
+    EXPECT_EQ(parse_single(R"({"t":"arr_u32","v":[4294967295]})").value(), KvsValue(KvsValue::ArrayU32{std::numeric_limits<uint32_t>::max()}));
+    EXPECT_EQ(parse_single(R"({"t":"arr_i64","v":[-1,2e3]})").value(), KvsValue(KvsValue::ArrayI64{-1, 2000}));
+    EXPECT_EQ(parse_single(R"({"t":"arr_u64","v":[18446744073709551615]})").value(), KvsValue(KvsValue::ArrayU64{std::numeric_limits<uint64_t>::max()}));
+    EXPECT_EQ(parse_single(R"({"t":"arr_f64","v":[1.5, 2, -1e-3]})").value(), KvsValue(KvsValue::ArrayF64{1.5, 2.0, -1e-3}));
+    EXPECT_EQ(parse_single(R"({"t":"arr_f64","v":[ ]})").value(), KvsValue(KvsValue::ArrayF64{}));
+
+    /* Integral numbers with fraction or exponent are accepted for integer types */
+    EXPECT_EQ(parse_single(R"({"t":"i32","v":42.0})").value(), KvsValue(static_cast<int32_t>(42)));
+    EXPECT_EQ(parse_single(R"({"t":"u64","v":1e3})").value(), KvsValue(static_cast<uint64_t>(1000)));
+
+    /* Empty KVS and whitespace */
+    auto result = parse_kvs_json(" \n{ }\t");
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.value().empty());
+}
+
+TEST(kvs_json_parser, parse_kvs_json_member_order) {
+    /* "v" before "t" and unknown members */
+    EXPECT_EQ(parse_single(R"({"v":[{"v":7,"t":"u32"}],"x":{"y":[1,"z"]},"t":"arr"})").value(),
+              KvsValue(std::vector<KvsValue>{KvsValue(static_cast<uint32_t>(7))}));
+}
+
+TEST(kvs_json_parser, parse_kvs_json_strings) {
+    auto result = parse_kvs_json(R"({"key \"q\"\\":{"t":"str","v":"a\nb\t\u0001 \u00e4\ud83d\ude00\/"}})");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().at("key \"q\"\\"), KvsValue("a\nb\t\x01 \xC3\xA4\xF0\x9F\x98\x80/"));
+
+    /* Invalid escapes, lone surrogate and unescaped control character */
+    EXPECT_EQ(parse_single(R"({"t":"str","v":"\x"})").error(), ErrorCode::JsonParserError);
+    EXPECT_EQ(parse_single(R"({"t":"str","v":"\ud83d"})").error(), ErrorCode::JsonParserError);
+    EXPECT_EQ(parse_single("{\"t\":\"str\",\"v\":\"a\nb\"}").error(), ErrorCode::JsonParserError);
+}
+
+TEST(kvs_json_parser, parse_kvs_json_roundtrip) {
+    KvsMap data;
+    data.emplace("f64", KvsValue(0.1));
+    data.emplace("i64", KvsValue(std::numeric_limits<int64_t>::max()));
+    data.emplace("str", KvsValue(std::string("\"\\\x1f \xC3\xA4")));
+    data.emplace("arr", KvsValue(std::vector<KvsValue>{KvsValue(nullptr), KvsValue(std::vector<KvsValue>{})}));
+    std::ostringstream out;
+    ASSERT_TRUE(stream_json_data(data, out));
+
+    auto result = parse_kvs_json(out.str());
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value(), data);
+}
+
+TEST(kvs_json_parser, parse_kvs_json_syntax_error) {
+    const std::vector<std::string> invalid = {
+        "",
+        "42.0",
+        "{ invalid json }",
+        R"({"k":{"t":"i32","v":1})",
+        R"({"k":{"t":"i32","v":1}} x)",
+        R"({"k":{"t":"i32","v":1},})",
+        R"({"k":{"t":"i32","v":01}})",
+        R"({"k":{"t":"f64","v":1.}})",
+        R"({"k":{"t":"f64","v":-}})",
+        R"({"k":{"t":"bool","v":tru}})",
+        R"({"k":{"t":"arr_f64","v":[1.0,]}})",
+        R"({"k":{"t":"arr_f64","v":[1.0}})",
+    };
+    for (const auto& json : invalid) {
+        auto result = parse_kvs_json(json);
+        ASSERT_FALSE(result) << json;
+        EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::JsonParserError) << json;
+    }
+
+    /* Nesting depth limit */
+    std::string deep;
+    for (size_t i = 0; i < KVS_JSON_MAX_DEPTH; ++i) {
+        deep += R"({"t":"arr","v":[)";
+    }
+    deep += R"({"t":"null","v":null})";
+    for (size_t i = 0; i < KVS_JSON_MAX_DEPTH; ++i) {
+        deep += "]}";
+    }
+    EXPECT_EQ(parse_single(deep).error(), ErrorCode::JsonParserError);
+}
+
+TEST(kvs_json_parser, parse_kvs_json_schema_error) {
+    const std::vector<std::string> invalid = {
+        R"(5)",
+        R"({"t":"invalid","v":42})",
+        R"({"t":5,"v":42})",
+        R"({"t":"i32"})",
+        R"({"v":42})",
+        R"({"t":"i32","v":"42"})",
+        R"({"t":"i32","v":2147483648})",
+        R"({"t":"i32","v":1.5})",
+        R"({"t":"u32","v":-1})",
+        R"({"t":"u64","v":1.8446744073709552e19})",
+        R"({"t":"f64","v":1e400})",
+        R"({"t":"bool","v":1})",
+        R"({"t":"str","v":null})",
+        R"({"t":"null","v":0})",
+        R"({"t":"arr","v":{}})",
+        R"({"t":"arr","v":[1]})",
+        R"({"t":"obj","v":[]})",
+        R"({"t":"bin","v":[0]})",
+        R"({"t":"bin","v":"AAH"})",
+        R"({"t":"bin","v":"AA=A"})",
+        R"({"t":"bin","v":"A*=="})",
+        R"({"t":"bin","v":"=AAA"})",
+        R"({"t":"arr_f64","v":{}})",
+        R"({"t":"arr_f64","v":[1.0,"2"]})",
+        R"({"t":"arr_f64","v":[{"t":"f64","v":1.0}]})",
+        R"({"t":"arr_i32","v":[2147483648]})",
+        R"({"t":"arr_u32","v":[1.5]})",
+        R"({"t":"arr_u64","v":[-1]})",
+        R"({"t":"arr_x64","v":[]})",
+        R"({"t":"arr_f32","v":[]})",
+    };
+    for (const auto& json : invalid) {
+        auto result = parse_single(json);
+        ASSERT_FALSE(result) << json;
+        EXPECT_EQ(result.error(), ErrorCode::InvalidValueType) << json;
+    }
+}
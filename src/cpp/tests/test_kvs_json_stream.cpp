@@ -0,0 +1,155 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+#include <cmath>
+#include <limits>
+#include "test_kvs_general.hpp"
+
+/* Helper to stream a single key-value pair */
+static std::string stream_single(const KvsValue& value) {
+    KvsMap data;
+    data.emplace("k", value);
+    std::ostringstream out;
+    auto result = stream_json_data(data, out);
+    EXPECT_TRUE(result);
+    return out.str();
+}
+
+TEST(kvs_json_stream, stream_json_data_types) {
+    EXPECT_EQ(stream_single(KvsValue(static_cast<int32_t>(-5))), R"({"k":{"t":"i32","v":-5}})");
+    EXPECT_EQ(stream_single(KvsValue(static_cast<uint32_t>(5))), R"({"k":{"t":"u32","v":5}})");
+    EXPECT_EQ(stream_single(KvsValue(std::numeric_limits<int64_t>::min())), R"({"k":{"t":"i64","v":-9223372036854775808}})");
+    EXPECT_EQ(stream_single(KvsValue(std::numeric_limits<uint64_t>::max())), R"({"k":{"t":"u64","v":18446744073709551615}})");
+    EXPECT_EQ(stream_single(KvsValue(1.5)), R"({"k":{"t":"f64","v":1.5}})");
+    EXPECT_EQ(stream_single(KvsValue(2.0)), R"({"k":{"t":"f64","v":2.0}})");
+    EXPECT_EQ(stream_single(KvsValue(true)), R"({"k":{"t":"bool","v":true}})");
+    EXPECT_EQ(stream_single(KvsValue(false)), R"({"k":{"t":"bool","v":false}})");
+    EXPECT_EQ(stream_single(KvsValue("text")), R"({"k":{"t":"str","v":"text"}})");
+    EXPECT_EQ(stream_single(KvsValue(nullptr)), R"({"k":{"t":"null","v":null}})");
+    EXPECT_EQ(stream_single(KvsValue(std::vector<KvsValue>{KvsValue(1.0), KvsValue(false)})),
+              R"({"k":{"t":"arr","v":[{"t":"f64","v":1.0},{"t":"bool","v":false}]}})");
+    EXPECT_EQ(stream_single(KvsValue(std::vector<KvsValue>{})), R"({"k":{"t":"arr","v":[]}})");
+    std::unordered_map<std::string, KvsValue> inner;
+    inner.emplace("x", KvsValue(nullptr));
+    EXPECT_EQ(stream_single(KvsValue(inner)), R"({"k":{"t":"obj","v":{"x":{"t":"null","v":null}}}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x00U, 0x01U, 0xFFU, 0x3FU}))), R"({"k":{"t":"bin","v":"AAH/Pw=="}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::Bytes(std::vector<uint8_t>{0x66U, 0x6FU}))), R"({"k":{"t":"bin","v":"Zm8="}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::Bytes())), R"({"k":{"t":"bin","v":""}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayI32{-1, 2})), R"({"k":{"t":"arr_i32","v":[-1,2]}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayU32{std::numeric_limits<uint32_t>::max()})), R"({"k":{"t":"arr_u32","v":[4294967295]}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayI64{std::numeric_limits<int64_t>::min()})), R"({"k":{"t":"arr_i64","v":[-9223372036854775808]}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayU64{0U, 1U})), R"({"k":{"t":"arr_u64","v":[0,1]}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayF64{1.5, 2.0, -1e300})), R"({"k":{"t":"arr_f64","v":[1.5,2.0,-1e+300]}})");
+    EXPECT_EQ(stream_single(KvsValue(KvsValue::ArrayF64{})), R"({"k":{"t":"arr_f64","v":[]}})");
+
+    /* Empty KVS */
+    std::ostringstream out;
+    ASSERT_TRUE(stream_json_data({}, out));
+    EXPECT_EQ(out.str(), "{}");
+}
+
+TEST(kvs_json_stream, stream_json_data_escaping) {
+    KvsMap data;
+    data.emplace("key \"q\"\\", KvsValue(std::string("a\nb\t\x01 \xC3\xA4")));
+    std::ostringstream out;
+    ASSERT_TRUE(stream_json_data(data, out));
+    EXPECT_EQ(out.str(), "{\"key \\\"q\\\"\\\\\":{\"t\":\"str\",\"v\":\"a\\nb\\t\\u0001 \xC3\xA4\"}}");
+}
+
+TEST(kvs_json_stream, stream_json_data_chunked_checksum) {
+    KvsMap data;
+    for (int32_t i = 0; i < 100; ++i) {
+        data.emplace("key" + std::to_string(i), KvsValue(std::string(static_cast<size_t>(i), 'x')));
+    }
+
+    std::ostringstream reference;
+    auto reference_res = stream_json_data(data, reference);
+    ASSERT_TRUE(reference_res);
+    EXPECT_EQ(reference_res.value(), adler32(reference.str()));
+
+    /* Output and checksum don't depend on the buffer size */
+    for (size_t buffer_size : {0U, 1U, 7U, 64U, 1U << 20}) {
+        std::ostringstream out;
+        auto result = stream_json_data(data, out, buffer_size);
+        ASSERT_TRUE(result);
+        EXPECT_EQ(out.str(), reference.str());
+        EXPECT_EQ(result.value(), reference_res.value());
+    }
+}
+
+TEST(kvs_json_stream, stream_json_data_roundtrip) {
+    auto kvs = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(kvs);
+
+    KvsMap data;
+    data.emplace("f64", KvsValue(0.1));
+    data.emplace("i64", KvsValue(static_cast<int64_t>(-1234567890123)));
+    data.emplace("str", KvsValue(std::string("quote \" and \\ backslash")));
+    data.emplace("arr", KvsValue(std::vector<KvsValue>{KvsValue(static_cast<uint32_t>(7)), KvsValue(nullptr)}));
+    std::vector<uint8_t> blob(10000U); /* Several base64 blocks */
+    for (size_t idx = 0; idx < blob.size(); ++idx) {
+        blob[idx] = static_cast<uint8_t>(idx * 7U);
+    }
+    data.emplace("bin", KvsValue(KvsValue::Bytes(blob)));
+    std::vector<double> table(1000U);
+    for (size_t idx = 0; idx < table.size(); ++idx) {
+        table[idx] = static_cast<double>(idx) / 7.0;
+    }
+    data.emplace("arr_f64", KvsValue(KvsValue::ArrayF64(table)));
+    data.emplace("arr_i64", KvsValue(KvsValue::ArrayI64{std::numeric_limits<int64_t>::max(), -1}));
+
+    std::ostringstream out;
+    ASSERT_TRUE(stream_json_data(data, out));
+    auto parsed = kvs.value().parse_json_data(out.str());
+    ASSERT_TRUE(parsed);
+    ASSERT_EQ(parsed.value().size(), data.size());
+    for (const auto& [key, value] : data) {
+        EXPECT_EQ(parsed.value().at(key), value);
+    }
+}
+
+TEST(kvs_json_stream, stream_json_data_failure) {
+    /* Invalid value type */
+    KvsMap data;
+    BrokenKvsValue invalid;
+    data.emplace("invalid", invalid);
+    std::ostringstream out;
+    auto result = stream_json_data(data, out);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::InvalidValueType);
+
+    /* NaN and infinity can't be represented in JSON */
+    data.clear();
+    data.emplace("nan", KvsValue(std::nan("")));
+    result = stream_json_data(data, out);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::InvalidValueType);
+    data.clear();
+    data.emplace("inf", KvsValue(std::numeric_limits<double>::infinity()));
+    result = stream_json_data(data, out);
+    ASSERT_FALSE(result);
+    data.clear();
+    data.emplace("arr_f64", KvsValue(KvsValue::ArrayF64{1.0, std::nan("")}));
+    result = stream_json_data(data, out);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::InvalidValueType);
+
+    /* Output stream failure */
+    data.clear();
+    data.emplace("key", KvsValue(1.0));
+    std::ostringstream failed_out;
+    failed_out.setstate(std::ios::badbit);
+    result = stream_json_data(data, failed_out);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::PhysicalStorageFailure);
+}
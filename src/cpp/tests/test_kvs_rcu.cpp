@@ -0,0 +1,157 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+
+#include <atomic>
+#include <optional>
+#include "test_kvs_general.hpp"
+
+/* Helper to open a KVS in read-mostly mode */
+static score::Result<Kvs> open_read_mostly_kvs() {
+    KvsOptions options;
+    options.read_mostly = true;
+    return Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+}
+
+TEST(kvs_rcu, persistent_map_versions) {
+    KvsPersistentMap empty;
+    EXPECT_EQ(empty.size(), 0U);
+    EXPECT_EQ(empty.find("key"), nullptr);
+
+    /* Every modification returns a new version, previous versions are unchanged */
+    KvsPersistentMap version1 = empty.set("key", KvsValue(1.0));
+    KvsPersistentMap version2 = version1.set("key", KvsValue(2.0));
+    KvsPersistentMap version3 = version2.erase("key");
+    EXPECT_EQ(version1.size(), 1U);
+    EXPECT_EQ(std::get<double>(version1.find("key")->getValue()), 1.0);
+    EXPECT_EQ(version2.size(), 1U);
+    EXPECT_EQ(std::get<double>(version2.find("key")->getValue()), 2.0);
+    EXPECT_EQ(version3.size(), 0U);
+    EXPECT_EQ(version3.find("key"), nullptr);
+    EXPECT_EQ(version3.erase("key").size(), 0U); /* Not existing key */
+}
+
+TEST(kvs_rcu, persistent_map_many_keys) {
+    /* Enough keys for several trie levels */
+    constexpr int32_t count = 5000;
+    KvsPersistentMap map;
+    for (int32_t i = 0; i < count; i++) {
+        map = map.set("key_" + std::to_string(i), KvsValue(i));
+    }
+    ASSERT_EQ(map.size(), static_cast<size_t>(count));
+    for (int32_t i = 0; i < count; i++) {
+        const KvsValue* value = map.find("key_" + std::to_string(i));
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(std::get<int32_t>(value->getValue()), i);
+    }
+    EXPECT_EQ(map.keys().size(), static_cast<size_t>(count));
+
+    /* Remove every second key */
+    KvsPersistentMap half = map;
+    for (int32_t i = 0; i < count; i += 2) {
+        half = half.erase("key_" + std::to_string(i));
+    }
+    EXPECT_EQ(half.size(), static_cast<size_t>(count / 2));
+    for (int32_t i = 0; i < count; i++) {
+        EXPECT_EQ(nullptr != half.find("key_" + std::to_string(i)), (1 == (i % 2)));
+        EXPECT_NE(map.find("key_" + std::to_string(i)), nullptr);
+    }
+
+    /* Built from an unordered map */
+    KvsMap data;
+    data.emplace("a", KvsValue(1.0));
+    data.emplace("b", KvsValue(std::string("text")));
+    KvsPersistentMap from_data = KvsPersistentMap::from(data);
+    EXPECT_EQ(from_data.size(), 2U);
+    EXPECT_EQ(std::get<std::string>(from_data.find("b")->getValue()), "text");
+}
+
+TEST(kvs_rcu, rcu_map_publish) {
+    KvsRcuMap map(KvsPersistentMap().set("key", KvsValue(1.0)));
+
+    /* A reader keeps its version while a new version is published */
+    std::optional<KvsRcuMap::ReadGuard> reader;
+    reader.emplace(map);
+    std::thread writer([&map]() {
+        map.publish(map.current().set("key", KvsValue(2.0)));
+    });
+    /* The writer waits for this reader before the previous version is reclaimed */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(std::get<double>((*reader)->find("key")->getValue()), 1.0);
+    EXPECT_EQ(std::get<double>(map.current().find("key")->getValue()), 2.0);
+    reader.reset();
+    writer.join();
+    reader.emplace(map);
+    EXPECT_EQ(std::get<double>((*reader)->find("key")->getValue()), 2.0);
+    reader.reset();
+
+    /* Concurrent readers and a writer */
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> failures{0};
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 4U; t++) {
+        readers.emplace_back([&map, &stop, &failures]() {
+            while (!stop) {
+                KvsRcuMap::ReadGuard reader(map);
+                const KvsValue* value = reader->find("key");
+                failures += ((nullptr == value) || (reader->size() != 1U)) ? 1U : 0U;
+            }
+        });
+    }
+    for (int32_t i = 0; i < 1000; i++) {
+        map.publish(map.current().set("key", KvsValue(i)));
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(failures.load(), 0U);
+    EXPECT_EQ(std::get<int32_t>(map.current().find("key")->getValue()), 999);
+}
+
+TEST(kvs_rcu, read_mostly_kvs) {
+    prepare_environment();
+
+    auto result = open_read_mostly_kvs();
+    ASSERT_TRUE(result);
+    ASSERT_NE(result.value().rcu_map, nullptr);
+    EXPECT_TRUE(result.value().key_exists("kvs").value());
+    EXPECT_EQ(result.value().get_all_keys().value().size(), 1U);
+
+    /* Changes are published to the readers */
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    EXPECT_EQ(std::get<double>(result.value().get_value("key1").value().getValue()), 1.0);
+    EXPECT_EQ(result.value().get_all_keys().value().size(), 2U);
+    ASSERT_TRUE(result.value().remove_key("key1"));
+    EXPECT_FALSE(result.value().key_exists("key1").value());
+    ASSERT_TRUE(result.value().set_value("default", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().reset_key("default"));
+    EXPECT_EQ(std::get<int32_t>(result.value().get_value("default").value().getValue()), 5); /* Default value */
+
+    /* Flush and restore */
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().reset());
+    EXPECT_TRUE(result.value().get_all_keys().value().empty());
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_TRUE(result.value().snapshot_restore(1));
+    EXPECT_TRUE(result.value().key_exists("kvs").value());
+
+    /* Readers don't need the lock */
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    EXPECT_TRUE(result.value().get_value("kvs"));
+    EXPECT_TRUE(result.value().key_exists("kvs"));
+    EXPECT_TRUE(result.value().get_all_keys());
+    lock.unlock();
+
+    cleanup_environment();
+}
@@ -0,0 +1,420 @@
+/********************************************************************************
+* Copyright (c) 2025 Contributors to the Eclipse Foundation
+*
+* See the NOTICE file(s) distributed with this work for additional
+* information regarding copyright ownership.
+*
+* This program and the accompanying materials are made available under the
+* terms of the Apache License Version 2.0 which is available at
+* https://www.apache.org/licenses/LICENSE-2.0
+*
+* SPDX-License-Identifier: Apache-2.0
+********************************************************************************/
+
+#include "test_kvs_general.hpp"
+
+const std::string wal_file = kvs_prefix + ".wal";
+
+/* Helper to open the test KVS with enabled write-ahead log */
+static score::Result<Kvs> open_wal_kvs(size_t threshold = KVS_WAL_COMPACTION_THRESHOLD) {
+    KvsOptions options;
+    options.wal_enabled = true;
+    options.wal_compaction_threshold = threshold;
+    return Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir), options);
+}
+
+TEST(kvs_wal, encode_decode_records) {
+
+    std::string data = encode_wal_record(WalOperation::SetValue, "key1", R"({"key1":{"t":"i32","v":1}})");
+    data += encode_wal_record(WalOperation::RemoveKey, "key2", "");
+    data += encode_wal_record(WalOperation::Reset, "", "");
+
+    size_t valid_size = 0;
+    auto records = decode_wal_records(data, valid_size);
+    ASSERT_EQ(records.size(), 3U);
+    EXPECT_EQ(valid_size, data.size());
+    EXPECT_EQ(records[0].operation, WalOperation::SetValue);
+    EXPECT_EQ(records[0].key, "key1");
+    EXPECT_EQ(records[0].value, R"({"key1":{"t":"i32","v":1}})");
+    EXPECT_EQ(records[1].operation, WalOperation::RemoveKey);
+    EXPECT_EQ(records[1].key, "key2");
+    EXPECT_TRUE(records[1].value.empty());
+    EXPECT_EQ(records[2].operation, WalOperation::Reset);
+
+    /* Empty log */
+    records = decode_wal_records("", valid_size);
+    EXPECT_TRUE(records.empty());
+    EXPECT_EQ(valid_size, 0U);
+}
+
+TEST(kvs_wal, decode_torn_and_corrupt_records) {
+
+    const std::string first = encode_wal_record(WalOperation::SetValue, "key1", "value");
+    const std::string second = encode_wal_record(WalOperation::RemoveKey, "key1", "");
+
+    /* Torn write: second record incomplete */
+    size_t valid_size = 0;
+    auto records = decode_wal_records(first + second.substr(0, second.size() - 1), valid_size);
+    ASSERT_EQ(records.size(), 1U);
+    EXPECT_EQ(valid_size, first.size());
+
+    /* Corrupted payload: checksum mismatch */
+    std::string corrupt = second;
+    corrupt[6] ^= 0x01;
+    records = decode_wal_records(first + corrupt + first, valid_size);
+    ASSERT_EQ(records.size(), 1U);
+    EXPECT_EQ(valid_size, first.size());
+
+    /* Invalid operation */
+    std::string invalid_op = encode_wal_record(static_cast<WalOperation>(0x7F), "", "");
+    records = decode_wal_records(invalid_op, valid_size);
+    EXPECT_TRUE(records.empty());
+    EXPECT_EQ(valid_size, 0U);
+}
+
+TEST(kvs_wal, wal_disabled_by_default) {
+
+    prepare_environment();
+
+    auto result = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result.value().options.wal_enabled);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    EXPECT_FALSE(std::filesystem::exists(wal_file));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_without_flush) {
+
+    prepare_environment();
+
+    {
+        auto result = open_wal_kvs();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("key1", KvsValue(std::string("value1"))));
+        ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+        ASSERT_TRUE(result.value().set_value("key2", KvsValue(3.0)));
+        ASSERT_TRUE(result.value().remove_key("kvs"));
+        EXPECT_TRUE(std::filesystem::exists(wal_file));
+        EXPECT_EQ(result.value().wal_size, std::filesystem::file_size(wal_file));
+        /* No flush */
+    }
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    auto value1 = result.value().get_value("key1");
+    ASSERT_TRUE(value1);
+    EXPECT_EQ(std::get<std::string>(value1.value().getValue()), "value1");
+    auto value2 = result.value().get_value("key2");
+    ASSERT_TRUE(value2);
+    EXPECT_EQ(std::get<double>(value2.value().getValue()), 3.0);
+    EXPECT_FALSE(result.value().kvs.count("kvs"));
+
+    /* Records are also replayed if the WAL is disabled now */
+    auto result_disabled = Kvs::open(instance_id, OpenNeedDefaults::Optional, OpenNeedKvs::Optional, std::string(data_dir));
+    ASSERT_TRUE(result_disabled);
+    EXPECT_TRUE(result_disabled.value().kvs.count("key1"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_reset_and_reset_key) {
+
+    prepare_environment();
+
+    {
+        auto result = open_wal_kvs();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().reset());
+        ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+        ASSERT_TRUE(result.value().set_value("default", KvsValue(3.0)));
+        ASSERT_TRUE(result.value().reset_key("default"));
+        /* Key without value: no record */
+        size_t wal_size = result.value().wal_size;
+        ASSERT_TRUE(result.value().reset_key("default"));
+        EXPECT_EQ(result.value().wal_size, wal_size);
+    }
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().kvs.size(), 1U);
+    EXPECT_TRUE(result.value().kvs.count("key2"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_snapshot_restore) {
+
+    prepare_environment();
+
+    {
+        auto result = open_wal_kvs();
+        ASSERT_TRUE(result);
+        ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+        ASSERT_TRUE(result.value().flush()); /* kvs_0 -> kvs_1, key1 is stored in kvs_0 */
+        ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+        ASSERT_TRUE(result.value().snapshot_restore(1)); /* Restores the initial test data */
+    }
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().kvs.size(), 1U);
+    EXPECT_TRUE(result.value().kvs.count("kvs"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_torn_tail) {
+
+    prepare_environment();
+
+    const std::string record = encode_wal_record(WalOperation::SetValue, "key1", R"({"key1":{"t":"f64","v":1.0}})");
+    const std::string torn = encode_wal_record(WalOperation::RemoveKey, "key1", "");
+    std::ofstream out(wal_file, std::ios::binary);
+    out << record << torn.substr(0, torn.size() - 2);
+    out.close();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result.value().kvs.count("key1"));
+    EXPECT_EQ(std::filesystem::file_size(wal_file), record.size());
+    EXPECT_EQ(result.value().wal_size, record.size());
+
+    /* New records are appended after the last valid record */
+    ASSERT_TRUE(result.value().remove_key("key1"));
+    auto result_reopen = open_wal_kvs();
+    ASSERT_TRUE(result_reopen);
+    EXPECT_FALSE(result_reopen.value().kvs.count("key1"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_batch) {
+
+    prepare_environment();
+
+    {
+        auto result = open_wal_kvs();
+        ASSERT_TRUE(result);
+        KvsWriteBatch batch;
+        batch.set_value("key1", KvsValue(1.0)).set_value("key2", KvsValue(2.0)).remove_key("kvs");
+        ASSERT_TRUE(result.value().commit(batch));
+        /* One record for the batch */
+        size_t valid_size = 0;
+        std::ifstream in(wal_file, std::ios::binary);
+        const std::string wal_data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto records = decode_wal_records(wal_data, valid_size);
+        ASSERT_EQ(records.size(), 1U);
+        EXPECT_EQ(records[0].operation, WalOperation::Batch);
+        EXPECT_EQ(decode_wal_records(records[0].value, valid_size).size(), 2U); /* Remove and all sets */
+    }
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value().kvs.size(), 2U);
+    EXPECT_TRUE(result.value().get_value("key1").value() == KvsValue(1.0));
+    EXPECT_TRUE(result.value().get_value("key2").value() == KvsValue(2.0));
+    EXPECT_FALSE(result.value().kvs.count("kvs"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_torn_batch) {
+
+    prepare_environment();
+
+    /* A torn batch record drops all changes of the batch */
+    std::string changes = encode_wal_record(WalOperation::SetValue, "key1", R"({"key1":{"t":"f64","v":1.0}})");
+    changes += encode_wal_record(WalOperation::RemoveKey, "kvs", "");
+    const std::string batch = encode_wal_record(WalOperation::Batch, "", changes);
+    std::ofstream out(wal_file, std::ios::binary);
+    out << batch.substr(0, batch.size() - 1);
+    out.close();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result.value().kvs.count("key1"));
+    EXPECT_TRUE(result.value().kvs.count("kvs"));
+    EXPECT_EQ(std::filesystem::file_size(wal_file), 0U);
+
+    /* Batch holding an invalid change */
+    out.open(wal_file, std::ios::binary | std::ios::trunc);
+    out << encode_wal_record(WalOperation::Batch, "", changes + encode_wal_record(WalOperation::Reset, "", ""));
+    out.close();
+    result = open_wal_kvs();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::ValidationFailed);
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_replay_invalid_record_data) {
+
+    prepare_environment();
+
+    std::ofstream out(wal_file, std::ios::binary);
+    out << encode_wal_record(WalOperation::SetValue, "key1", "no json");
+    out.close();
+
+    auto result = open_wal_kvs();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(static_cast<ErrorCode>(*result.error()), ErrorCode::JsonParserError);
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_flush_truncates_log) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    EXPECT_GT(std::filesystem::file_size(wal_file), 0U);
+
+    ASSERT_TRUE(result.value().flush());
+    EXPECT_EQ(std::filesystem::file_size(wal_file), 0U);
+    EXPECT_EQ(result.value().wal_size, 0U);
+
+    /* Log is written again after truncation */
+    ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+    EXPECT_EQ(std::filesystem::file_size(wal_file), result.value().wal_size);
+
+    auto result_reopen = open_wal_kvs();
+    ASSERT_TRUE(result_reopen);
+    EXPECT_TRUE(result_reopen.value().kvs.count("key1"));
+    EXPECT_TRUE(result_reopen.value().kvs.count("key2"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_truncate_keeps_newer_records) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    size_t flushed_size = result.value().wal_size;
+    ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+    size_t total_size = result.value().wal_size;
+
+    /* Simulate a record written while the flush was in progress */
+    ASSERT_TRUE(result.value().wal_truncate(flushed_size));
+    EXPECT_EQ(result.value().wal_size, total_size - flushed_size);
+    EXPECT_EQ(std::filesystem::file_size(wal_file), total_size - flushed_size);
+    EXPECT_FALSE(std::filesystem::exists(wal_file + ".tmp")); /* Staged log replaced the WAL */
+
+    /* Truncation doesn't use the KVS lock, it isn't skipped while a reader or writer holds it */
+    result.value().options.lock_policy = KvsLockPolicy::Try;
+    std::unique_lock<std::shared_timed_mutex> lock(result.value().kvs_mutex);
+    ASSERT_TRUE(result.value().wal_truncate(result.value().wal_size));
+    EXPECT_EQ(result.value().wal_size, 0U);
+    EXPECT_EQ(std::filesystem::file_size(wal_file), 0U);
+    lock.unlock();
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_compaction) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs(1U); /* Compact on every write */
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    EXPECT_TRUE(result.value().worker_thread.joinable()); /* Compaction is flushed by the worker, not the writer */
+    for (int i = 0; (i < 500) && (0U != result.value().wal_size); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(result.value().wal_size, 0U);
+    EXPECT_EQ(std::filesystem::file_size(wal_file), 0U);
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g1.json")); /* Compaction flushed a new generation */
+
+    auto result_reopen = open_wal_kvs();
+    ASSERT_TRUE(result_reopen);
+    EXPECT_TRUE(result_reopen.value().kvs.count("key1"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_compaction_all_records) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    ASSERT_TRUE(result.value().set_value("key1", KvsValue(1.0)));
+    ASSERT_TRUE(result.value().flush());
+    ASSERT_EQ(result.value().wal_size, 0U);
+
+    /* A remove record crosses the threshold, not only set records trigger compaction */
+    result.value().options.wal_compaction_threshold = 1U;
+    ASSERT_TRUE(result.value().remove_key("key1"));
+    EXPECT_TRUE(result.value().worker_thread.joinable());
+    for (int i = 0; (i < 500) && (0U != result.value().wal_size); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(result.value().wal_size, 0U);
+    EXPECT_TRUE(std::filesystem::exists(filename_prefix + "_g2.json"));
+
+    /* Reset record */
+    ASSERT_TRUE(result.value().set_value("key2", KvsValue(2.0)));
+    for (int i = 0; (i < 500) && (0U != result.value().wal_size); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(result.value().reset());
+    for (int i = 0; (i < 500) && (0U != result.value().wal_size); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(result.value().wal_size, 0U);
+
+    auto result_reopen = open_wal_kvs();
+    ASSERT_TRUE(result_reopen);
+    EXPECT_FALSE(result_reopen.value().kvs.count("key1"));
+    EXPECT_FALSE(result_reopen.value().kvs.count("key2"));
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_write_failure) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+
+    /* WAL path is a directory and can't be opened */
+    std::filesystem::create_directory(wal_file);
+    auto set_result = result.value().set_value("key1", KvsValue(1.0));
+    ASSERT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::PhysicalStorageFailure);
+    EXPECT_FALSE(result.value().kvs.count("key1")); /* Data is only changed, if the record was written */
+
+    auto remove_result = result.value().remove_key("kvs");
+    ASSERT_FALSE(remove_result);
+    EXPECT_TRUE(result.value().kvs.count("kvs"));
+
+    auto reset_result = result.value().reset();
+    ASSERT_FALSE(reset_result);
+    EXPECT_FALSE(result.value().kvs.empty());
+
+    cleanup_environment();
+}
+
+TEST(kvs_wal, wal_set_value_invalid_value) {
+
+    prepare_environment();
+
+    auto result = open_wal_kvs();
+    ASSERT_TRUE(result);
+    BrokenKvsValue invalid;
+    auto set_result = result.value().set_value("key1", invalid);
+    ASSERT_FALSE(set_result);
+    EXPECT_EQ(static_cast<ErrorCode>(*set_result.error()), ErrorCode::InvalidValueType);
+    EXPECT_FALSE(std::filesystem::exists(wal_file));
+
+    cleanup_environment();
+}
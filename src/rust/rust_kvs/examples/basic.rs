@@ -87,6 +87,7 @@ fn main() -> Result<(), ErrorCode> {
                     KvsValue::Null => "Null",
                     KvsValue::Array(_) => "Array",
                     KvsValue::Object(_) => "Object",
+                    KvsValue::Bytes(_) => "Bytes",
                 };
                 println!("{key:?} = {value:?} ({value_type:?})");
             }
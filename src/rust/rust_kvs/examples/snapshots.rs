@@ -23,7 +23,7 @@ fn main() -> Result<(), ErrorCode> {
         let max_count = kvs.snapshot_max_count() as u32;
         println!("Max snapshot count: {max_count:?}");
 
-        // Snapshots are created and rotated on flush.
+        // Each flush creates a snapshot, the oldest one above the maximum count is removed.
         let counter_key = "counter";
         for index in 0..max_count {
             kvs.set_value(counter_key, index)?;
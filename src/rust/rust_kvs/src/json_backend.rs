@@ -11,7 +11,7 @@
 
 use crate::error_code::ErrorCode;
 use crate::kvs_api::{InstanceId, SnapshotId};
-use crate::kvs_backend::{KvsBackend, KvsPathResolver};
+use crate::kvs_backend::{KvsBackend, KvsFileId, KvsPathResolver};
 use crate::kvs_value::{KvsMap, KvsValue};
 use std::collections::HashMap;
 use std::fs;
@@ -26,8 +26,84 @@ use tinyjson::{JsonGenerateError, JsonParseError, JsonValue};
 //   "my_string": { "t": "str", "v": "hello" },
 //   "my_array": { "t": "arr", "v": [ ... ] },
 //   "my_object": { "t": "obj", "v": { ... } },
-//   "my_null": { "t": "null", "v": null }
+//   "my_null": { "t": "null", "v": null },
+//   "my_bytes": { "t": "bin", "v": "AAH/" },
+//   "my_table": { "t": "arr_f64", "v": [ 1.5, 2.0 ] }
 // }
+//
+// Packed number arrays ("arr_i32", "arr_u32", "arr_i64", "arr_u64", "arr_f64") written by the
+// C++ KVS are read as `KvsValue::Array` of the element type. A flush writes them back as generic
+// "arr" with typed elements, the C++ KVS then reads a `KvsValue::Array` instead of a packed array.
+
+const BASE64_ALPHABET: &[u8; 64] =
+    b"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// Encode bytes as standard base64 with padding.
+fn encode_base64(data: &[u8]) -> String {
+    let mut out = String::with_capacity(data.len().div_ceil(3) * 4);
+    for chunk in data.chunks(3) {
+        let triple = (u32::from(chunk[0]) << 16)
+            | (u32::from(*chunk.get(1).unwrap_or(&0)) << 8)
+            | u32::from(*chunk.get(2).unwrap_or(&0));
+        for (idx, shift) in [18u32, 12, 6, 0].into_iter().enumerate() {
+            if idx <= chunk.len() {
+                out.push(BASE64_ALPHABET[((triple >> shift) & 0x3F) as usize] as char);
+            } else {
+                out.push('=');
+            }
+        }
+    }
+    out
+}
+
+/// Decode standard base64 with padding, `None` on invalid input.
+fn decode_base64(text: &str) -> Option<Vec<u8>> {
+    let input = text.as_bytes();
+    if input.len() % 4 != 0 {
+        return None;
+    }
+    let mut out = Vec::with_capacity(input.len() / 4 * 3);
+    let quads = input.len() / 4;
+    for (quad_idx, quad) in input.chunks(4).enumerate() {
+        let last = quad_idx + 1 == quads;
+        let padding = quad.iter().rev().take_while(|&&c| c == b'=').count();
+        if padding > 2 || (padding > 0 && !last) {
+            return None;
+        }
+        let mut triple = 0u32;
+        for &c in &quad[..4 - padding] {
+            let sextet = BASE64_ALPHABET.iter().position(|&a| a == c)? as u32;
+            triple = (triple << 6) | sextet;
+        }
+        triple <<= 6 * padding as u32;
+        let bytes = triple.to_be_bytes();
+        out.extend_from_slice(&bytes[1..4 - padding]);
+    }
+    Some(out)
+}
+
+/// Packed number array as `KvsValue::Array`, `KvsValue::Null` if an element is not a number or
+/// not valid for the element type.
+fn from_packed(values: Vec<JsonValue>, element: fn(f64) -> Option<KvsValue>) -> KvsValue {
+    let mut array = Vec::with_capacity(values.len());
+    for value in values {
+        match value {
+            JsonValue::Number(n) => match element(n) {
+                Some(element) => array.push(element),
+                None => return KvsValue::Null,
+            },
+            _ => return KvsValue::Null,
+        }
+    }
+    KvsValue::Array(array)
+}
+
+/// Integral number in `min..max`, `None` if it has a fraction or is out of range.
+///
+/// JSON numbers are `f64`: 64-bit integers are only exact up to 2^53.
+fn integral(n: f64, min: f64, max: f64) -> Option<f64> {
+    (n.fract() == 0.0 && n >= min && n < max).then_some(n)
+}
 
 /// Backend-specific JsonValue -> KvsValue conversion.
 impl From<JsonValue> for KvsValue {
@@ -53,6 +129,27 @@ impl From<JsonValue> for KvsValue {
                         ("obj", JsonValue::Object(v)) => KvsValue::Object(
                             v.into_iter().map(|(k, v)| (k, KvsValue::from(v))).collect(),
                         ),
+                        ("bin", JsonValue::String(v)) => match decode_base64(&v) {
+                            Some(bytes) => KvsValue::Bytes(bytes),
+                            None => KvsValue::Null,
+                        },
+                        ("arr_i32", JsonValue::Array(v)) => from_packed(v, |n| {
+                            integral(n, -2f64.powi(31), 2f64.powi(31))
+                                .map(|n| KvsValue::I32(n as i32))
+                        }),
+                        ("arr_u32", JsonValue::Array(v)) => from_packed(v, |n| {
+                            integral(n, 0.0, 2f64.powi(32)).map(|n| KvsValue::U32(n as u32))
+                        }),
+                        ("arr_i64", JsonValue::Array(v)) => from_packed(v, |n| {
+                            integral(n, -2f64.powi(63), 2f64.powi(63))
+                                .map(|n| KvsValue::I64(n as i64))
+                        }),
+                        ("arr_u64", JsonValue::Array(v)) => from_packed(v, |n| {
+                            integral(n, 0.0, 2f64.powi(64)).map(|n| KvsValue::U64(n as u64))
+                        }),
+                        ("arr_f64", JsonValue::Array(v)) => {
+                            from_packed(v, |n| Some(KvsValue::F64(n)))
+                        }
                         // Remaining types can be handled with Null.
                         _ => KvsValue::Null,
                     };
@@ -125,6 +222,10 @@ impl From<KvsValue> for JsonValue {
                     ),
                 );
             }
+            KvsValue::Bytes(bytes) => {
+                obj.insert("t".to_string(), JsonValue::String("bin".to_string()));
+                obj.insert("v".to_string(), JsonValue::String(encode_base64(&bytes)));
+            }
         }
         JsonValue::Object(obj)
     }
@@ -228,8 +329,13 @@ impl KvsBackend for JsonBackend {
         }
 
         // Cast from `KvsValue` to `JsonValue`.
-        let kvs_value = KvsValue::Object(kvs_map.clone());
-        let json_value = JsonValue::from(kvs_value);
+        // The top level is the plain object of the keys, like in the files of the C++ KVS.
+        let json_value = JsonValue::Object(
+            kvs_map
+                .iter()
+                .map(|(k, v)| (k.clone(), JsonValue::from(v.clone())))
+                .collect(),
+        );
 
         // Stringify `JsonValue` and save to KVS file.
         let json_str = Self::stringify(&json_value)?;
@@ -271,6 +377,51 @@ impl KvsPathResolver for JsonBackend {
         working_dir.join(Self::hash_file_name(instance_id, snapshot_id))
     }
 
+    fn kvs_generation_file_name(instance_id: InstanceId, generation: u64) -> String {
+        format!("kvs_{instance_id}_g{generation}.json")
+    }
+
+    fn kvs_generation_file_path(
+        working_dir: &Path,
+        instance_id: InstanceId,
+        generation: u64,
+    ) -> PathBuf {
+        working_dir.join(Self::kvs_generation_file_name(instance_id, generation))
+    }
+
+    fn hash_generation_file_name(instance_id: InstanceId, generation: u64) -> String {
+        format!("kvs_{instance_id}_g{generation}.hash")
+    }
+
+    fn hash_generation_file_path(
+        working_dir: &Path,
+        instance_id: InstanceId,
+        generation: u64,
+    ) -> PathBuf {
+        working_dir.join(Self::hash_generation_file_name(instance_id, generation))
+    }
+
+    fn parse_kvs_file_name(instance_id: InstanceId, file_name: &str) -> Option<KvsFileId> {
+        let name = file_name
+            .strip_prefix(&format!("kvs_{instance_id}_"))?
+            .strip_suffix(".json")?;
+        let (number, generation_file) = match name.strip_prefix('g') {
+            Some(number) => (number, true),
+            None => (name, false),
+        };
+        if number.is_empty() || !number.bytes().all(|b| b.is_ascii_digit()) {
+            return None;
+        }
+        if generation_file {
+            number.parse().ok().map(KvsFileId::Generation)
+        } else {
+            number
+                .parse()
+                .ok()
+                .map(|id| KvsFileId::Snapshot(SnapshotId(id)))
+        }
+    }
+
     fn defaults_file_name(instance_id: InstanceId) -> String {
         format!("kvs_{instance_id}_default.json")
     }
@@ -518,6 +669,123 @@ mod json_value_to_kvs_value_conversion_tests {
         assert_eq!(kv, KvsValue::Null);
     }
 
+    #[test]
+    fn test_bytes_ok() {
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("bin".to_string())),
+            ("v".to_string(), JsonValue::String("AAH/Pw==".to_string())),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(kv, KvsValue::Bytes(vec![0x00, 0x01, 0xFF, 0x3F]));
+    }
+
+    #[test]
+    fn test_bytes_invalid_type() {
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("bin".to_string())),
+            ("v".to_string(), JsonValue::Number(1.0)),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(kv, KvsValue::Null);
+    }
+
+    #[test]
+    fn test_packed_array_ok() {
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("arr_f64".to_string())),
+            (
+                "v".to_string(),
+                JsonValue::Array(vec![JsonValue::Number(1.5), JsonValue::Number(-2.0)]),
+            ),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(
+            kv,
+            KvsValue::Array(vec![KvsValue::F64(1.5), KvsValue::F64(-2.0)])
+        );
+
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("arr_u32".to_string())),
+            (
+                "v".to_string(),
+                JsonValue::Array(vec![JsonValue::Number(7.0)]),
+            ),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(kv, KvsValue::Array(vec![KvsValue::U32(7)]));
+    }
+
+    #[test]
+    fn test_packed_array_invalid_element() {
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("arr_i32".to_string())),
+            (
+                "v".to_string(),
+                JsonValue::Array(vec![JsonValue::String("1".to_string())]),
+            ),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(kv, KvsValue::Null);
+    }
+
+    #[test]
+    fn test_packed_array_integer_out_of_range() {
+        let cases = [
+            ("arr_i32", 1.5),
+            ("arr_i32", 2147483648.0),
+            ("arr_i32", -2147483649.0),
+            ("arr_u32", -1.0),
+            ("arr_u32", 4294967296.0),
+            ("arr_i64", 0.5),
+            ("arr_i64", 9223372036854775808.0),
+            ("arr_u64", -1.0),
+            ("arr_u64", 18446744073709551616.0),
+            ("arr_u64", f64::NAN),
+        ];
+        for (type_str, number) in cases {
+            let jv = JsonValue::from(HashMap::from([
+                ("t".to_string(), JsonValue::String(type_str.to_string())),
+                (
+                    "v".to_string(),
+                    JsonValue::Array(vec![JsonValue::Number(1.0), JsonValue::Number(number)]),
+                ),
+            ]));
+            let kv = KvsValue::from(jv);
+            assert_eq!(kv, KvsValue::Null, "{type_str} {number}");
+        }
+
+        let jv = JsonValue::from(HashMap::from([
+            ("t".to_string(), JsonValue::String("arr_i64".to_string())),
+            (
+                "v".to_string(),
+                JsonValue::Array(vec![
+                    JsonValue::Number(-9223372036854775808.0),
+                    JsonValue::Number(9007199254740992.0),
+                ]),
+            ),
+        ]));
+        let kv = KvsValue::from(jv);
+        assert_eq!(
+            kv,
+            KvsValue::Array(vec![
+                KvsValue::I64(i64::MIN),
+                KvsValue::I64(9007199254740992)
+            ])
+        );
+    }
+
+    #[test]
+    fn test_bytes_invalid_base64() {
+        for invalid in ["AAH", "AA=A", "A*==", "Zg==Zm8=", "Z==="] {
+            let jv = JsonValue::from(HashMap::from([
+                ("t".to_string(), JsonValue::String("bin".to_string())),
+                ("v".to_string(), JsonValue::String(invalid.to_string())),
+            ]));
+            let kv = KvsValue::from(jv);
+            assert_eq!(kv, KvsValue::Null, "{invalid}");
+        }
+    }
+
     #[test]
     fn test_non_json_value_object() {
         let jv = JsonValue::Number(123.0);
@@ -696,6 +964,27 @@ mod kvs_value_to_json_value_conversion_tests {
         ]));
         assert_eq!(jv, exp_jv);
     }
+
+    #[test]
+    fn test_bytes_ok() {
+        for (bytes, encoded) in [
+            (vec![], ""),
+            (vec![0x66], "Zg=="),
+            (vec![0x66, 0x6F], "Zm8="),
+            (vec![0x66, 0x6F, 0x6F], "Zm9v"),
+            (vec![0x00, 0x01, 0xFF, 0x3F], "AAH/Pw=="),
+        ] {
+            let jv = JsonValue::from(KvsValue::Bytes(bytes.clone()));
+            assert_eq!(
+                jv,
+                JsonValue::Object(HashMap::from([
+                    ("t".to_string(), JsonValue::String("bin".to_string())),
+                    ("v".to_string(), JsonValue::String(encoded.to_string()))
+                ]))
+            );
+            assert_eq!(KvsValue::from(jv), KvsValue::Bytes(bytes));
+        }
+    }
 }
 
 #[cfg(test)]
@@ -863,6 +1152,15 @@ mod backend_tests {
         JsonBackend::save_kvs(&kvs_map, &kvs_path, None).unwrap();
 
         assert!(kvs_path.exists());
+        let json_value: tinyjson::JsonValue =
+            std::fs::read_to_string(&kvs_path).unwrap().parse().unwrap();
+        match json_value {
+            tinyjson::JsonValue::Object(obj) => {
+                assert!(obj.contains_key("k1") && !obj.contains_key("t"))
+            }
+            _ => panic!("top level is not an object"),
+        }
+        assert_eq!(JsonBackend::load_kvs(&kvs_path, None).unwrap(), kvs_map);
     }
 
     #[test]
@@ -922,7 +1220,7 @@ mod backend_tests {
 mod path_resolver_tests {
     use crate::json_backend::JsonBackend;
     use crate::kvs_api::{InstanceId, SnapshotId};
-    use crate::kvs_backend::KvsPathResolver;
+    use crate::kvs_backend::{KvsFileId, KvsPathResolver};
     use tempfile::tempdir;
 
     #[test]
@@ -966,6 +1264,45 @@ mod path_resolver_tests {
         assert_eq!(exp_name, act_name);
     }
 
+    #[test]
+    fn test_kvs_generation_file_path() {
+        let dir = tempdir().unwrap();
+        let dir_path = dir.path();
+
+        let instance_id = InstanceId(123);
+        let exp_name = dir_path.join("kvs_123_g7.json");
+        let act_name = JsonBackend::kvs_generation_file_path(dir_path, instance_id, 7);
+        assert_eq!(exp_name, act_name);
+    }
+
+    #[test]
+    fn test_hash_generation_file_path() {
+        let dir = tempdir().unwrap();
+        let dir_path = dir.path();
+
+        let instance_id = InstanceId(123);
+        let exp_name = dir_path.join("kvs_123_g7.hash");
+        let act_name = JsonBackend::hash_generation_file_path(dir_path, instance_id, 7);
+        assert_eq!(exp_name, act_name);
+    }
+
+    #[test]
+    fn test_parse_kvs_file_name() {
+        let instance_id = InstanceId(123);
+        let parse = |name| JsonBackend::parse_kvs_file_name(instance_id, name);
+        assert_eq!(parse("kvs_123_g7.json"), Some(KvsFileId::Generation(7)));
+        assert_eq!(
+            parse("kvs_123_2.json"),
+            Some(KvsFileId::Snapshot(SnapshotId(2)))
+        );
+        assert_eq!(parse("kvs_123_g7.hash"), None);
+        assert_eq!(parse("kvs_123_default.json"), None);
+        assert_eq!(parse("kvs_123_g.json"), None);
+        assert_eq!(parse("kvs_123_+2.json"), None);
+        assert_eq!(parse("kvs_12_2.json"), None);
+        assert_eq!(parse("kvs_1234_2.json"), None);
+    }
+
     #[test]
     fn test_defaults_file_name() {
         let instance_id = InstanceId(123);
@@ -11,12 +11,14 @@
 
 use crate::error_code::ErrorCode;
 use crate::kvs_api::{InstanceId, KvsApi, KvsDefaults, KvsLoad, SnapshotId};
-use crate::kvs_backend::{KvsBackend, KvsPathResolver};
+use crate::kvs_backend::{KvsBackend, KvsFileId, KvsPathResolver};
 use crate::kvs_builder::KvsData;
 use crate::kvs_value::{KvsMap, KvsValue};
+use std::collections::BTreeSet;
 use std::fs;
+use std::io;
 use std::marker::PhantomData;
-use std::path::PathBuf;
+use std::path::{Path, PathBuf};
 use std::sync::{Arc, Mutex};
 
 /// KVS instance parameters.
@@ -67,63 +69,23 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> GenericKvs<Backend, Pat
         &self.parameters
     }
 
-    /// Rotate snapshots
+    /// Remove the snapshots exceeding the maximum count
     ///
-    /// # Features
-    ///   * `FEAT_REQ__KVS__snapshots`
+    /// # Parameters
+    ///   * `files`: Snapshot files before the flush, newest first
     ///
     /// # Return Values
-    ///   * Ok: Rotation successful, also if no rotation was needed
+    ///   * Ok: Snapshots removed, also if none exceeded the maximum count
     ///   * `ErrorCode::UnmappedError`: Unmapped error
-    fn snapshot_rotate(&self) -> Result<(), ErrorCode> {
-        for idx in (1..self.snapshot_max_count()).rev() {
-            let old_snapshot_id = SnapshotId(idx - 1);
-            let new_snapshot_id = SnapshotId(idx);
-
-            let hash_path_old = PathResolver::hash_file_path(
-                &self.parameters.working_dir,
-                self.parameters.instance_id,
-                old_snapshot_id,
-            );
-            let hash_path_new = PathResolver::hash_file_path(
-                &self.parameters.working_dir,
-                self.parameters.instance_id,
-                new_snapshot_id,
-            );
-            let snap_name_old =
-                PathResolver::kvs_file_name(self.parameters.instance_id, old_snapshot_id);
-            let snap_path_old = PathResolver::kvs_file_path(
-                &self.parameters.working_dir,
-                self.parameters.instance_id,
-                old_snapshot_id,
-            );
-            let snap_name_new =
-                PathResolver::kvs_file_name(self.parameters.instance_id, new_snapshot_id);
-            let snap_path_new = PathResolver::kvs_file_path(
-                &self.parameters.working_dir,
-                self.parameters.instance_id,
-                new_snapshot_id,
-            );
-
-            println!("rotating: {snap_name_old} -> {snap_name_new}");
-
-            // Check snapshot and hash files exist.
-            let snap_old_exists = snap_path_old.exists();
-            let hash_old_exists = hash_path_old.exists();
-
-            // If both exist - rename them.
-            if snap_old_exists && hash_old_exists {
-                fs::rename(hash_path_old, hash_path_new)?;
-                fs::rename(snap_path_old, snap_path_new)?;
-            }
-            // If neither exist - continue.
-            else if !snap_old_exists && !hash_old_exists {
-                continue;
-            }
-            // In other case - this is erroneous scenario.
-            // Either snapshot or hash file got removed.
-            else {
-                return Err(ErrorCode::IntegrityCorrupted);
+    fn snapshot_prune(&self, files: &[SnapshotFile]) -> Result<(), ErrorCode> {
+        // The flushed file is the current KVS, the previous files become snapshots 1, 2, ...
+        for file in files.iter().skip(self.snapshot_max_count() - 1) {
+            println!("removing snapshot: {}", file.kvs_path.display());
+            for path in [&file.kvs_path, &file.hash_path] {
+                match fs::remove_file(path) {
+                    Err(e) if e.kind() != io::ErrorKind::NotFound => return Err(e.into()),
+                    _ => {}
+                }
             }
         }
 
@@ -131,6 +93,86 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> GenericKvs<Backend, Pat
     }
 }
 
+/// KVS and hash file of a snapshot.
+pub(crate) struct SnapshotFile {
+    /// KVS file path.
+    pub(crate) kvs_path: PathBuf,
+
+    /// Hash file path.
+    pub(crate) hash_path: PathBuf,
+}
+
+/// Scan the working directory for the snapshot files
+///
+/// Each flush writes a new generation `kvs_<id>_g<N>.json`, the files are listed newest first (index
+/// = snapshot ID). Files of the former rotation layout `kvs_<id>_<n>.json` follow as older
+/// snapshots, so existing stores are read without renaming and migrate with the next flushes.
+///
+/// # Parameters
+///   * `working_dir`: Working directory
+///   * `instance_id`: Instance ID
+///
+/// # Return Values
+///   * Ok: Snapshot files and the newest generation (0 without generation files)
+///   * `ErrorCode::UnmappedError`: Directory could not be read
+pub(crate) fn snapshot_files<PathResolver: KvsPathResolver>(
+    working_dir: &Path,
+    instance_id: InstanceId,
+) -> Result<(Vec<SnapshotFile>, u64), ErrorCode> {
+    let dir = if working_dir.as_os_str().is_empty() {
+        Path::new(".")
+    } else {
+        working_dir
+    };
+    let mut generations = BTreeSet::new();
+    let mut snapshots = BTreeSet::new();
+    match fs::read_dir(dir) {
+        Ok(entries) => {
+            for entry in entries {
+                let name = entry?.file_name();
+                match name
+                    .to_str()
+                    .and_then(|name| PathResolver::parse_kvs_file_name(instance_id, name))
+                {
+                    Some(KvsFileId::Generation(generation)) => {
+                        generations.insert(generation);
+                    }
+                    Some(KvsFileId::Snapshot(snapshot_id)) => {
+                        snapshots.insert(snapshot_id.0);
+                    }
+                    None => {}
+                }
+            }
+        }
+        Err(e) if e.kind() == io::ErrorKind::NotFound => {}
+        Err(e) => return Err(e.into()),
+    }
+
+    let mut files: Vec<SnapshotFile> = generations
+        .iter()
+        .rev()
+        .map(|&generation| SnapshotFile {
+            kvs_path: PathResolver::kvs_generation_file_path(working_dir, instance_id, generation),
+            hash_path: PathResolver::hash_generation_file_path(
+                working_dir,
+                instance_id,
+                generation,
+            ),
+        })
+        .collect();
+    files.extend(
+        (0..)
+            .take_while(|idx| snapshots.contains(idx))
+            .map(|idx| SnapshotFile {
+                kvs_path: PathResolver::kvs_file_path(working_dir, instance_id, SnapshotId(idx)),
+                hash_path: PathResolver::hash_file_path(working_dir, instance_id, SnapshotId(idx)),
+            }),
+    );
+    let newest = generations.last().copied().unwrap_or(0);
+
+    Ok((files, newest))
+}
+
 impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
     for GenericKvs<Backend, PathResolver>
 {
@@ -364,20 +406,20 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
             return Ok(());
         }
 
-        self.snapshot_rotate().map_err(|e| {
-            eprintln!("error: snapshot_rotate failed: {e:?}");
-            e
-        })?;
-        let snapshot_id = SnapshotId(0);
-        let kvs_path = PathResolver::kvs_file_path(
+        // Write a new generation, the previous files stay untouched.
+        let (files, generation) = snapshot_files::<PathResolver>(
+            &self.parameters.working_dir,
+            self.parameters.instance_id,
+        )?;
+        let kvs_path = PathResolver::kvs_generation_file_path(
             &self.parameters.working_dir,
             self.parameters.instance_id,
-            snapshot_id,
+            generation + 1,
         );
-        let hash_path = PathResolver::hash_file_path(
+        let hash_path = PathResolver::hash_generation_file_path(
             &self.parameters.working_dir,
             self.parameters.instance_id,
-            snapshot_id,
+            generation + 1,
         );
 
         let data = self.data.lock()?;
@@ -385,6 +427,10 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
             eprintln!("error: save_kvs failed: {e:?}");
             e
         })?;
+        self.snapshot_prune(&files).map_err(|e| {
+            eprintln!("error: snapshot_prune failed: {e:?}");
+            e
+        })?;
         Ok(())
     }
 
@@ -393,23 +439,8 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
     /// # Return Values
     ///   * usize: Count of found snapshots
     fn snapshot_count(&self) -> usize {
-        let mut count = 0;
-
-        for idx in 0..self.snapshot_max_count() {
-            let snapshot_id = SnapshotId(idx);
-            let snapshot_path = PathResolver::kvs_file_path(
-                &self.parameters.working_dir,
-                self.parameters.instance_id,
-                snapshot_id,
-            );
-            if !snapshot_path.exists() {
-                break;
-            }
-
-            count += 1;
-        }
-
-        count
+        snapshot_files::<PathResolver>(&self.parameters.working_dir, self.parameters.instance_id)
+            .map_or(0, |(files, _)| files.len().min(self.snapshot_max_count()))
     }
 
     /// Return maximum number of snapshots to store.
@@ -446,22 +477,19 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
             return Err(ErrorCode::InvalidSnapshotId);
         }
 
-        if self.snapshot_count() < snapshot_id.0 {
+        let (files, _) = snapshot_files::<PathResolver>(
+            &self.parameters.working_dir,
+            self.parameters.instance_id,
+        )?;
+        let Some(file) = files
+            .get(snapshot_id.0)
+            .filter(|_| snapshot_id.0 < self.snapshot_max_count())
+        else {
             eprintln!("error: tried to restore a non-existing snapshot");
             return Err(ErrorCode::InvalidSnapshotId);
-        }
+        };
 
-        let kvs_path = PathResolver::kvs_file_path(
-            &self.parameters.working_dir,
-            self.parameters.instance_id,
-            snapshot_id,
-        );
-        let hash_path = PathResolver::hash_file_path(
-            &self.parameters.working_dir,
-            self.parameters.instance_id,
-            snapshot_id,
-        );
-        data.kvs_map = Backend::load_kvs(&kvs_path, Some(&hash_path))?;
+        data.kvs_map = Backend::load_kvs(&file.kvs_path, Some(&file.hash_path))?;
 
         Ok(())
     }
@@ -475,15 +503,13 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
     ///   * `Ok`: Filename for ID
     ///   * `ErrorCode::FileNotFound`: KVS file for snapshot ID not found
     fn get_kvs_filename(&self, snapshot_id: SnapshotId) -> Result<PathBuf, ErrorCode> {
-        let path = PathResolver::kvs_file_path(
+        let (files, _) = snapshot_files::<PathResolver>(
             &self.parameters.working_dir,
             self.parameters.instance_id,
-            snapshot_id,
-        );
-        if !path.exists() {
-            Err(ErrorCode::FileNotFound)
-        } else {
-            Ok(path)
+        )?;
+        match files.into_iter().nth(snapshot_id.0) {
+            Some(file) if file.kvs_path.exists() => Ok(file.kvs_path),
+            _ => Err(ErrorCode::FileNotFound),
         }
     }
 
@@ -496,15 +522,13 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> KvsApi
     ///   * `Ok`: Hash filename for ID
     ///   * `ErrorCode::FileNotFound`: Hash file for snapshot ID not found
     fn get_hash_filename(&self, snapshot_id: SnapshotId) -> Result<PathBuf, ErrorCode> {
-        let path = PathResolver::hash_file_path(
+        let (files, _) = snapshot_files::<PathResolver>(
             &self.parameters.working_dir,
             self.parameters.instance_id,
-            snapshot_id,
-        );
-        if !path.exists() {
-            Err(ErrorCode::FileNotFound)
-        } else {
-            Ok(path)
+        )?;
+        match files.into_iter().nth(snapshot_id.0) {
+            Some(file) if file.hash_path.exists() => Ok(file.hash_path),
+            _ => Err(ErrorCode::FileNotFound),
         }
     }
 }
@@ -515,7 +539,7 @@ mod kvs_tests {
     use crate::json_backend::JsonBackend;
     use crate::kvs::{GenericKvs, KvsParameters};
     use crate::kvs_api::{InstanceId, KvsApi, KvsDefaults, KvsLoad, SnapshotId};
-    use crate::kvs_backend::{KvsBackend, KvsPathResolver};
+    use crate::kvs_backend::{KvsBackend, KvsFileId, KvsPathResolver};
     use crate::kvs_builder::KvsData;
     use crate::kvs_value::{KvsMap, KvsValue};
     use std::path::PathBuf;
@@ -568,6 +592,34 @@ mod kvs_tests {
             unimplemented!()
         }
 
+        fn kvs_generation_file_name(_instance_id: InstanceId, _generation: u64) -> String {
+            unimplemented!()
+        }
+
+        fn kvs_generation_file_path(
+            _working_dir: &std::path::Path,
+            _instance_id: InstanceId,
+            _generation: u64,
+        ) -> PathBuf {
+            unimplemented!()
+        }
+
+        fn hash_generation_file_name(_instance_id: InstanceId, _generation: u64) -> String {
+            unimplemented!()
+        }
+
+        fn hash_generation_file_path(
+            _working_dir: &std::path::Path,
+            _instance_id: InstanceId,
+            _generation: u64,
+        ) -> PathBuf {
+            unimplemented!()
+        }
+
+        fn parse_kvs_file_name(_instance_id: InstanceId, _file_name: &str) -> Option<KvsFileId> {
+            unimplemented!()
+        }
+
         fn defaults_file_name(_instance_id: InstanceId) -> String {
             unimplemented!()
         }
@@ -1127,6 +1179,42 @@ mod kvs_tests {
             .is_err_and(|e| e == ErrorCode::InvalidSnapshotId));
     }
 
+    #[test]
+    fn test_snapshot_legacy_files() {
+        let dir = tempdir().unwrap();
+        let dir_path = dir.path().to_path_buf();
+        let instance_id = InstanceId(1);
+        for i in 0..2 {
+            let kvs_map = KvsMap::from([("counter".to_string(), KvsValue::I32(10 + i as i32))]);
+            JsonBackend::save_kvs(
+                &kvs_map,
+                &JsonBackend::kvs_file_path(&dir_path, instance_id, SnapshotId(i)),
+                Some(&JsonBackend::hash_file_path(
+                    &dir_path,
+                    instance_id,
+                    SnapshotId(i),
+                )),
+            )
+            .unwrap();
+        }
+        let kvs = get_kvs::<JsonBackend>(dir_path.clone(), KvsMap::new(), KvsMap::new());
+
+        // Former layout files follow the generation files.
+        kvs.set_value("counter", KvsValue::I32(1)).unwrap();
+        kvs.flush().unwrap();
+        assert_eq!(kvs.snapshot_count(), 3);
+        kvs.snapshot_restore(SnapshotId(1)).unwrap();
+        assert_eq!(kvs.get_value_as::<i32>("counter").unwrap(), 10);
+
+        // The oldest file is removed, no file is renamed.
+        kvs.flush().unwrap();
+        assert_eq!(kvs.snapshot_count(), 3);
+        assert!(JsonBackend::kvs_file_path(&dir_path, instance_id, SnapshotId(0)).exists());
+        assert!(!JsonBackend::kvs_file_path(&dir_path, instance_id, SnapshotId(1)).exists());
+        assert!(!JsonBackend::hash_file_path(&dir_path, instance_id, SnapshotId(1)).exists());
+        assert!(JsonBackend::kvs_generation_file_path(&dir_path, instance_id, 2).exists());
+    }
+
     #[test]
     fn test_get_kvs_filename_found() {
         let dir = tempdir().unwrap();
@@ -1137,7 +1225,7 @@ mod kvs_tests {
         kvs.flush().unwrap();
         let kvs_path = kvs.get_kvs_filename(SnapshotId(1)).unwrap();
         let kvs_name = kvs_path.file_name().unwrap().to_str().unwrap();
-        assert_eq!(kvs_name, "kvs_1_1.json");
+        assert_eq!(kvs_name, "kvs_1_g1.json");
     }
 
     #[test]
@@ -1161,7 +1249,7 @@ mod kvs_tests {
         kvs.flush().unwrap();
         let hash_path = kvs.get_hash_filename(SnapshotId(1)).unwrap();
         let hash_name = hash_path.file_name().unwrap().to_str().unwrap();
-        assert_eq!(hash_name, "kvs_1_1.hash");
+        assert_eq!(hash_name, "kvs_1_g1.hash");
     }
 
     #[test]
@@ -27,9 +27,19 @@ pub trait KvsBackend {
     ) -> Result<(), ErrorCode>;
 }
 
+/// KVS file found in the working directory.
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub enum KvsFileId {
+    /// File written by a flush, named by its generation number.
+    Generation(u64),
+
+    /// File of the former rotation layout, named by its snapshot ID.
+    Snapshot(SnapshotId),
+}
+
 /// KVS path resolver interface.
 pub trait KvsPathResolver {
-    /// Get KVS file name.
+    /// Get KVS file name in the former rotation layout.
     fn kvs_file_name(instance_id: InstanceId, snapshot_id: SnapshotId) -> String;
 
     /// Get KVS file path in working directory.
@@ -39,7 +49,7 @@ pub trait KvsPathResolver {
         snapshot_id: SnapshotId,
     ) -> PathBuf;
 
-    /// Get hash file name.
+    /// Get hash file name in the former rotation layout.
     fn hash_file_name(instance_id: InstanceId, snapshot_id: SnapshotId) -> String;
 
     /// Get hash file path in working directory.
@@ -49,6 +59,29 @@ pub trait KvsPathResolver {
         snapshot_id: SnapshotId,
     ) -> PathBuf;
 
+    /// Get KVS file name of a flush generation.
+    fn kvs_generation_file_name(instance_id: InstanceId, generation: u64) -> String;
+
+    /// Get KVS file path of a flush generation in working directory.
+    fn kvs_generation_file_path(
+        working_dir: &Path,
+        instance_id: InstanceId,
+        generation: u64,
+    ) -> PathBuf;
+
+    /// Get hash file name of a flush generation.
+    fn hash_generation_file_name(instance_id: InstanceId, generation: u64) -> String;
+
+    /// Get hash file path of a flush generation in working directory.
+    fn hash_generation_file_path(
+        working_dir: &Path,
+        instance_id: InstanceId,
+        generation: u64,
+    ) -> PathBuf;
+
+    /// Parse a KVS file name of the instance, `None` for other files.
+    fn parse_kvs_file_name(instance_id: InstanceId, file_name: &str) -> Option<KvsFileId>;
+
     /// Get defaults file name.
     fn defaults_file_name(instance_id: InstanceId) -> String;
 
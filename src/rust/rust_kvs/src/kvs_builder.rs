@@ -10,7 +10,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 use crate::error_code::ErrorCode;
-use crate::kvs::{GenericKvs, KvsParameters};
+use crate::kvs::{snapshot_files, GenericKvs, KvsParameters};
 use crate::kvs_api::{InstanceId, KvsDefaults, KvsLoad, SnapshotId};
 use crate::kvs_backend::{KvsBackend, KvsPathResolver};
 use crate::kvs_value::KvsMap;
@@ -215,20 +215,31 @@ impl<Backend: KvsBackend, PathResolver: KvsPathResolver> GenericKvsBuilder<Backe
             KvsDefaults::Required => Backend::load_kvs(&defaults_path, None)?,
         };
 
-        // Load KVS and hash files.
-        let snapshot_id = SnapshotId(0);
-        let kvs_path = PathResolver::kvs_file_path(&working_dir, instance_id, snapshot_id);
-        let hash_path = PathResolver::hash_file_path(&working_dir, instance_id, snapshot_id);
+        // Load KVS and hash files of the newest snapshot.
+        let newest_paths = || -> Result<(PathBuf, PathBuf), ErrorCode> {
+            let (files, _) = snapshot_files::<PathResolver>(&working_dir, instance_id)?;
+            Ok(match files.into_iter().next() {
+                Some(file) => (file.kvs_path, file.hash_path),
+                None => (
+                    PathResolver::kvs_file_path(&working_dir, instance_id, SnapshotId(0)),
+                    PathResolver::hash_file_path(&working_dir, instance_id, SnapshotId(0)),
+                ),
+            })
+        };
         let kvs_map = match self.parameters.kvs_load {
             KvsLoad::Ignored => KvsMap::new(),
             KvsLoad::Optional => {
+                let (kvs_path, hash_path) = newest_paths()?;
                 if kvs_path.exists() && hash_path.exists() {
                     Backend::load_kvs(&kvs_path, Some(&hash_path))?
                 } else {
                     KvsMap::new()
                 }
             }
-            KvsLoad::Required => Backend::load_kvs(&kvs_path, Some(&hash_path))?,
+            KvsLoad::Required => {
+                let (kvs_path, hash_path) = newest_paths()?;
+                Backend::load_kvs(&kvs_path, Some(&hash_path))?
+            }
         };
 
         // Shared object containing data.
@@ -796,4 +807,32 @@ mod kvs_builder_tests {
         let kvs_data = kvs_pool_entry.as_ref().unwrap();
         assert_eq!(kvs_data.data.lock().unwrap().kvs_map.len(), 3);
     }
+
+    #[test]
+    fn test_build_kvs_load_newest_generation() {
+        let _lock = lock_and_reset();
+
+        let dir = tempdir().unwrap();
+        let dir_string = dir.path().to_string_lossy().to_string();
+
+        let instance_id = InstanceId(2);
+        create_kvs_files(dir.path(), instance_id, SnapshotId(0)).unwrap();
+        let kvs_map = KvsMap::from([("number1".to_string(), KvsValue::F64(111.0))]);
+        TestBackend::save_kvs(
+            &kvs_map,
+            &TestBackend::kvs_generation_file_path(dir.path(), instance_id, 4),
+            Some(&TestBackend::hash_generation_file_path(
+                dir.path(),
+                instance_id,
+                4,
+            )),
+        )
+        .unwrap();
+        let builder = TestKvsBuilder::new(instance_id)
+            .kvs_load(KvsLoad::Required)
+            .dir(dir_string);
+        let kvs = builder.build().unwrap();
+
+        assert_eq!(kvs.get_value_as::<f64>("number1").unwrap(), 111.0);
+    }
 }
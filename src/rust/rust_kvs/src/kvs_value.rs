@@ -47,6 +47,9 @@ pub enum KvsValue {
 
     /// Object
     Object(KvsMap),
+
+    /// Binary data
+    Bytes(Vec<u8>),
 }
 
 // Macro to implement From<T> for KvsValue for each supported type/variant.
@@ -70,6 +73,7 @@ impl_from_t_for_kvs_value!(bool, Boolean);
 impl_from_t_for_kvs_value!(String, String);
 impl_from_t_for_kvs_value!(Vec<KvsValue>, Array);
 impl_from_t_for_kvs_value!(KvsMap, Object);
+impl_from_t_for_kvs_value!(Vec<u8>, Bytes);
 
 // Convert &str to KvsValue::String
 impl From<&str> for KvsValue {
@@ -109,6 +113,7 @@ impl_tryfrom_kvs_value_to_t!(bool, Boolean);
 impl_tryfrom_kvs_value_to_t!(String, String);
 impl_tryfrom_kvs_value_to_t!(Vec<KvsValue>, Array);
 impl_tryfrom_kvs_value_to_t!(std::collections::HashMap<String, KvsValue>, Object);
+impl_tryfrom_kvs_value_to_t!(Vec<u8>, Bytes);
 
 impl TryFrom<&KvsValue> for () {
     type Error = &'static str;
@@ -152,6 +157,7 @@ impl_kvs_get_inner_value!(bool, Boolean);
 impl_kvs_get_inner_value!(String, String);
 impl_kvs_get_inner_value!(Vec<KvsValue>, Array);
 impl_kvs_get_inner_value!(std::collections::HashMap<String, KvsValue>, Object);
+impl_kvs_get_inner_value!(Vec<u8>, Bytes);
 
 impl KvsValueGet for () {
     fn get_inner_value(v: &KvsValue) -> Option<&()> {
@@ -441,6 +447,37 @@ mod kvs_value_tests {
         assert!(v.get::<Vec<KvsValue>>().is_none());
     }
 
+    #[test]
+    fn test_bytes_from_ok() {
+        let v = KvsValue::from(vec![0u8, 1u8, 255u8]);
+        assert!(matches!(v, KvsValue::Bytes(ref b) if b.len() == 3));
+    }
+
+    #[test]
+    fn test_bytes_tryfrom_ok() {
+        let v = KvsValue::from(vec![0u8, 1u8, 255u8]);
+        assert_eq!(Vec::<u8>::try_from(&v).unwrap(), vec![0u8, 1u8, 255u8]);
+    }
+
+    #[test]
+    fn test_bytes_tryfrom_invalid_type() {
+        let v = KvsValue::from("");
+        let err = Vec::<u8>::try_from(&v).unwrap_err();
+        assert_eq!(err, "KvsValue is not a Vec<u8>");
+    }
+
+    #[test]
+    fn test_bytes_get_ok() {
+        let v = KvsValue::from(vec![7u8]);
+        assert_eq!(v.get::<Vec<u8>>().unwrap().clone(), vec![7u8]);
+    }
+
+    #[test]
+    fn test_bytes_get_invalid_type() {
+        let v = KvsValue::from(vec![KvsValue::from(7i32)]);
+        assert!(v.get::<Vec<u8>>().is_none());
+    }
+
     #[test]
     fn test_array_access() {
         let arr = vec![KvsValue::from(10i32), KvsValue::from(20i32)];
@@ -31,6 +31,8 @@
 //!
 //! Note: JSON arrays are not restricted to only contain values of the same type.
 //!
+//! Binary data is stored as `Bytes`: `Vec<u8>`, base64 encoded in the JSON file.
+//!
 //! Writing a value to the KVS can be done by calling [`Kvs::set_value`] with the `key` as first
 //! and a `KvsValue` as second parameter. Either `KvsValue::Number(123.0)` or `123.0` can be
 //! used as there will be an auto-Into performed when calling the function.
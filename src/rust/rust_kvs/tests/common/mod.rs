@@ -24,6 +24,7 @@ pub fn compare_kvs_values(left: &KvsValue, right: &KvsValue) -> bool {
         (KvsValue::Boolean(l), KvsValue::Boolean(r)) => l == r,
         (KvsValue::String(l), KvsValue::String(r)) => l == r,
         (KvsValue::Null, KvsValue::Null) => true,
+        (KvsValue::Bytes(l), KvsValue::Bytes(r)) => l == r,
         (KvsValue::Array(l), KvsValue::Array(r)) => {
             // Check size.
             if l.len() != r.len() {
@@ -282,8 +282,8 @@ class TestSnapshotPathsExist(CommonScenario):
 
         paths_log = logs_info_level.find_log("kvs_path")
         assert paths_log is not None
-        assert paths_log.kvs_path == f'Ok("{temp_dir}/kvs_1_1.json")'
-        assert paths_log.hash_path == f'Ok("{temp_dir}/kvs_1_1.hash")'
+        assert paths_log.kvs_path == f'Ok("{temp_dir}/kvs_1_g2.json")'
+        assert paths_log.hash_path == f'Ok("{temp_dir}/kvs_1_g2.hash")'
 
 
 @pytest.mark.PartiallyVerifies(["comp_req__persistency__snapshot_creation"])
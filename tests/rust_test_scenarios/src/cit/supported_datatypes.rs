@@ -56,6 +56,7 @@ impl Scenario for SupportedDatatypesValues {
             KvsValue::Null => "null",
             KvsValue::Array(_) => "arr",
             KvsValue::Object(_) => "obj",
+            KvsValue::Bytes(_) => "bin",
         }
     }
 